@@ -5,7 +5,10 @@ include $(CLEAR_VARS)
  
 LOCAL_MODULE    			:= chess
 LOCAL_STATIC_LIBRARIES 	:= libzip
-LOCAL_CFLAGS 				:= -Wall -pipe -O3 -pthread -DUNIX -DSMP -DCPUS=2 -DEPD -DSKILL -DANDROID_NDK -Wno-psabi
+LOCAL_CFLAGS 				:= -Wall -pipe -O3 -pthread -DUNIX -DSMP -DCPUS=2 -DAFFINITY -DEPD -DSKILL -DANDROID_NDK -DINLINEASM -DCOMPACT_MAGIC -DNNUE -Wno-psabi
+ifeq ($(TARGET_ARCH_ABI),x86_64)
+LOCAL_CFLAGS 				+= -mpopcnt
+endif
 LOCAL_C_INCLUDES 			:= $(LOCAL_PATH)/include/ $(SOURCE_PATH)/ $(LOCAL_PATH)/../libzip/
 LOCAL_SRC_FILES 			:= crafty.c egtb.cpp wrapper.c buffer.c fifo_char.cpp util.cpp FifoQueue.cpp
 LOCAL_LDLIBS 				:= -llog -lz
@@ -17,6 +17,7 @@
 #include "thread.c"
 #include "repeat.c"
 #include "next.c"
+#include "nnue.c"
 #include "history.c"
 #include "quiesce.c"
 #include "evaluate.c"
@@ -29,6 +30,8 @@
 #include "book.c"
 #include "analyze.c"
 #include "annotate.c"
+#include "autotune.c"
+#include "batch.c"
 #include "bench.c"
 #include "data.c"
 #include "drawn.c"
@@ -40,14 +43,18 @@
 #include "input.c"
 #include "interrupt.c"
 #include "iterate.c"
+#include "journal.c"
 #include "learn.c"
 #include "main.c"
 #include "option.c"
 #include "output.c"
+#include "perft.c"
+#include "pmu.c"
 #include "ponder.c"
 #include "resign.c"
 #include "root.c"
 #include "setboard.c"
-//#include "test.c"
+#include "stats.c"
+#include "test.c"
 #include "time.c"
 #include "validate.c"
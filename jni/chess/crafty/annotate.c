@@ -1,6 +1,6 @@
 #include "chess.h"
 #include "data.h"
-/* last modified 02/26/14 */
+/* last modified 10/18/26 */
 /*
  *******************************************************************************
  *                                                                             *
@@ -150,7 +150,7 @@ void Annotate() {
     line2 = 999;
   }
   annotate_margin = atof(args[4]) * PieceValues(white, pawn);
-  annotate_search_time_limit = atof(args[5]) * 100;
+  annotate_search_time_limit = atof(args[5]) * 1000;
   if (nargs > 6)
     best_moves = atoi(args[6]);
   else
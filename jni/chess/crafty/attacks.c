@@ -87,3 +87,71 @@ uint64_t AttacksFrom(TREE * RESTRICT tree, int side, int source) {
   }
   return 0;
 }
+
+/* last modified 10/18/26 */
+/*
+ *******************************************************************************
+ *                                                                             *
+ *   AttackMap() returns the attack maps for <side> in the position at <ply>,  *
+ *   attacks[piece] being every square attacked by one of <side>'s pieces of   *
+ *   that type and attacks[0] every square attacked by any of them.  The maps  *
+ *   are computed the first time they are asked for at a node and the same     *
+ *   copy is handed out after that, so that Swap(), LegalMove() and the move   *
+ *   generators do not each repeat the same slider lookups.                    *
+ *                                                                             *
+ *   A map belongs to the position whose hash key it was computed for, rather  *
+ *   than being cleared by MakeMove(), so null moves, parallel splits and      *
+ *   SetBoard() need no special handling.  attack_map_hits counts the times a  *
+ *   map was reused, attack_map_fills the times one had to be computed.        *
+ *                                                                             *
+ *******************************************************************************
+ */
+uint64_t *AttackMap(TREE * RESTRICT tree, int ply, int side) {
+  ATTACK_MAP *map = tree->attack_map + ply;
+  uint64_t *attacks = map->attacks[side], pieces;
+  int square;
+
+  if (map->key != HashKey) {
+    map->key = HashKey;
+    map->computed = 0;
+  } else if (map->computed & (1 << side)) {
+    tree->attack_map_hits++;
+    return attacks;
+  }
+  tree->attack_map_fills++;
+  pieces = Pawns(side);
+  if (side)
+    attacks[pawn] =
+        ((pieces & ~file_mask[FILEA]) << 7) | ((pieces & ~file_mask[FILEH]) <<
+        9);
+  else
+    attacks[pawn] =
+        ((pieces & ~file_mask[FILEA]) >> 9) | ((pieces & ~file_mask[FILEH]) >>
+        7);
+  attacks[knight] = 0;
+  for (pieces = Knights(side); pieces; Clear(square, pieces)) {
+    square = LSB(pieces);
+    attacks[knight] |= KnightAttacks(square);
+  }
+  attacks[bishop] = 0;
+  for (pieces = Bishops(side); pieces; Clear(square, pieces)) {
+    square = LSB(pieces);
+    attacks[bishop] |= BishopAttacks(square, OccupiedSquares);
+  }
+  attacks[rook] = 0;
+  for (pieces = Rooks(side); pieces; Clear(square, pieces)) {
+    square = LSB(pieces);
+    attacks[rook] |= RookAttacks(square, OccupiedSquares);
+  }
+  attacks[queen] = 0;
+  for (pieces = Queens(side); pieces; Clear(square, pieces)) {
+    square = LSB(pieces);
+    attacks[queen] |= QueenAttacks(square, OccupiedSquares);
+  }
+  attacks[king] = KingAttacks(KingSQ(side));
+  attacks[0] =
+      attacks[pawn] | attacks[knight] | attacks[bishop] | attacks[rook] |
+      attacks[queen] | attacks[king];
+  map->computed |= 1 << side;
+  return attacks;
+}
@@ -0,0 +1,354 @@
+#include "chess.h"
+#include "data.h"
+/* last modified 10/18/26 */
+/*
+ *******************************************************************************
+ *                                                                             *
+ *   AutoTune() is used to tune the SMP search parameters (smpmin, smpsn and   *
+ *   smpgroup) for the machine Crafty is running on.  The long comment in      *
+ *   thread.c describes how to do this by hand (run several positions several  *
+ *   times for each parameter value and keep the one with the smallest total   *
+ *   time).  This simply automates that procedure using the six bench          *
+ *   positions, so that it can be run once on each new machine.                *
+ *                                                                             *
+ *   The procedure is time-to-depth:                                           *
+ *                                                                             *
+ *   (1) each position is searched for "seconds" with the current settings,    *
+ *       and the last depth completed becomes the fixed depth for that         *
+ *       position for the rest of the run.                                     *
+ *                                                                             *
+ *   (2) every candidate value of one parameter is tried while the other two   *
+ *       are held constant.  Each candidate searches all six positions to      *
+ *       their fixed depths "reps" times, and the average total time is the    *
+ *       score for that value.  A candidate has to beat the current best by    *
+ *       more than 2% to replace it, since parallel search times are noisy.    *
+ *                                                                             *
+ *   (3) step (2) is repeated for each parameter in turn, and the whole pass   *
+ *       is repeated (at most 3 times) until a pass changes nothing.           *
+ *                                                                             *
+ *   This is a coordinate search through the parameter grid rather than an     *
+ *   exhaustive one.  The full grid would be several hundred points times six  *
+ *   positions times "reps", which is far too long to run on a phone, and the  *
+ *   three parameters are close enough to independent that this finds the      *
+ *   same answer.  The winning values are left in effect and written to the    *
+ *   rc file (see AutoTuneSave()) so that they are used from then on.          *
+ *                                                                             *
+ *******************************************************************************
+ */
+void AutoTune(int reps, int seconds) {
+#if (CPUS > 1)
+  TREE *const tree = block[0];
+  int min_values[] = { 3, 4, 5, 6, 7, 8, 10, 12, 0 };
+  int sn_values[] = { 250, 500, 1000, 2000, 4000, 8000, 16000, 32000, 0 };
+  int group_values[] = { 1, 2, 3, 4, 6, 8, 12, 16, 24, 32, 48, 64, 0 };
+  int *values[3] = { min_values, sn_values, group_values };
+  char *names[3] = { "smpmin", "smpsn", "smpgroup" };
+  int depths[6], param, pass, changed, best, best_value, start_value;
+  int i, t, pos;
+  int old_do, old_st, old_sd;
+  FILE *old_books, *old_book;
+
+  if (smp_max_threads < 2) {
+    Print(4095, "ERROR.  smptune requires mt > 1\n");
+    return;
+  }
+  reps = Max(reps, 1);
+  seconds = Max(seconds, 1);
+  old_st = search_time_limit;
+  old_sd = search_depth;
+  old_do = display_options;
+  display_options = 1;
+  old_book = book_file;
+  book_file = 0;
+  old_books = books_file;
+  books_file = 0;
+  Print(4095, "smptune: %d threads, %d repetitions, %d seconds/position\n",
+      smp_max_threads, reps, seconds);
+/*
+ ************************************************************
+ *                                                          *
+ *  Step 1.  Calibrate the depth for each position so that  *
+ *  one search takes roughly "seconds" with the current     *
+ *  settings.                                               *
+ *                                                          *
+ ************************************************************
+ */
+  for (pos = 0; pos < 6; pos++) {
+    strcpy(buffer, bench_fen[pos]);
+    nargs = ReadParse(buffer, args, " \t;=");
+    SetBoard(tree, nargs, args, 0);
+    search_depth = 0;
+    search_time_limit = seconds * 1000;
+    InitializeHashTables();
+    last_pv.pathd = 0;
+    thinking = 1;
+    tree->status[1] = tree->status[0];
+    Iterate(game_wtm, think, 0);
+    thinking = 0;
+    depths[pos] = Max(iteration_depth - 1, 4);
+  }
+  search_time_limit = 900000;
+  Print(4095, "smptune: depths");
+  for (pos = 0; pos < 6; pos++)
+    Print(4095, " %d", depths[pos]);
+  Print(4095, "\n");
+/*
+ ************************************************************
+ *                                                          *
+ *  Step 2.  Walk the grid one parameter at a time, keeping *
+ *  the best value of each before moving on to the next.    *
+ *                                                          *
+ ************************************************************
+ */
+  best = AutoTuneRun(depths, reps);
+  Print(4095, "smptune: smpmin=%d smpsn=%u smpgroup=%d  %s\n",
+      smp_min_split_depth, smp_split_nodes, smp_split_group,
+      DisplayTime(best));
+  for (pass = 0; pass < 3; pass++) {
+    changed = 0;
+    for (param = 0; param < 3; param++) {
+      start_value = AutoTuneGet(param);
+      best_value = start_value;
+      for (i = 0; values[param][i]; i++) {
+        if (values[param][i] == start_value)
+          continue;
+        if (param == 2 && values[param][i] >= smp_max_threads)
+          break;
+        AutoTuneSet(param, values[param][i]);
+        t = AutoTuneRun(depths, reps);
+        Print(4095, "smptune: %s=%-5d  %s", names[param], values[param][i],
+            DisplayTime(t));
+        if (t < best - best / 50) {
+          Print(4095, "  (new best)");
+          best = t;
+          best_value = values[param][i];
+          changed = 1;
+        }
+        Print(4095, "\n");
+      }
+      AutoTuneSet(param, best_value);
+    }
+    if (!changed)
+      break;
+  }
+/*
+ ************************************************************
+ *                                                          *
+ *  Done.  Leave the winning values in effect, save them to *
+ *  the rc file and restore everything else.                *
+ *                                                          *
+ ************************************************************
+ */
+  Print(4095, "smptune: best smpmin=%d smpsn=%u smpgroup=%d  %s\n",
+      smp_min_split_depth, smp_split_nodes, smp_split_group,
+      DisplayTime(best));
+  AutoTuneSave();
+  display_options = old_do;
+  search_time_limit = old_st;
+  search_depth = old_sd;
+  books_file = old_books;
+  book_file = old_book;
+  NewGame(0);
+#else
+  Print(4095, "ERROR.  smptune requires a -DSMP build\n");
+#endif
+}
+
+/* last modified 10/18/26 */
+/*
+ *******************************************************************************
+ *                                                                             *
+ *   AutoTuneRun() searches the six bench positions to the calibrated depths   *
+ *   "reps" times and returns the average total time in milliseconds.          *
+ *                                                                             *
+ *******************************************************************************
+ */
+int AutoTuneRun(int *depths, int reps) {
+  TREE *const tree = block[0];
+  int r, pos, total = 0;
+
+  for (r = 0; r < reps; r++)
+    for (pos = 0; pos < 6; pos++) {
+      strcpy(buffer, bench_fen[pos]);
+      nargs = ReadParse(buffer, args, " \t;=");
+      SetBoard(tree, nargs, args, 0);
+      search_depth = depths[pos];
+      InitializeHashTables();
+      last_pv.pathd = 0;
+      thinking = 1;
+      tree->status[1] = tree->status[0];
+      Iterate(game_wtm, think, 0);
+      thinking = 0;
+      total += program_end_time - program_start_time;
+    }
+  return total / reps;
+}
+
+/* last modified 10/18/26 */
+/*
+ *******************************************************************************
+ *                                                                             *
+ *   AutoTuneGet() and AutoTuneSet() map a parameter index (0=smpmin, 1=smpsn, *
+ *   2=smpgroup) to the corresponding global, since they are not all the same  *
+ *   type.                                                                     *
+ *                                                                             *
+ *******************************************************************************
+ */
+int AutoTuneGet(int param) {
+  if (param == 0)
+    return smp_min_split_depth;
+  else if (param == 1)
+    return smp_split_nodes;
+  return smp_split_group;
+}
+
+void AutoTuneSet(int param, int value) {
+  if (param == 0)
+    smp_min_split_depth = value;
+  else if (param == 1)
+    smp_split_nodes = value;
+  else
+    smp_split_group = value;
+}
+
+/* last modified 10/18/26 */
+/*
+ *******************************************************************************
+ *                                                                             *
+ *   AutoTuneOnline() is called at the end of each search when "smptune on"    *
+ *   has been used.  Rather than running a separate test, it nudges smpsn and  *
+ *   smpmin one small step at a time using the SMP counters from the search    *
+ *   that just finished (see ThreadStats()).  Two symptoms are used:           *
+ *                                                                             *
+ *   (1) threads idle more than 10% of the time means they are starved for     *
+ *       work, so we make splitting easier by lowering smpsn by 1/4, or once   *
+ *       that reaches its floor, lowering smpmin by one.                       *
+ *                                                                             *
+ *   (2) threads idle less than 3% of the time, while helpers average fewer    *
+ *       nodes per join than 4 * smpsn, means we are splitting more often than *
+ *       the work at each split point justifies, so we make splitting harder   *
+ *       by raising smpsn by 1/4, or once that reaches its ceiling, raising    *
+ *       smpmin by one.                                                        *
+ *                                                                             *
+ *   Searches shorter than one second are ignored as the counters are too      *
+ *   noisy to act on.  Changes are not saved; "smptune save" writes the        *
+ *   current values to the rc file.                                            *
+ *                                                                             *
+ *******************************************************************************
+ */
+void AutoTuneOnline(int elapsed) {
+#if (CPUS > 1)
+  uint64_t idle_ns = 0, joins = 0, helper_nodes = 0, per_join;
+  int tid, idle, old_min = smp_min_split_depth;
+  unsigned int old_sn = smp_split_nodes;
+
+  if (elapsed < 1000 || smp_max_threads < 2)
+    return;
+  for (tid = 0; tid < smp_max_threads; tid++) {
+    idle_ns += thread[tid].stats.idle_ns;
+    joins += thread[tid].stats.joins;
+    helper_nodes += thread[tid].stats.helper_nodes;
+  }
+  idle = idle_ns / ((uint64_t) elapsed * 10000 * smp_max_threads);
+  per_join = helper_nodes / Max(joins, 1);
+  if (idle > 10) {
+    if (smp_split_nodes > 250)
+      smp_split_nodes -= smp_split_nodes / 4;
+    else if (smp_min_split_depth > 3)
+      smp_min_split_depth--;
+  } else if (idle < 3 && joins && per_join < 4 * (uint64_t) smp_split_nodes) {
+    if (smp_split_nodes < 32000)
+      smp_split_nodes += smp_split_nodes / 4;
+    else if (smp_min_split_depth < 12)
+      smp_min_split_depth++;
+  }
+  if (smp_split_nodes != old_sn || smp_min_split_depth != old_min)
+    Print(128, "smptune: idle=%d%%  nodes/join=%s  smpmin=%d smpsn=%u\n",
+        idle, DisplayKMB(per_join, 0), smp_min_split_depth, smp_split_nodes);
+#endif
+}
+
+/* last modified 10/19/26 */
+/*
+ *******************************************************************************
+ *                                                                             *
+ *   AutoTuneSave() writes the current smpmin, smpsn and smpgroup values to    *
+ *   the rc file (rc_path/RCFILE) which is read at start-up.  The old file is  *
+ *   copied a line at a time to a temporary file, dropping any existing        *
+ *   smpmin/smpsn/smpgroup lines and inserting the new ones ahead of an "exit" *
+ *   line (ReadRC() stops there) or at the end.  The copy then replaces the    *
+ *   rc file, so everything else in it is kept as it was, however long.        *
+ *                                                                             *
+ *******************************************************************************
+ */
+void AutoTuneSave(void) {
+  char filename[FILENAME_MAX], tempname[FILENAME_MAX + 4], line[256], cmd[16];
+  FILE *input, *output;
+  int start = 1, skip = 0, saved = 0;
+
+  sprintf(filename, "%s/%s", rc_path, RCFILE);
+  sprintf(tempname, "%s.tmp", filename);
+  if (!(output = fopen(tempname, "w"))) {
+    Print(4095, "ERROR.  Unable to open %s for writing\n", tempname);
+    return;
+  }
+/*
+ ************************************************************
+ *                                                          *
+ *  Copy the old file.  A line longer than line[] arrives   *
+ *  in pieces, so the command is only looked at in the      *
+ *  first piece and the rest follow the same skip decision. *
+ *                                                          *
+ ************************************************************
+ */
+  if ((input = fopen(filename, "r"))) {
+    while (fgets(line, sizeof(line), input)) {
+      if (start) {
+        cmd[0] = 0;
+        sscanf(line, "%15s", cmd);
+        if (!saved && !strcmp(cmd, "exit")) {
+          AutoTuneWrite(output);
+          saved = 1;
+        }
+        skip = !strcmp(cmd, "smpmin") || !strcmp(cmd, "smpsn") ||
+            !strcmp(cmd, "smpgroup");
+      }
+      if (!skip)
+        fputs(line, output);
+      start = (strchr(line, '\n') != 0);
+    }
+    fclose(input);
+    if (!start)
+      fputs("\n", output);
+  }
+  if (!saved)
+    AutoTuneWrite(output);
+  if (fclose(output)) {
+    Print(4095, "ERROR.  Unable to write %s\n", tempname);
+    remove(tempname);
+    return;
+  }
+#if !defined(UNIX)
+  remove(filename);
+#endif
+  if (rename(tempname, filename)) {
+    Print(4095, "ERROR.  Unable to replace %s\n", filename);
+    remove(tempname);
+    return;
+  }
+  Print(4095, "smptune: settings saved to %s\n", filename);
+}
+
+/* last modified 10/19/26 */
+/*
+ *******************************************************************************
+ *                                                                             *
+ *   AutoTuneWrite() writes the three SMP tuning commands to an rc file.       *
+ *                                                                             *
+ *******************************************************************************
+ */
+void AutoTuneWrite(FILE * file) {
+  fprintf(file, "smpmin %d\n", smp_min_split_depth);
+  fprintf(file, "smpsn %u\n", smp_split_nodes);
+  fprintf(file, "smpgroup %d\n", smp_split_group);
+}
@@ -0,0 +1,396 @@
+#include "chess.h"
+#include "data.h"
+#if defined(UNIX) && !defined(ANDROID_NDK)
+#  include <sys/mman.h>
+#  include <sys/wait.h>
+#endif
+/* last modified 10/19/26 */
+/*
+ *******************************************************************************
+ *                                                                             *
+ *   BatchAnalyze() is the offline analysis pipeline, started by the command   *
+ *   "batch <in.epd> <out.jsonl> workers=N depth=D|nodes=K|time=T".  Every     *
+ *   position in the EPD (or FEN) input file is searched once, and one JSON    *
+ *   object per position is written to the output file, in input order:        *
+ *                                                                             *
+ *   {"index":0,"id":"BK.01","fen":"...","depth":12,"score":35,"mate":0,       *
+ *    "bestmove":"Qd1+","pv":"Qd1+ Kxd1 Bg4+","nodes":1234567,"time":812}      *
+ *                                                                             *
+ *   "score" is in centipawns from the side to move's point of view, "mate"    *
+ *   is non-zero (mate in N, negative if being mated) when the score is a      *
+ *   mate score, and "time" is in milliseconds.                                *
+ *                                                                             *
+ *   With workers=N > 1 the work is done by N forked copies of the engine, in  *
+ *   the spirit of the old fork()-based parallel search.  Each worker is a     *
+ *   complete single-threaded engine with its own TREE and its own (private,   *
+ *   copy-on-write) hash tables, so nothing at all is shared during a search   *
+ *   and throughput scales with the number of cores.  Workers claim the next   *
+ *   unsearched position from a counter in shared memory, so a few slow        *
+ *   positions do not leave the other workers idle, and each writes its        *
+ *   results to <out.jsonl>.<worker>.  Once all workers have exited, the parts *
+ *   are merged back into input order.  A forked worker starts with thread     *
+ *   0's single-CPU affinity mask, so it first widens it back to every CPU we  *
+ *   may use and leaves placement to the OS.                                   *
+ *                                                                             *
+ *   With workers=1, or on systems without fork(), the positions are searched  *
+ *   in-process with the normal parallel search, using the "mt" thread count.  *
+ *   That includes the Android build, where the engine lives inside the app's  *
+ *   own process and forking it is not safe, so workers= is ignored there and  *
+ *   the cores are used by the SMP search instead.                             *
+ *                                                                             *
+ *   hash=keep keeps each worker's hash table from one position to the next    *
+ *   (useful for positions from the same game), the default hash=clear starts  *
+ *   every position with empty tables so results do not depend on which        *
+ *   worker searched which position.                                           *
+ *                                                                             *
+ *******************************************************************************
+ */
+void BatchAnalyze(char *in_file, char *out_file, int workers, int depth,
+    uint64_t nodes, int msecs, int keep_hash) {
+  FILE *input, *output;
+  char line[4096], in_name[FILENAME_MAX], out_name[FILENAME_MAX];
+  long *offsets = 0, offset;
+  int npositions = 0, claimed = 0, *next_position = &claimed;
+  int started;
+  int old_do, old_st, old_sd, old_kibitz, old_post, old_smp;
+  uint64_t old_sn;
+  FILE *old_book, *old_books;
+
+/*
+ ************************************************************
+ *                                                          *
+ *  First pass over the input records the file offset of    *
+ *  each position, so that any worker can seek straight to  *
+ *  the one it claims without the whole file being held in  *
+ *  memory.  Blank lines and "#" comments are skipped.      *
+ *                                                          *
+ *  The file names are copied first, since they usually     *
+ *  point into args[], which every SetBoard() parse below   *
+ *  overwrites.                                             *
+ *                                                          *
+ ************************************************************
+ */
+  strcpy(in_name, in_file);
+  strcpy(out_name, out_file);
+  if (!(input = fopen(in_name, "r"))) {
+    Print(4095, "ERROR, unable to open %s\n", in_name);
+    return;
+  }
+  while (offset = ftell(input), fgets(line, sizeof(line), input)) {
+    if (line[strspn(line, " \t\r\n")] == 0 || line[0] == '#')
+      continue;
+    if (!(npositions & 1023))
+      offsets = (long *) realloc(offsets, (npositions + 1024) * sizeof(long));
+    offsets[npositions++] = offset;
+  }
+  fclose(input);
+  if (!npositions) {
+    Print(4095, "ERROR, no positions found in %s\n", in_name);
+    free(offsets);
+    return;
+  }
+#if defined(UNIX) && !defined(ANDROID_NDK)
+  workers = Max(1, Min(Min(workers, MAX_BATCH_WORKERS), npositions));
+#else
+  workers = 1;
+#endif
+/*
+ ************************************************************
+ *                                                          *
+ *  Set up the search limits and silence all output, since  *
+ *  the only thing a worker may produce is its JSON lines.  *
+ *  The thread count is left alone here, only the forked    *
+ *  workers below are limited to one thread.  Everything is *
+ *  restored when we are done.                              *
+ *                                                          *
+ ************************************************************
+ */
+  Print(4095, "batch: %d positions, %d worker%s\n", npositions, workers,
+      (workers > 1) ? "s" : "");
+  old_do = display_options;
+  old_st = search_time_limit;
+  old_sd = search_depth;
+  old_sn = search_nodes;
+  old_kibitz = kibitz;
+  old_post = post;
+  old_smp = smp_max_threads;
+  old_book = book_file;
+  old_books = books_file;
+  search_depth = (depth) ? depth : MAXPLY - 6;
+  search_nodes = nodes;
+  search_time_limit = (msecs) ? msecs : 86400000;
+  display_options = 0;
+  kibitz = 0;
+  post = 0;
+  book_file = 0;
+  books_file = 0;
+  started = ReadClock();
+/*
+ ************************************************************
+ *                                                          *
+ *  One worker (or no shared memory for the counter that    *
+ *  several workers need):  search everything right here.   *
+ *                                                          *
+ ************************************************************
+ */
+#if defined(UNIX) && !defined(ANDROID_NDK)
+  if (workers > 1) {
+    next_position =
+        (int *) mmap(0, sizeof(int), PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (next_position == (int *) MAP_FAILED) {
+      Print(4095, "ERROR, no shared memory, using one worker\n");
+      next_position = &claimed;
+      workers = 1;
+    } else
+      *next_position = 0;
+  }
+#endif
+  if (workers == 1) {
+    if ((output = fopen(out_name, "w"))) {
+      BatchWorker(in_name, output, offsets, npositions, next_position,
+          keep_hash);
+      fclose(output);
+    } else
+      Print(4095, "ERROR, unable to create %s\n", out_name);
+  }
+#if defined(UNIX) && !defined(ANDROID_NDK)
+/*
+ ************************************************************
+ *                                                          *
+ *  Several workers:  fork() one engine per worker.  Output *
+ *  buffers are flushed first so that the children do not   *
+ *  inherit (and later repeat) anything still pending.      *
+ *                                                          *
+ ************************************************************
+ */
+  else {
+    FILE *part[MAX_BATCH_WORKERS];
+    char head[MAX_BATCH_WORKERS][4096], part_name[FILENAME_MAX];
+    int worker, best, index[MAX_BATCH_WORKERS];
+#  if defined(AFFINITY)
+    cpu_set_t cpuset;
+    int cpu;
+#  endif
+
+    smp_max_threads = 1;
+    fflush(0);
+    for (worker = 0; worker < workers; worker++) {
+      if (fork() == 0) {
+#  if defined(AFFINITY)
+        CPU_ZERO(&cpuset);
+        for (cpu = 0; cpu < smp_ncpus; cpu++)
+          CPU_SET(smp_cpus[cpu].cpu, &cpuset);
+        sched_setaffinity(0, sizeof(cpu_set_t), &cpuset);
+#  endif
+        sprintf(part_name, "%s.%d", out_name, worker);
+        if ((output = fopen(part_name, "w"))) {
+          BatchWorker(in_name, output, offsets, npositions, next_position,
+              keep_hash);
+          fclose(output);
+        }
+        _exit(0);
+      }
+    }
+    while (wait(0) > 0);
+    munmap(next_position, sizeof(int));
+/*
+ ************************************************************
+ *                                                          *
+ *  Merge.  Each part is already in increasing index order  *
+ *  (a worker claims positions in order), so we repeatedly  *
+ *  copy the line with the smallest index among the heads   *
+ *  of the parts, and remove the parts afterward.           *
+ *                                                          *
+ ************************************************************
+ */
+    if ((output = fopen(out_name, "w"))) {
+      for (worker = 0; worker < workers; worker++) {
+        sprintf(part_name, "%s.%d", out_name, worker);
+        part[worker] = fopen(part_name, "r");
+        index[worker] = -1;
+        if (part[worker] && fgets(head[worker], sizeof(head[0]), part[worker]))
+          sscanf(head[worker], "{\"index\":%d", &index[worker]);
+      }
+      while (1) {
+        best = -1;
+        for (worker = 0; worker < workers; worker++)
+          if (index[worker] >= 0 && (best < 0 || index[worker] < index[best]))
+            best = worker;
+        if (best < 0)
+          break;
+        fputs(head[best], output);
+        index[best] = -1;
+        if (fgets(head[best], sizeof(head[0]), part[best]))
+          sscanf(head[best], "{\"index\":%d", &index[best]);
+      }
+      fclose(output);
+      for (worker = 0; worker < workers; worker++) {
+        if (part[worker])
+          fclose(part[worker]);
+        sprintf(part_name, "%s.%d", out_name, worker);
+        remove(part_name);
+      }
+    } else
+      Print(4095, "ERROR, unable to create %s\n", out_name);
+  }
+#endif
+  display_options = old_do;
+  search_time_limit = old_st;
+  search_depth = old_sd;
+  search_nodes = old_sn;
+  kibitz = old_kibitz;
+  post = old_post;
+  smp_max_threads = old_smp;
+  book_file = old_book;
+  books_file = old_books;
+  started = ReadClock() - started;
+  Print(4095, "batch: %d positions written to %s in %s (%.1f positions/sec)\n",
+      npositions, out_name, DisplayTimeKibitz(started),
+      npositions * 1000.0 / Max(started, 1));
+  free(offsets);
+}
+
+/* last modified 10/19/26 */
+/*
+ *******************************************************************************
+ *                                                                             *
+ *   BatchWorker() is the loop run by each batch worker.  It claims positions  *
+ *   one at a time from "next_position", searches each with Iterate(), and     *
+ *   writes one JSON line per position to "output".  A position is the first   *
+ *   four fields of the EPD record (FEN move counters are accepted and         *
+ *   ignored), and an "id" opcode, if present, is copied into the result.  An  *
+ *   illegal position produces a line with an "error" field instead.  If the   *
+ *   record has a "bm" or "am" opcode, the line also says whether the final    *
+ *   best move "solved" the position and, if so, the depth, time and nodes at  *
+ *   which the solution was found (this is what Test() reports).               *
+ *                                                                             *
+ *******************************************************************************
+ */
+void BatchWorker(char *in_name, FILE * output, long *offsets, int npositions,
+    int *next_position, int keep_hash) {
+  TREE *const tree = block[0];
+  FILE *input;
+  char line[4096], fen[256], id[256], *delim, *from, *to;
+  int position, value, mate, i, twtm, move;
+
+  if (!(input = fopen(in_name, "r")))
+    return;
+  if (keep_hash)
+    InitializeHashTables();
+#if defined(UNIX) && !defined(ANDROID_NDK)
+  while ((position = __sync_fetch_and_add(next_position, 1)) < npositions) {
+#else
+  while ((position = (*next_position)++) < npositions) {
+#endif
+    fseek(input, offsets[position], SEEK_SET);
+    if (!fgets(line, sizeof(line), input))
+      break;
+    if ((delim = strpbrk(line, "\r\n")))
+      *delim = 0;
+/*
+ ************************************************************
+ *                                                          *
+ *  Parse the record.  The id may be quoted and contain     *
+ *  blanks, so its tokens are glued back together until the *
+ *  closing quote.                                          *
+ *                                                          *
+ ************************************************************
+ */
+    strcpy(buffer, line);
+    nargs = ReadParse(buffer, args, " ;");
+    fen[0] = 0;
+    for (i = 0; i < Min(nargs, 4); i++)
+      sprintf(fen + strlen(fen), "%s%s", (i) ? " " : "", args[i]);
+    id[0] = 0;
+    for (i = 4; i < nargs - 1; i++)
+      if (!strcmp(args[i], "id")) {
+        strcpy(id, args[++i]);
+        while (id[0] == '"' && (strlen(id) == 1 || id[strlen(id) - 1] != '"')
+            && ++i < nargs && strlen(id) + strlen(args[i]) < 250)
+          sprintf(id + strlen(id), " %s", args[i]);
+        break;
+      }
+    for (from = to = id; *from; from++)
+      if (*from != '"' && *from != '\\')
+        *to++ = *from;
+    *to = 0;
+/*
+ ************************************************************
+ *                                                          *
+ *  Search it.  An illegal position is reported only by    *
+ *  its JSON error line:  the complaints SetBoard() and     *
+ *  InvalidPosition() make through Print() stay off the     *
+ *  console since display_options is 0 here.  The board is  *
+ *  left at the initial position and the next FEN replaces  *
+ *  it.                                                     *
+ *                                                          *
+ ************************************************************
+ */
+    if (SetBoard(tree, nargs, args, 0)) {
+      fprintf(output, "{\"index\":%d,\"id\":\"%s\",\"fen\":\"%s\","
+          "\"error\":\"illegal position\"}\n", position, id, fen);
+      continue;
+    }
+    number_of_solutions = 0;
+    for (i = 4; i < nargs; i++)
+      if (!strcmp(args[i], "bm") || !strcmp(args[i], "am")) {
+        solution_type = (args[i][0] == 'a');
+        while (++i < nargs && number_of_solutions < 10 &&
+            (move = InputMove(tree, args[i], 0, game_wtm, 1, 0)))
+          solutions[number_of_solutions++] = move;
+        break;
+      }
+    if (!keep_hash)
+      InitializeHashTables();
+    last_pv.pathd = 0;
+    thinking = 1;
+    tree->status[1] = tree->status[0];
+    TimeSet(think);
+    value = Iterate(game_wtm, think, 0);
+    thinking = 0;
+    mate = 0;
+    if (Abs(value) > MATE - 300)
+      mate = (value > 0) ? (MATE - value) / 2 : -(MATE + value) / 2;
+/*
+ ************************************************************
+ *                                                          *
+ *  Write the result.  The PV has to be played out on the   *
+ *  board to be converted to SAN, then taken back.          *
+ *                                                          *
+ ************************************************************
+ */
+    fprintf(output, "{\"index\":%d,\"id\":\"%s\",\"fen\":\"%s\",\"depth\":%d,"
+        "\"score\":%d,\"mate\":%d,\"bestmove\":", position, id, fen,
+        tree->pv[0].pathd, value, mate);
+    if (tree->pv[0].pathl > 1)
+      fprintf(output, "\"%s\"", OutputMove(tree, tree->pv[0].path[1], 1,
+              game_wtm));
+    else
+      fprintf(output, "null");
+    fprintf(output, ",\"pv\":\"");
+    twtm = game_wtm;
+    for (i = 1; i < (int) tree->pv[0].pathl; i++) {
+      fprintf(output, "%s%s", (i > 1) ? " " : "", OutputMove(tree,
+              tree->pv[0].path[i], i, twtm));
+      MakeMove(tree, i, tree->pv[0].path[i], twtm);
+      twtm = Flip(twtm);
+    }
+    for (i--; i > 0; i--) {
+      twtm = Flip(twtm);
+      UnmakeMove(tree, i, tree->pv[0].path[i], twtm);
+    }
+    fprintf(output, "\",\"nodes\":%" PRIu64 ",\"time\":%u",
+        tree->nodes_searched, program_end_time - program_start_time);
+    if (number_of_solutions && TestSolution(tree->pv[0].path[1]) &&
+        solution_depth)
+      fprintf(output, ",\"solved\":true,\"solution_depth\":%d,"
+          "\"solution_time\":%u,\"solution_nodes\":%" PRIu64,
+          solution_depth, solution_time, solution_nodes);
+    else if (number_of_solutions)
+      fprintf(output, ",\"solved\":false");
+    fprintf(output, "}\n");
+  }
+  number_of_solutions = 0;
+  fclose(input);
+}
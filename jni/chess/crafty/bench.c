@@ -1,102 +1,653 @@
+#include <math.h>
 #include "chess.h"
 #include "data.h"
-/* last modified 02/26/14 */
+/* last modified 10/19/26 */
 /*
  *******************************************************************************
  *                                                                             *
  *   Bench() runs a simple six-position benchmark to gauge Crafty's            *
- *   performance.  The test positons are hard-coded, and the benchmark is      *
- *   calculated much like it would with an external "test" file.  The test     *
- *   is a mix of opening, middlegame, and endgame positions, with both         *
- *   tactical and positional aspects.  (For those interested, the positions    *
- *   chosen are Bratko-Kopec 2, 4, 8, 12, 22 and 23.)  This test is a speed    *
- *   measure only; the actual solutions to the positions are ignored.          *
+ *   performance.  The test positons are hard-coded (bench_fen[] in data.c,    *
+ *   shared with AutoTune()), and the benchmark is calculated much like it     *
+ *   would with an external "test" file.  The test is a mix of opening,        *
+ *   middlegame, and endgame positions, with both tactical and positional      *
+ *   aspects.  (For those interested, the positions chosen are Bratko-Kopec    *
+ *   2, 4, 8, 12, 22 and 23.)  This test is a speed measure only; the actual   *
+ *   solutions to the positions are ignored.                                   *
+ *                                                                             *
+ *   The full form of the command is                                           *
+ *                                                                             *
+ *     bench [file=<epd>] [depth=N] [repeat=K] [mt=N] [hash=SIZE]              *
+ *           [json=<file>]                                                     *
+ *                                                                             *
+ *   file= replaces the built-in positions with those in an EPD file (see      *
+ *   BenchLoad()), depth= searches every position to that depth, repeat=       *
+ *   runs the whole set K times so that the run-to-run variation can be        *
+ *   measured, and mt= and hash= pin the thread count and hash size for the    *
+ *   benchmark only, whatever the current settings are.  json= appends one     *
+ *   line with all the results to a file, so that a series of runs can be      *
+ *   tracked over time.  "increase" is the bench+N/bench-N depth offset.       *
  *                                                                             *
  *******************************************************************************
  */
-void Bench(int increase) {
-  uint64_t nodes = 0;
-  int old_do, old_st, old_sd, total_time_used, pos;
+void Bench(int increase, char *file, int depth, int repeats, int threads,
+    size_t hash, char *json) {
+  BENCH *bench;
+  char file_name[FILENAME_MAX], json_name[FILENAME_MAX];
+  int old_do, old_st, old_sd, old_smp, ev, evaluators = 1;
+  size_t old_hash;
   FILE *old_books, *old_book;
-  TREE *const tree = block[0];
-  char fen[6][80] = {
-    {"3r1k2/4npp1/1ppr3p/p6P/P2PPPP1/1NR5/5K2/2R5 w - - 0 1"},
-    {"rnbqkb1r/p3pppp/1p6/2ppP3/3N4/2P5/PPP1QPPP/R1B1KB1R w KQkq - 0 1"},
-    {"4b3/p3kp2/6p1/3pP2p/2pP1P2/4K1P1/P3N2P/8 w - - 0 1"},
-    {"r3r1k1/ppqb1ppp/8/4p1NQ/8/2P5/PP3PPP/R3R1K1 b - - 0 1"},
-    {"2r2rk1/1bqnbpp1/1p1ppn1p/pP6/N1P1P3/P2B1N1P/1B2QPP1/R2R2K1 b - - 0 1"},
-    {"r1bqk2r/pp2bppp/2p5/3pP3/P2Q1P2/2N1B3/1PP3PP/R4RK1 b kq - 0 1"}
-  };
-  int fen_depth[6] = { 22, 20, 26, 21, 22, 19 };
+#if defined(NNUE)
+  int old_nnue = nnue_enabled;
+#endif
 
 /*
  ************************************************************
  *                                                          *
- *  Initialize.                                             *
+ *  Initialize.  If a neural network has been loaded, the   *
+ *  whole benchmark is run twice, once with the normal      *
+ *  evaluation and once with the network, so that the two   *
+ *  can be compared.  The file names are copied first since *
+ *  they point into args[], which ReadParse() overwrites.   *
  *                                                          *
  ************************************************************
  */
-  total_time_used = 0;
+  if (!(bench = (BENCH *) malloc(sizeof(BENCH)))) {
+    Print(4095, "ERROR, not enough memory for the benchmark\n");
+    return;
+  }
+  file_name[0] = 0;
+  json_name[0] = 0;
+  if (file)
+    strcpy(file_name, file);
+  if (json)
+    strcpy(json_name, json);
+  if (!BenchLoad(bench, (file_name[0]) ? file_name : 0, depth, increase)) {
+    free(bench);
+    return;
+  }
+  bench->repeats = Max(1, Min(repeats, MAX_BENCH_REPEATS));
   old_st = search_time_limit;
   old_sd = search_depth;
   old_do = display_options;
-  search_time_limit = 90000;
+  old_smp = smp_max_threads;
+  old_hash = hash_table_size * sizeof(HASH_ENTRY);
+  search_time_limit = 900000;
+  if (threads)
+    BenchThreads(threads);
   display_options = 1;
   old_book = book_file;
   book_file = 0;
   old_books = books_file;
   books_file = 0;
-  if (increase)
-    Print(4095, "Running benchmark %d. . .\n", increase);
-  else
-    Print(4095, "Running benchmark. . .\n");
-  _printf(".");
-  fflush(stdout);
+  if (hash)
+    BenchHash(hash);
+#if defined(NNUE)
+  if (nnue_input_weights)
+    evaluators = 2;
+#endif
+  for (ev = 0; ev < evaluators; ev++) {
+#if defined(NNUE)
+    nnue_enabled = ev;
+#endif
+    if (increase)
+      Print(4095, "Running benchmark %d. . .\n", increase);
+    else
+      Print(4095, "Running benchmark. . .\n");
+    _printf(".");
+    fflush(stdout);
+    BenchRun(bench);
+    _printf("\n");
+#if defined(NNUE)
+    if (nnue_enabled)
+      Print(4095, "Evaluation: nnue (%s kernels)\n", NNUE_KERNEL);
+    else
+#endif
+      Print(4095, "Evaluation: normal\n");
+    BenchReport(bench, (json_name[0]) ? json_name : 0,
+        (ev) ? "nnue" : "normal");
+  }
+  Print(4095, "Slider attacks: %s index, %s tables\n", SLIDER_INDEX,
+      SLIDER_LAYOUT);
+
+  early_exit = 99;
+  display_options = old_do;
+  search_time_limit = old_st;
+  search_depth = old_sd;
+  books_file = old_books;
+  book_file = old_book;
+  if (threads)
+    BenchThreads(old_smp);
+  if (hash && hash != old_hash)
+    BenchHash(old_hash);
+#if defined(NNUE)
+  nnue_enabled = old_nnue;
+#endif
+  free(bench);
+  NewGame(0);
+}
+
+/* last modified 10/18/26 */
+/*
+ *******************************************************************************
+ *                                                                             *
+ *   BenchBitOps() is a micro-benchmark for the three bitboard operators,      *
+ *   MSB(), LSB() and PopCnt(), run with "bench bitops".  Each one is applied  *
+ *   to a table of 4096 random bitboards with about 8 bits set (roughly what   *
+ *   Extract() and the mobility terms see) until at least a half second has    *
+ *   passed, and the average time per call is displayed along with which       *
+ *   backend (table, builtin or intrinsic) was compiled in.  The checksum is   *
+ *   only printed so the compiler can not discard the loops.                   *
+ *                                                                             *
+ *******************************************************************************
+ */
+void BenchBitOps(void) {
+  static uint64_t boards[4096];
+  char *names[3] = { "MSB", "LSB", "PopCnt" };
+  unsigned int start, elapsed;
+  uint64_t calls, sum = 0;
+  int op, i, j;
+
+  for (i = 0; i < 4096; i++)
+    boards[i] = Random64() & Random64() & Random64();
+  Print(4095, "bitboard operators: %s\n", BITOPS_BACKEND);
+  for (op = 0; op < 3; op++) {
+    calls = 0;
+    start = ReadClock();
+    do {
+      for (j = 0; j < 256; j++)
+        for (i = 0; i < 4096; i++)
+          sum += (op == 0) ? MSB(boards[i]) : (op == 1) ? LSB(boards[i]) :
+              PopCnt(boards[i]);
+      calls += 256 * 4096;
+      elapsed = ReadClock() - start;
+    } while (elapsed < 500);
+    Print(4095, "  %-6s  %6.2f ns/call  (%s calls)\n", names[op],
+        (double) elapsed * 1.0e6 / (double) calls, DisplayKMB(calls, 0));
+  }
+  Print(4095, "  checksum %" PRIu64 "\n", sum);
+}
+
+/* last modified 10/18/26 */
+/*
+ *******************************************************************************
+ *                                                                             *
+ *   BenchHash() sets the transposition table to "bytes" (rounded down to a    *
+ *   power of two), exactly as the "hash" command does.                        *
+ *                                                                             *
+ *******************************************************************************
+ */
+void BenchHash(size_t bytes) {
+  hash_table_size = ((1ull) << MSB(bytes)) / sizeof(HASH_ENTRY);
+  AlignedRemalloc((void *) ((void *) &trans_ref), 64,
+      sizeof(HASH_ENTRY) * hash_table_size);
+  if (!trans_ref) {
+    _printf("AlignedRemalloc() failed, not enough memory.\n");
+    exit(1);
+  }
+  hash_mask = ((1ull << (MSB((uint64_t) hash_table_size) - 2)) - 1) << 2;
+  InitializeHashTables();
+}
+
+/* last modified 10/18/26 */
+/*
+ *******************************************************************************
+ *                                                                             *
+ *   BenchLoad() fills in the position set for a benchmark.  With no file it   *
+ *   is the built-in bench_fen[] set with its bench_depth[] depths.  With a    *
+ *   file, every line that is not blank or a "#" comment is an EPD record (a   *
+ *   FEN is fine too), and the depth comes from the record's "acd" opcode.     *
+ *   "depth" (if non-zero) overrides both, and "increase" is then added to     *
+ *   every depth.  Returns the number of positions, or 0 after an error.       *
+ *                                                                             *
+ *******************************************************************************
+ */
+int BenchLoad(BENCH * bench, char *file, int depth, int increase) {
+  FILE *input;
+  char line[4096];
+  int pos, i, acd;
+
+  bench->positions = 0;
+  if (!file) {
+    for (pos = 0; pos < 6; pos++) {
+      strcpy(bench->fen[pos], bench_fen[pos]);
+      bench->depth[pos] = ((depth) ? depth : bench_depth[pos]) + increase;
+    }
+    return bench->positions = 6;
+  }
+  if (!(input = fopen(file, "r"))) {
+    Print(4095, "ERROR, unable to open %s\n", file);
+    return 0;
+  }
+  while (fgets(line, sizeof(line), input)) {
+    if (line[strspn(line, " \t\r\n")] == 0 || line[0] == '#')
+      continue;
+    if (bench->positions == MAX_BENCH_POSITIONS) {
+      Print(4095, "WARNING, only the first %d positions are used\n",
+          MAX_BENCH_POSITIONS);
+      break;
+    }
+    pos = bench->positions;
+    nargs = ReadParse(line, args, " \t\r\n;");
+    bench->fen[pos][0] = 0;
+    for (i = 0; i < Min(nargs, 4); i++)
+      if (strlen(bench->fen[pos]) + strlen(args[i]) < 126)
+        sprintf(bench->fen[pos] + strlen(bench->fen[pos]), "%s%s",
+            (i) ? " " : "", args[i]);
+    acd = 0;
+    for (i = 4; i < nargs - 1; i++)
+      if (!strcmp(args[i], "acd"))
+        acd = atoi(args[i + 1]);
+    bench->depth[pos] = (depth) ? depth : acd;
+    if (bench->depth[pos] <= 0) {
+      Print(4095, "ERROR, position %d has no depth (use acd or depth=)\n",
+          pos + 1);
+      fclose(input);
+      return 0;
+    }
+    bench->depth[pos] = Max(1, Min(bench->depth[pos] + increase, MAXPLY - 6));
+    bench->positions++;
+  }
+  fclose(input);
+  if (!bench->positions)
+    Print(4095, "ERROR, no positions found in %s\n", file);
+  return bench->positions;
+}
+
+/* last modified 10/18/26 */
+/*
+ *******************************************************************************
+ *                                                                             *
+ *   BenchReport() displays the results of a benchmark.  The per-position      *
+ *   numbers are averages over the repetitions, with the standard deviation.   *
+ *   The totals are computed for each repetition of the whole set and then     *
+ *   averaged.  The "Total nodes" through "Total elapsed time" lines are the   *
+ *   same as before this was extended, since scripts depend on them.  If       *
+ *   "json" is not NULL, everything is also appended to that file as a single  *
+ *   JSON object (one line per benchmark run).  With "pmu on" the hardware     *
+ *   counter metrics (see PmuDisplay()) follow the table.                      *
+ *                                                                             *
+ *******************************************************************************
+ */
+void BenchReport(BENCH * bench, char *json, char *evaluation) {
+  FILE *output = 0;
+  char date[32], label[32];
+  uint64_t counts[PMU_COUNTERS], pmu_nodes, total_pmu_nodes = 0;
+  double nodes[MAX_BENCH_REPEATS], evals[MAX_BENCH_REPEATS];
+  double times[MAX_BENCH_REPEATS], ttds[MAX_BENCH_REPEATS];
+  double nps[MAX_BENCH_REPEATS], n, n_sd, t, t_sd, d, d_sd, s, s_sd, e, e_sd;
+  int pos, rep, i, reps = bench->repeats;
+  time_t now;
+
+  if (json && !(output = fopen(json, "a")))
+    Print(4095, "ERROR, unable to append to %s\n", json);
+  if (output) {
+    now = time(0);
+    strftime(date, sizeof(date), "%Y-%m-%d %H:%M:%S", localtime(&now));
+    fprintf(output, "{\"date\":\"%s\",\"version\":\"%s\",\"evaluation\":\"%s\","
+        "\"threads\":%d,\"hash\":%" PRIu64 ",\"repeats\":%d,\"positions\":[",
+        date, version, evaluation, Max(smp_max_threads, 1),
+        (uint64_t) (hash_table_size * sizeof(HASH_ENTRY)), reps);
+  }
+/*
+ ************************************************************
+ *                                                          *
+ *  One line per position.                                  *
+ *                                                          *
+ ************************************************************
+ */
+  Print(4095, "  pos  depth         nodes      time     (sd)       ttd     (sd)"
+      "        nps    (sd)\n");
+  for (pos = 0; pos < bench->positions; pos++) {
+    for (rep = 0; rep < reps; rep++) {
+      nodes[rep] = bench->nodes[pos][rep];
+      times[rep] = bench->time[pos][rep];
+      ttds[rep] = bench->ttd[pos][rep];
+      nps[rep] = nodes[rep] * 1000.0 / Max(times[rep], 1);
+    }
+    BenchStats(nodes, reps, &n, &n_sd);
+    BenchStats(times, reps, &t, &t_sd);
+    BenchStats(ttds, reps, &d, &d_sd);
+    BenchStats(nps, reps, &s, &s_sd);
+    Print(4095, "  %3d  %5d  %12.0f  %8.3f  (%5.3f)  %8.3f  (%5.3f)  %9s"
+        "  (%4.1f%%)\n", pos + 1, bench->depth[pos], n, t / 1000.0,
+        t_sd / 1000.0, d / 1000.0, d_sd / 1000.0, DisplayKMB((uint64_t) s, 0),
+        100.0 * s_sd / Max(s, 1.0));
+    if (output)
+      fprintf(output, "%s{\"fen\":\"%s\",\"depth\":%d,\"nodes\":%.0f,"
+          "\"nodes_sd\":%.1f,\"time\":%.1f,\"time_sd\":%.1f,\"ttd\":%.1f,"
+          "\"ttd_sd\":%.1f,\"nps\":%.0f,\"nps_sd\":%.0f", (pos) ? "," : "",
+          bench->fen[pos], bench->depth[pos], n, n_sd, t, t_sd, d, d_sd, s,
+          s_sd);
+    if (output && pmu_enabled)
+      PmuWrite(output, bench->pmu[pos], bench->pmu_valid);
+    if (output)
+      fprintf(output, "}");
+  }
 /*
  ************************************************************
  *                                                          *
- *  Now we loop through the six positions.  We use the      *
+ *  With "pmu on", the hardware counter metrics for each    *
+ *  position and for the whole set.                         *
+ *                                                          *
+ ************************************************************
+ */
+  if (pmu_enabled) {
+    memset(counts, 0, sizeof(counts));
+    for (pos = 0; pos < bench->positions; pos++) {
+      pmu_nodes = 0;
+      for (rep = 0; rep < reps; rep++)
+        pmu_nodes += bench->nodes[pos][rep];
+      total_pmu_nodes += pmu_nodes;
+      for (i = 0; i < PMU_COUNTERS; i++)
+        counts[i] += bench->pmu[pos][i];
+      sprintf(label, "  %3d  ", pos + 1);
+      PmuDisplay(label, bench->pmu[pos], bench->pmu_valid, pmu_nodes);
+    }
+    PmuDisplay("  all  ", counts, bench->pmu_valid, total_pmu_nodes);
+  }
+/*
+ ************************************************************
+ *                                                          *
+ *  Now the totals, one per repetition of the whole set.    *
+ *                                                          *
+ ************************************************************
+ */
+  for (rep = 0; rep < reps; rep++) {
+    nodes[rep] = evals[rep] = times[rep] = ttds[rep] = 0;
+    for (pos = 0; pos < bench->positions; pos++) {
+      nodes[rep] += bench->nodes[pos][rep];
+      evals[rep] += bench->evals[pos][rep];
+      times[rep] += bench->time[pos][rep];
+      ttds[rep] += bench->ttd[pos][rep];
+    }
+    nps[rep] = nodes[rep] * 1000.0 / Max(times[rep], 1);
+    evals[rep] = evals[rep] * 1000.0 / Max(times[rep], 1);
+  }
+  BenchStats(nodes, reps, &n, &n_sd);
+  BenchStats(times, reps, &t, &t_sd);
+  BenchStats(ttds, reps, &d, &d_sd);
+  BenchStats(nps, reps, &s, &s_sd);
+  BenchStats(evals, reps, &e, &e_sd);
+  Print(4095, "Total nodes: %" PRIu64 "\n", (uint64_t) n);
+  Print(4095, "Raw nodes per second: %d\n", (int) s);
+  Print(4095, "Evaluations per second: %d\n", (int) e);
+  Print(4095, "Total elapsed time: %.2f\n", t / 1000.0);
+  Print(4095, "Time to depth: %.2f\n", d / 1000.0);
+  if (reps > 1)
+    Print(4095, "Variation over %d runs (sd): nodes %.1f%%, time %.1f%%, "
+        "ttd %.1f%%, nps %.1f%%\n", reps, 100.0 * n_sd / Max(n, 1.0),
+        100.0 * t_sd / Max(t, 1.0), 100.0 * d_sd / Max(d, 1.0),
+        100.0 * s_sd / Max(s, 1.0));
+  if (output) {
+    fprintf(output, "],\"nodes\":%.0f,\"nodes_sd\":%.1f,\"time\":%.1f,"
+        "\"time_sd\":%.1f,\"ttd\":%.1f,\"ttd_sd\":%.1f,\"nps\":%.0f,"
+        "\"nps_sd\":%.0f,\"eps\":%.0f", n, n_sd, t, t_sd, d, d_sd, s, s_sd, e);
+    if (pmu_enabled)
+      PmuWrite(output, counts, bench->pmu_valid);
+    fprintf(output, "}\n");
+    fclose(output);
+  }
+}
+
+/* last modified 10/18/26 */
+/*
+ *******************************************************************************
+ *                                                                             *
+ *   BenchRun() searches every position of the set to its depth, "repeats"     *
+ *   times, starting each search with empty hash tables, and records the       *
+ *   nodes, evaluations, search time, time to depth and idle time of each.     *
+ *   With "pmu on" the hardware counters are read around each search too.      *
+ *                                                                             *
+ *******************************************************************************
+ */
+void BenchRun(BENCH * bench) {
+  TREE *const tree = block[0];
+  uint64_t counts[PMU_COUNTERS];
+  int pos, rep, i;
+
+/*
+ ************************************************************
+ *                                                          *
+ *  Now we loop through the positions.  We use the          *
  *  ReadParse() procedure to break the FEN into tokens and  *
  *  then call SetBoard() to set up the positions.  Then a   *
  *  call to Iterate() and we are done.                      *
  *                                                          *
  ************************************************************
  */
-  for (pos = 0; pos < 6; pos++) {
-    strcpy(buffer, fen[pos]);
-    nargs = ReadParse(buffer, args, " \t;=");
-    SetBoard(tree, nargs, args, 0);
-    search_depth = fen_depth[pos] + increase;
-    InitializeHashTables();
-    last_pv.pathd = 0;
-    thinking = 1;
-    tree->status[1] = tree->status[0];
-    Iterate(game_wtm, think, 0);
-    thinking = 0;
-    nodes += tree->nodes_searched;
-    total_time_used += (program_end_time - program_start_time);
-    _printf(".");
+  memset(bench->pmu, 0, sizeof(bench->pmu));
+  bench->pmu_valid = (1 << PMU_COUNTERS) - 1;
+  for (rep = 0; rep < bench->repeats; rep++)
+    for (pos = 0; pos < bench->positions; pos++) {
+      strcpy(buffer, bench->fen[pos]);
+      nargs = ReadParse(buffer, args, " \t;=");
+      SetBoard(tree, nargs, args, 0);
+      search_depth = bench->depth[pos];
+      InitializeHashTables();
+      last_pv.pathd = 0;
+      thinking = 1;
+      tree->status[1] = tree->status[0];
+      if (pmu_enabled)
+        PmuStart();
+      Iterate(game_wtm, think, 0);
+      if (pmu_enabled) {
+        bench->pmu_valid &= PmuStop(counts);
+        for (i = 0; i < PMU_COUNTERS; i++)
+          bench->pmu[pos][i] += counts[i];
+      }
+      thinking = 0;
+      bench->nodes[pos][rep] = tree->nodes_searched;
+      bench->evals[pos][rep] = tree->evaluations;
+      bench->time[pos][rep] = program_end_time - program_start_time;
+      bench->ttd[pos][rep] = end_time - start_time;
+      bench->idle[pos][rep] = idle_time;
+      _printf(".");
+      fflush(stdout);
+    }
+}
+
+/* last modified 10/19/26 */
+/*
+ *******************************************************************************
+ *                                                                             *
+ *   BenchScaling() measures how well the parallel search scales, started by   *
+ *   "bench scaling [maxmt=N] [file=<epd>] [depth=N] [repeat=K] [hash=SIZE]    *
+ *   [json=<file>]".  The same position set (the bench positions by default,   *
+ *   see BenchLoad()) is searched K times with 1, 2, ... N threads, and for    *
+ *   each thread count we display                                              *
+ *                                                                             *
+ *   (1) the NPS speedup, NPS(N) / NPS(1), which is the hardware side (memory, *
+ *   caches, SMT) plus the cost of the split/join machinery;                   *
+ *                                                                             *
+ *   (2) the time-to-depth speedup, TTD(1) / TTD(N), which is what actually    *
+ *   matters, since it includes the search overhead below;                     *
+ *                                                                             *
+ *   (3) the search overhead, the extra nodes searched to reach the same       *
+ *   depths, nodes(N) / nodes(1) - 1;                                          *
+ *                                                                             *
+ *   (4) the idle percentage, the part of the N threads' time spent waiting    *
+ *   for work, from idle_time.                                                 *
+ *                                                                             *
+ *   All are computed from the totals over the whole set, averaged over the    *
+ *   K repetitions (the parallel search is not deterministic, so a single run  *
+ *   is not very meaningful).  json= appends the whole table as one line.      *
+ *                                                                             *
+ *******************************************************************************
+ */
+void BenchScaling(char *file, int depth, int repeats, int max_threads,
+    size_t hash, char *json) {
+  BENCH *bench;
+  FILE *output = 0;
+  char file_name[FILENAME_MAX], json_name[FILENAME_MAX], date[32];
+  double nodes[MAX_BENCH_REPEATS], ttds[MAX_BENCH_REPEATS];
+  double nps[MAX_BENCH_REPEATS], idle[MAX_BENCH_REPEATS];
+  double mean_nodes[CPUS + 1], mean_ttd[CPUS + 1], mean_nps[CPUS + 1];
+  double mean_idle[CPUS + 1], sdev, times, nps_speedup, ttd_speedup;
+  double overhead;
+  int old_do, old_st, old_sd, old_smp, threads, pos, rep;
+  size_t old_hash;
+  FILE *old_books, *old_book;
+  time_t now;
+
+/*
+ ************************************************************
+ *                                                          *
+ *  Initialize, just as Bench() does.                       *
+ *                                                          *
+ ************************************************************
+ */
+  if (!(bench = (BENCH *) malloc(sizeof(BENCH)))) {
+    Print(4095, "ERROR, not enough memory for the benchmark\n");
+    return;
+  }
+  file_name[0] = 0;
+  json_name[0] = 0;
+  if (file)
+    strcpy(file_name, file);
+  if (json)
+    strcpy(json_name, json);
+  if (!BenchLoad(bench, (file_name[0]) ? file_name : 0, depth, 0)) {
+    free(bench);
+    return;
+  }
+  bench->repeats = Max(1, Min(repeats, MAX_BENCH_REPEATS));
+  max_threads = Max(1, Min((max_threads) ? max_threads : CPUS, CPUS));
+  old_st = search_time_limit;
+  old_sd = search_depth;
+  old_do = display_options;
+  old_smp = smp_max_threads;
+  old_hash = hash_table_size * sizeof(HASH_ENTRY);
+  search_time_limit = 900000;
+  BenchThreads(max_threads);
+  display_options = 1;
+  old_book = book_file;
+  book_file = 0;
+  old_books = books_file;
+  books_file = 0;
+  if (hash)
+    BenchHash(hash);
+  Print(4095, "Running scaling benchmark, 1-%d threads, %d positions, %d "
+      "repetitions. . .\n", max_threads, bench->positions, bench->repeats);
+/*
+ ************************************************************
+ *                                                          *
+ *  Run the set once per thread count, and reduce each run  *
+ *  to the mean totals over the repetitions.                *
+ *                                                          *
+ ************************************************************
+ */
+  for (threads = 1; threads <= max_threads; threads++) {
+    BenchThreads(threads);
+    _printf("%d:", threads);
     fflush(stdout);
+    BenchRun(bench);
+    _printf("\n");
+    for (rep = 0; rep < bench->repeats; rep++) {
+      nodes[rep] = ttds[rep] = idle[rep] = times = 0;
+      for (pos = 0; pos < bench->positions; pos++) {
+        nodes[rep] += bench->nodes[pos][rep];
+        times += bench->time[pos][rep];
+        ttds[rep] += bench->ttd[pos][rep];
+        idle[rep] += bench->idle[pos][rep];
+      }
+      nps[rep] = nodes[rep] * 1000.0 / Max(times, 1);
+      idle[rep] = Min(100.0, 100.0 * idle[rep] / Max(threads * ttds[rep], 1));
+    }
+    BenchStats(nodes, bench->repeats, &mean_nodes[threads], &sdev);
+    BenchStats(ttds, bench->repeats, &mean_ttd[threads], &sdev);
+    BenchStats(nps, bench->repeats, &mean_nps[threads], &sdev);
+    BenchStats(idle, bench->repeats, &mean_idle[threads], &sdev);
   }
 /*
  ************************************************************
  *                                                          *
- *  Benchmark done.  Now dump the results.                  *
+ *  Display the table (and append it to the JSON file),     *
+ *  with everything relative to the one-thread run.         *
  *                                                          *
  ************************************************************
  */
-  _printf("\n");
-  Print(4095, "Total nodes: %" PRIu64 "\n", nodes);
-  Print(4095, "Raw nodes per second: %d\n",
-      (int) ((double) nodes / ((double) total_time_used / (double) 100.0)));
-  Print(4095, "Total elapsed time: %.2f\n",
-      ((double) total_time_used / (double) 100.0));
-
-  early_exit = 99;
+  if (json_name[0] && !(output = fopen(json_name, "a")))
+    Print(4095, "ERROR, unable to append to %s\n", json_name);
+  if (output) {
+    now = time(0);
+    strftime(date, sizeof(date), "%Y-%m-%d %H:%M:%S", localtime(&now));
+    fprintf(output, "{\"date\":\"%s\",\"version\":\"%s\",\"scaling\":true,"
+        "\"hash\":%" PRIu64 ",\"positions\":%d,\"repeats\":%d,\"threads\":[",
+        date, version, (uint64_t) (hash_table_size * sizeof(HASH_ENTRY)),
+        bench->positions, bench->repeats);
+  }
+  Print(4095, "threads        nps  speedup      ttd  speedup        nodes  "
+      "overhead   idle\n");
+  for (threads = 1; threads <= max_threads; threads++) {
+    nps_speedup = mean_nps[threads] / Max(mean_nps[1], 1.0);
+    ttd_speedup = mean_ttd[1] / Max(mean_ttd[threads], 1.0);
+    overhead = mean_nodes[threads] / Max(mean_nodes[1], 1.0) - 1.0;
+    Print(4095, "%7d  %9s  %6.2fx  %7.2f  %6.2fx  %11.0f  %7.1f%%  %4.1f%%\n",
+        threads, DisplayKMB((uint64_t) mean_nps[threads], 0), nps_speedup,
+        mean_ttd[threads] / 1000.0, ttd_speedup, mean_nodes[threads],
+        100.0 * overhead, mean_idle[threads]);
+    if (output)
+      fprintf(output, "%s{\"threads\":%d,\"nps\":%.0f,\"nps_speedup\":%.3f,"
+          "\"ttd\":%.1f,\"ttd_speedup\":%.3f,\"nodes\":%.0f,"
+          "\"overhead\":%.4f,\"idle\":%.2f}", (threads > 1) ? "," : "",
+          threads, mean_nps[threads], nps_speedup, mean_ttd[threads],
+          ttd_speedup, mean_nodes[threads], overhead, mean_idle[threads]);
+  }
+  if (output) {
+    fprintf(output, "]}\n");
+    fclose(output);
+  }
   display_options = old_do;
   search_time_limit = old_st;
   search_depth = old_sd;
   books_file = old_books;
   book_file = old_book;
+  BenchThreads(old_smp);
+  if (hash && hash != old_hash)
+    BenchHash(old_hash);
+  free(bench);
   NewGame(0);
 }
+
+/* last modified 10/18/26 */
+/*
+ *******************************************************************************
+ *                                                                             *
+ *   BenchStats() computes the mean and the (sample) standard deviation of n   *
+ *   values.  The deviation of a single value is zero.                         *
+ *                                                                             *
+ *******************************************************************************
+ */
+void BenchStats(double *values, int n, double *mean, double *sdev) {
+  double sum = 0.0, squares = 0.0;
+  int i;
+
+  for (i = 0; i < n; i++)
+    sum += values[i];
+  *mean = sum / n;
+  for (i = 0; i < n; i++)
+    squares += (values[i] - *mean) * (values[i] - *mean);
+  *sdev = (n > 1) ? sqrt(squares / (n - 1)) : 0.0;
+}
+
+/* last modified 10/19/26 */
+/*
+ *******************************************************************************
+ *                                                                             *
+ *   BenchThreads() sets the number of search threads, exactly as the "mt"     *
+ *   command does (threads above the new limit are told to exit), and shows    *
+ *   the CPU each thread will be bound to.  Bench() and BenchScaling() call it *
+ *   before they quiet the normal output, so the placement is shown once for   *
+ *   the largest thread count that will be used.                               *
+ *                                                                             *
+ *******************************************************************************
+ */
+void BenchThreads(int threads) {
+  int proc;
+
+  smp_max_threads = Max(0, Min(threads, CPUS));
+  for (proc = 1; proc < CPUS; proc++)
+    if (proc >= smp_max_threads)
+      thread[proc].tree = (TREE *) - 1;
+  ThreadPlacement();
+}
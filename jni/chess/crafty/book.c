@@ -4,7 +4,7 @@
 #if defined(UNIX)
 #  include <unistd.h>
 #endif
-/* last modified 05/08/14 */
+/* last modified 10/18/26 */
 /*
  *******************************************************************************
  *                                                                             *
@@ -716,7 +716,7 @@ int Book(TREE * RESTRICT tree, int wtm, int root_list_done) {
  ************************************************************
  */
     which = Random32();
-    j = ReadClock() / 100 % 13;
+    j = ReadClock() / 1000 % 13;
     for (i = 0; i < j; i++)
       which = Random32();
     total_moves = 0;
@@ -1,6 +1,6 @@
 #include "chess.h"
 #include "data.h"
-/* last modified 02/16/14 */
+/* last modified 10/18/26 */
 /*
  *******************************************************************************
  *                                                                             *
@@ -11,7 +11,9 @@
  *                                                                             *
  *   We prefer to use hardware facilities (such as intel BSF/BSR) when they    *
  *   are available, otherwise we resort to C and table lookups to do this in   *
- *   the most efficient way possible.                                          *
+ *   the most efficient way possible.  Building with -DINLINEASM selects the   *
+ *   hardware versions in inline64.h and compiles these out, along with the    *
+ *   64K-entry msb[]/lsb[] tables they need.                                   *
  *                                                                             *
  *******************************************************************************
  */
@@ -37,9 +39,10 @@ int LSB(uint64_t arg1) {
 }
 
 int PopCnt(uint64_t arg1) {
-  int c = 1;
-  while (arg1 &= arg1 - 1)
-    c++;
+  int c;
+
+  for (c = 0; arg1; c++)
+    arg1 &= arg1 - 1;
   return c;
 }
 #endif
@@ -12,6 +12,13 @@ int done = 0;
 uint64_t burner[10] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
 int burnc[10] = {128000, 64000, 32400, 15200, 7600, 3800, 1960, 1040, 480, 140};
 uint64_t total_moves;
+HASH_ENTRY *perft_hash_table = 0;
+size_t perft_hash_table_size = 0;
+size_t perft_hash_bytes = 16 * 1024 * 1024;
+uint64_t perft_hash_mask;
+int perft_moves[256];
+uint64_t perft_counts[256];
+int perft_nmoves, perft_next, perft_depth, perft_wtm;
 int allow_cores = 1;
 int allow_memory = 1;
 int last_mate_score;
@@ -20,6 +27,9 @@ char history_filename[256];
 int number_of_solutions;
 int solutions[10];
 int solution_type;
+int solution_depth;
+unsigned int solution_time;
+uint64_t solution_nodes;
 char cmd_buffer[4096];
 char *args[512];
 char buffer[4096];
@@ -550,7 +560,7 @@ size_t adaptive_hash_min = 0;
 size_t adaptive_hash_max = 0;
 size_t adaptive_hashp_min = 0;
 size_t adaptive_hashp_max = 0;
-int time_limit = 100;
+int time_limit = 1000;
 int force = 0;
 char initial_position[80] = { "" };
 char hint[512] = { "" };
@@ -576,6 +586,10 @@ int root_beta;
 int last_root_value;
 ROOT_MOVE root_moves[256];
 int n_root_moves;
+int multi_pv = 1;
+int multipv_index = 0;
+int multipv_lines = 0;
+PATH multipv_pv[MAX_MULTIPV];
 int difficulty;
 int absolute_time_limit;
 int search_time_limit;
@@ -587,19 +601,26 @@ unsigned int start_time, end_time;
 TREE *block[MAX_BLOCKS + 1];
 THREAD thread[CPUS];
 #if (CPUS > 1)
-lock_t lock_split, lock_smp, lock_io, lock_root, lock_buffer;
+spinlock_t lock_split, lock_smp, lock_root;
+lock_t lock_io, lock_buffer, lock_perft;
 #if defined(UNIX)
   pthread_attr_t attributes;
 #endif
 #endif
+CPU_INFO smp_cpus[MAX_TOPOLOGY_CPUS];
+int smp_ncpus = 0;
+int smp_affinity[CPUS];
+int smp_bind_error[CPUS];           /* errno if sched_setaffinity() failed */
 int smp_max_threads = 0;
 int smp_split_group = 5;           /* max threads per group - 1 */
 int smp_split_at_root = 1;
 int smp_min_split_depth = 5;
 unsigned int smp_split_nodes = 2000;
+int smp_autotune = 0;
 unsigned int parallel_splits;
 unsigned int parallel_aborts;
 unsigned int idle_time;
+uint64_t smp_stats_start;
 unsigned int max_split_blocks = 0;
 unsigned int idle_percent = 0;
 volatile int smp_idle = 0;
@@ -610,20 +631,24 @@ int crafty_is_white = 0;
 unsigned int nodes_between_time_checks = 1000000;
 unsigned int nodes_per_second = 1000000;
 int next_time_check = 100000;
+volatile int time_check_due = 0;
+volatile int timer_running = 0;
+volatile long timer_generation = 0;
+int time_abort_deadline = 0;
 int transposition_age = 0;
 int thinking = 0;
 int pondering = 0;
 int puzzling = 0;
 int booking = 0;
 int display_options = 4095 - 256 - 512;
-unsigned int noise_level = 100;
+unsigned int noise_level = 1000;
 int noise_block = 0;
 int tc_moves = 60;
-int tc_time = 180000;
-int tc_time_remaining[2] = { 180000, 180000 };
+int tc_time = 1800000;
+int tc_time_remaining[2] = { 1800000, 1800000 };
 int tc_moves_remaining[2] = { 60, 60 };
 int tc_secondary_moves = 30;
-int tc_secondary_time = 90000;
+int tc_secondary_time = 900000;
 int tc_increment = 0;
 int tc_sudden_death = 0;
 int tc_operator_time = 0;
@@ -643,6 +668,24 @@ int show_book = 0;
 int book_selection_width = 5;
 int ponder = 1;
 int trace_level = 0;
+char *bench_fen[6] = {
+  "3r1k2/4npp1/1ppr3p/p6P/P2PPPP1/1NR5/5K2/2R5 w - - 0 1",
+  "rnbqkb1r/p3pppp/1p6/2ppP3/3N4/2P5/PPP1QPPP/R1B1KB1R w KQkq - 0 1",
+  "4b3/p3kp2/6p1/3pP2p/2pP1P2/4K1P1/P3N2P/8 w - - 0 1",
+  "r3r1k1/ppqb1ppp/8/4p1NQ/8/2P5/PP3PPP/R3R1K1 b - - 0 1",
+  "2r2rk1/1bqnbpp1/1p1ppn1p/pP6/N1P1P3/P2B1N1P/1B2QPP1/R2R2K1 b - - 0 1",
+  "r1bqk2r/pp2bppp/2p5/3pP3/P2Q1P2/2N1B3/1PP3PP/R4RK1 b kq - 0 1"
+};
+int bench_depth[6] = { 22, 20, 26, 21, 22, 19 };
+int pmu_enabled = 0;
+int pmu_fd[PMU_COUNTERS] = { -1, -1, -1, -1, -1, -1 };
+char *pmu_names[PMU_COUNTERS] = {
+  "cycles", "instructions", "L1D-miss", "LLC-miss", "branch-miss", "dTLB-miss"
+};
+#if defined(STATS)
+SEARCH_STATS search_stats[CPUS];
+#endif
+JOURNAL_HEADER *journal_buffer[CPUS];
 /*  for the following 6 lines, each pair should have */
 /*  the same numeric value (the size value).         */
 size_t hash_table_size = 524288;
@@ -714,8 +757,8 @@ unsigned int magic_bishop_shift[64] = {
   59, 59, 59, 59, 59, 59, 59, 59,
   58, 59, 59, 59, 59, 59, 59, 58
 };
-uint64_t magic_bishop_table[5248];
-uint64_t *magic_bishop_indices[64] = {
+MAGIC_ENTRY magic_bishop_table[5248];
+MAGIC_ENTRY *magic_bishop_indices[64] = {
   magic_bishop_table + 4992, magic_bishop_table + 2624,
   magic_bishop_table + 256, magic_bishop_table + 896,
   magic_bishop_table + 1280, magic_bishop_table + 1664,
@@ -749,6 +792,7 @@ uint64_t *magic_bishop_indices[64] = {
   magic_bishop_table + 1632, magic_bishop_table + 2272,
   magic_bishop_table + 4896, magic_bishop_table + 5184
 };
+#if !defined(COMPACT_MAGIC)
 int16_t magic_bishop_mobility_table[5248];
 int16_t *magic_bishop_mobility_indices[64] = {
   magic_bishop_mobility_table + 4992, magic_bishop_mobility_table + 2624,
@@ -784,8 +828,13 @@ int16_t *magic_bishop_mobility_indices[64] = {
   magic_bishop_mobility_table + 1632, magic_bishop_mobility_table + 2272,
   magic_bishop_mobility_table + 4896, magic_bishop_mobility_table + 5184
 };
-uint64_t magic_rook_table[102400];
-uint64_t *magic_rook_indices[64] = {
+#else
+uint64_t magic_bishop_attacks[1428];
+int16_t magic_bishop_mobility[1428];
+int magic_bishop_base[64];
+#endif
+MAGIC_ENTRY magic_rook_table[102400];
+MAGIC_ENTRY *magic_rook_indices[64] = {
   magic_rook_table + 86016, magic_rook_table + 73728,
   magic_rook_table + 36864, magic_rook_table + 43008,
   magic_rook_table + 47104, magic_rook_table + 51200,
@@ -819,6 +868,7 @@ uint64_t *magic_rook_indices[64] = {
   magic_rook_table + 49152, magic_rook_table + 55296,
   magic_rook_table + 79872, magic_rook_table + 98304
 };
+#if !defined(COMPACT_MAGIC)
 int16_t magic_rook_mobility_table[102400];
 int16_t *magic_rook_mobility_indices[64] = {
   magic_rook_mobility_table + 86016, magic_rook_mobility_table + 73728,
@@ -854,6 +904,11 @@ int16_t *magic_rook_mobility_indices[64] = {
   magic_rook_mobility_table + 49152, magic_rook_mobility_table + 55296,
   magic_rook_mobility_table + 79872, magic_rook_mobility_table + 98304
 };
+#else
+uint64_t magic_rook_attacks[4900];
+int16_t magic_rook_mobility[4900];
+int magic_rook_base[64];
+#endif
 uint64_t magic_rook[64] = {
   0x0080001020400080ull, 0x0040001000200040ull, 0x0080081000200080ull,
   0x0080040800100080ull, 0x0080020400080080ull, 0x0080010200040080ull,
@@ -1238,6 +1293,29 @@ int qval[2][2][64] = {
       0,   0,   4,   4,   4,   4,   0,   0,
       0,   0,   0,   0,   0,   0,   0,   0 }}
 };
+/*
+   pcsq[piece] selects the piece/square table that MakeMove() and
+   UnmakeMove() use to keep the incremental PcSqMG()/PcSqEG() totals.
+   Pawns point to an all-zero table since pval[] is already folded into
+   the pawn hash score, as do rooks and kings which have no plain piece/
+   square table (kval_*[] depends on the pawn structure.)
+ */
+int pcsq_none[2][2][64];
+int (*const pcsq[7])[2][64] =
+    { pcsq_none, pcsq_none, nval, bval, pcsq_none, qval, pcsq_none };
+/*
+   the NNUE network (see nnue.c).  nnue_input_weights is zero until a
+   network has been loaded, and nnue_enabled selects it in place of the
+   normal evaluation.
+ */
+#if defined(NNUE)
+int nnue_enabled = 0;
+char nnue_file[256] = { 0 };
+int16_t *nnue_input_weights = 0;
+int16_t *nnue_input_bias;
+int16_t *nnue_output_weights;
+int32_t nnue_output_bias;
+#endif
 int kval_n[2][64] = {
    {-40, -40, -40, -40, -40, -40, -40, -40,
     -40, -10, -10, -10, -10, -10, -10, -40,
@@ -1,6 +1,6 @@
 #include "chess.h"
 #include "data.h"
-/* last modified 08/17/14 */
+/* last modified 10/18/26 */
 /*
  *******************************************************************************
  *                                                                             *
@@ -40,6 +40,20 @@ int Evaluate(TREE * RESTRICT tree, int ply, int wtm, int alpha, int beta) {
       abort_search = 1;
   }
 #endif
+/*
+ **********************************************************************
+ *                                                                    *
+ *  If a neural network has been loaded and selected with the "nnue"  *
+ *  command, it replaces everything that follows.                     *
+ *                                                                    *
+ **********************************************************************
+ */
+#if defined(NNUE)
+  if (nnue_enabled) {
+    tree->evaluations++;
+    return NnueEvaluate(tree, wtm);
+  }
+#endif
 /*
  **********************************************************************
  *                                                                    *
@@ -55,10 +69,15 @@ int Evaluate(TREE * RESTRICT tree, int ply, int wtm, int alpha, int beta) {
   cutoff = (TotalPieces(white, occupied) && TotalPieces(black, occupied))
       ? KNIGHT_VALUE : ROOK_VALUE;
   lscore = MaterialSTM(wtm);
-  if (lscore + cutoff < alpha)
+  Stat(tree, evaluations);
+  if (lscore + cutoff < alpha) {
+    Stat(tree, lazy_exits);
     return alpha;
-  if (lscore - cutoff > beta)
+  }
+  if (lscore - cutoff > beta) {
+    Stat(tree, lazy_exits);
     return beta;
+  }
   tree->evaluations++;
   tree->score_mg = 0;
   tree->score_eg = 0;
@@ -230,6 +249,11 @@ int Evaluate(TREE * RESTRICT tree, int ply, int wtm, int alpha, int beta) {
  *  beta, there is no point in doing the piece scoring, so we take a  *
  *  "lazy" approach and skip pieces in that case.                     *
  *                                                                    *
+ *  The piece/square scores for knights, bishops and queens are not   *
+ *  computed by the Evaluate*() procedures, they are the running      *
+ *  totals PcSqMG()/PcSqEG() kept by MakeMove() and UnmakeMove(), so  *
+ *  all that is needed is to add them in.                             *
+ *                                                                    *
  *  Note 2:  We MUST evaluate kings last, since their scoring depends *
  *  on the tropism scores computed by the other piece evaluations.    *
  *                                                                    *
@@ -244,6 +268,8 @@ int Evaluate(TREE * RESTRICT tree, int ply, int wtm, int alpha, int beta) {
   if (lscore + cutoff > alpha && lscore - cutoff < beta) {
     tree->tropism[white] = 0;
     tree->tropism[black] = 0;
+    tree->score_mg += PcSqMG(white) - PcSqMG(black);
+    tree->score_eg += PcSqEG(white) - PcSqEG(black);
     for (side = black; side <= white; side++)
       EvaluateKnights(tree, side);
     for (side = black; side <= white; side++)
@@ -279,7 +305,7 @@ int Evaluate(TREE * RESTRICT tree, int ply, int wtm, int alpha, int beta) {
   return (wtm) ? score : -score;
 }
 
-/* last modified 08/17/14 */
+/* last modified 10/18/26 */
 /*
  *******************************************************************************
  *                                                                             *
@@ -294,15 +320,14 @@ void EvaluateBishops(TREE * RESTRICT tree, int side) {
 /*
  ************************************************************
  *                                                          *
- *  First, locate each bishop and add in its piece/square   *
- *  score.                                                  *
+ *  First, locate each bishop.  Its piece/square score      *
+ *  ("bval") is kept incrementally by MakeMove() and added  *
+ *  in by Evaluate().                                       *
  *                                                          *
  ************************************************************
  */
   for (temp = Bishops(side); temp; temp &= temp - 1) {
     square = LSB(temp);
-    score_mg += bval[mg][side][square];
-    score_eg += bval[eg][side][square];
 /*
  ************************************************************
  *                                                          *
@@ -702,7 +727,7 @@ int EvaluateKingsFile(TREE * RESTRICT tree, int whichfile, int side) {
   return defects;
 }
 
-/* last modified 07/20/14 */
+/* last modified 10/18/26 */
 /*
  *******************************************************************************
  *                                                                             *
@@ -718,15 +743,14 @@ void EvaluateKnights(TREE * RESTRICT tree, int side) {
 /*
  ************************************************************
  *                                                          *
- *  First fold in centralization score from the piece/      *
- *  square table "nval".                                    *
+ *  First locate each knight.  The centralization score     *
+ *  from the piece/square table "nval" is kept              *
+ *  incrementally by MakeMove() and added in by Evaluate(). *
  *                                                          *
  ************************************************************
  */
   for (temp = Knights(side); temp; temp &= temp - 1) {
     square = LSB(temp);
-    score_mg += nval[mg][side][square];
-    score_eg += nval[eg][side][square];
 /*
  ************************************************************
  *                                                          *
@@ -1255,7 +1279,7 @@ void EvaluatePassedPawnRaces(TREE * RESTRICT tree, int wtm) {
  *                                                                             *
  *******************************************************************************
  */
-void EvaluatePawns(TREE * RESTRICT tree, int side) {
+COLORED void EvaluatePawnsColor(TREE * RESTRICT tree, const int side) {
   uint64_t pawns;
   uint64_t temp;
   uint64_t p_moves[2];
@@ -1501,7 +1525,24 @@ void EvaluatePawns(TREE * RESTRICT tree, int side) {
   tree->pawn_score.score_eg += sign[side] * score_eg;
 }
 
-/* last modified 02/23/14 */
+/* last modified 10/18/26 */
+/*
+ *******************************************************************************
+ *                                                                             *
+ *   EvaluatePawns() runs the white or black copy of EvaluatePawnsColor(),     *
+ *   where the rank and direction tests for <side> are compile-time            *
+ *   constants.                                                                *
+ *                                                                             *
+ *******************************************************************************
+ */
+void EvaluatePawns(TREE * RESTRICT tree, int side) {
+  if (side)
+    EvaluatePawnsColor(tree, white);
+  else
+    EvaluatePawnsColor(tree, black);
+}
+
+/* last modified 10/18/26 */
 /*
  *******************************************************************************
  *                                                                             *
@@ -1517,23 +1558,15 @@ void EvaluateQueens(TREE * RESTRICT tree, int side) {
 /*
  ************************************************************
  *                                                          *
- *  First locate each queen and obtain it's centralization  *
- *  score from the static piece/square table for queens.    *
+ *  First locate each queen.  The centralization score from *
+ *  the piece/square table "qval" is not added here, it is  *
+ *  kept incrementally by MakeMove() and added in by        *
+ *  Evaluate().                                             *
  *                                                          *
  ************************************************************
  */
   for (temp = Queens(side); temp; temp &= temp - 1) {
     square = LSB(temp);
-/*
- ************************************************************
- *                                                          *
- *  Then, add in the piece/square table value for the       *
- *  queen.                                                  *
- *                                                          *
- ************************************************************
-*/
-    score_mg += qval[mg][side][square];
-    score_eg += qval[eg][side][square];
 /*
  ************************************************************
  *                                                          *
@@ -29,6 +29,7 @@ void Initialize() {
   InitializeMasks();
   InitializeMagic();
   InitializeSMP();
+  InitializeTopology();
   InitializeAttackBoards();
   InitializePawnMasks();
   InitializeChessBoard(tree);
@@ -129,11 +130,14 @@ void Initialize() {
  */
 #if defined(AFFINITY)
   cpu_set_t cpuset;
-  pthread_t current_thread = pthread_self();
 
   CPU_ZERO(&cpuset);
-  CPU_SET(0, &cpuset);
-  pthread_setaffinity_np(current_thread, sizeof(cpu_set_t), &cpuset);
+  CPU_SET(smp_affinity[0], &cpuset);
+  if (sched_setaffinity(0, sizeof(cpu_set_t), &cpuset)) {
+    smp_bind_error[0] = errno;
+    Print(4095, "ERROR, unable to bind thread 0 to cpu %d (%s)\n",
+        smp_affinity[0], strerror(errno));
+  }
 #endif
 #if !defined(UNIX)
   ThreadMalloc((int) 0);
@@ -146,7 +150,7 @@ void Initialize() {
   }
   for (i = 1; i < MAX_BLOCKS_PER_CPU; i++) {
     memset((void *) block[i], 0, sizeof(TREE));
-    LockInit(block[i]->lock);
+    SpinLockInit(block[i]->lock);
   }
 #endif
   initialized_threads++;
@@ -376,10 +380,20 @@ void InitializeAttackBoards(void) {
  *   vectors, which saves significant time in the evaluation, since it is done *
  *   here before the game actually starts.                                     *
  *                                                                             *
+ *   The entries are indexed with BishopIndex()/RookIndex() so that the same   *
+ *   code fills in the tables for either the magic multiply or pext.  With     *
+ *   -DCOMPACT_MAGIC, each distinct attack set for a square is stored once in  *
+ *   magic_*_attacks[] (with its mobility score) and the magic table entry is  *
+ *   just the offset of that set from magic_*_base[square].                    *
+ *                                                                             *
  *******************************************************************************
  */
 void InitializeMagic(void) {
   int i, j, m;
+  uint64_t attacks;
+#if defined(COMPACT_MAGIC)
+  int unique = 0;
+#endif
   int initmagicmoves_bitpos64_database[64] = {
     63, 0, 58, 1, 59, 47, 53, 2,
     60, 39, 48, 27, 54, 33, 42, 3,
@@ -398,6 +412,9 @@ void InitializeMagic(void) {
     int numsquares = 0;
     uint64_t temp = magic_bishop_mask[i];
 
+#if defined(COMPACT_MAGIC)
+    magic_bishop_base[i] = unique;
+#endif
     while (temp) {
       uint64_t abit = temp & -temp;
 
@@ -411,26 +428,43 @@ void InitializeMagic(void) {
       uint64_t tempoccupied =
           InitializeMagicOccupied(squares, numsquares, temp);
       moves = InitializeMagicBishop(i, tempoccupied);
-      *(magic_bishop_indices[i] +
-          (tempoccupied * magic_bishop[i] >> magic_bishop_shift[i])) = moves;
+      attacks = moves;
       moves |= SetMask(i);
       m = -lower_b;
       for (j = 0; j < 4; j++)
         m += PopCnt(moves & mobility_mask_b[j]) * mobility_score_b[j];
       if (m < 0)
         m *= 2;
-      *(magic_bishop_mobility_indices[i] +
-          (tempoccupied * magic_bishop[i] >> magic_bishop_shift[i])) = m;
+#if defined(COMPACT_MAGIC)
+      for (j = magic_bishop_base[i]; j < unique; j++)
+        if (magic_bishop_attacks[j] == attacks)
+          break;
+      if (j == unique) {
+        magic_bishop_attacks[unique] = attacks;
+        magic_bishop_mobility[unique++] = m;
+      }
+      magic_bishop_indices[i][BishopIndex(i, tempoccupied)] =
+          j - magic_bishop_base[i];
+#else
+      magic_bishop_indices[i][BishopIndex(i, tempoccupied)] = attacks;
+      magic_bishop_mobility_indices[i][BishopIndex(i, tempoccupied)] = m;
+#endif
     }
   }
 /*
  Rook attacks and mobility
  */
+#if defined(COMPACT_MAGIC)
+  unique = 0;
+#endif
   for (i = 0; i < 64; i++) {
     int squares[64];
     int numsquares = 0;
     uint64_t temp = magic_rook_mask[i];
 
+#if defined(COMPACT_MAGIC)
+    magic_rook_base[i] = unique;
+#endif
     while (temp) {
       uint64_t abit = temp & -temp;
 
@@ -443,15 +477,27 @@ void InitializeMagic(void) {
       uint64_t tempoccupied =
           InitializeMagicOccupied(squares, numsquares, temp);
       uint64_t moves = InitializeMagicRook(i, tempoccupied);
-      *(magic_rook_indices[i] +
-          (tempoccupied * magic_rook[i] >> magic_rook_shift[i])) = moves;
+
+      attacks = moves;
       moves |= SetMask(i);
       m = -1;
       for (j = 0; j < 4; j++)
         m += PopCnt(moves & mobility_mask_r[j]) * mobility_score_r[j];
-      *(magic_rook_mobility_indices[i] +
-          (tempoccupied * magic_rook[i] >> magic_rook_shift[i])) =
+#if defined(COMPACT_MAGIC)
+      for (j = magic_rook_base[i]; j < unique; j++)
+        if (magic_rook_attacks[j] == attacks)
+          break;
+      if (j == unique) {
+        magic_rook_attacks[unique] = attacks;
+        magic_rook_mobility[unique++] = mob_curve_r[m];
+      }
+      magic_rook_indices[i][RookIndex(i, tempoccupied)] =
+          j - magic_rook_base[i];
+#else
+      magic_rook_indices[i][RookIndex(i, tempoccupied)] = attacks;
+      magic_rook_mobility_indices[i][RookIndex(i, tempoccupied)] =
           mob_curve_r[m];
+#endif
     }
   }
 }
@@ -659,7 +705,9 @@ void InitializeChessBoard(TREE * tree) {
  *******************************************************************************
  *                                                                             *
  *   SetChessBitBoards() is used to set the occupied-square bitboards so that  *
- *   they agree with the current real chessboard.                              *
+ *   they agree with the current real chessboard.  The hash signatures,        *
+ *   material and piece/square totals that MakeMove() and UnmakeMove() keep    *
+ *   incrementally are recomputed from scratch here as well.                   *
  *                                                                             *
  *******************************************************************************
  */
@@ -684,6 +732,10 @@ void SetChessBitBoards(TREE * tree) {
       HashP(side, square);
     Material += PieceValues(side, Abs(piece));
   }
+  InitializePieceSquare(tree);
+#if defined(NNUE)
+  NnueRefresh(tree);
+#endif
   if (Pieces(white, king))
     KingSQ(white) = LSB(Pieces(white, king));
   if (Pieces(black, king))
@@ -724,6 +776,30 @@ void SetChessBitBoards(TREE * tree) {
   tree->rep_list[0] = HashKey;
 }
 
+/* last modified 10/18/26 */
+/*
+ *******************************************************************************
+ *                                                                             *
+ *   InitializePieceSquare() recomputes the piece/square totals (PcSqMG() and  *
+ *   PcSqEG()) that MakeMove() and UnmakeMove() update incrementally.  It is   *
+ *   called by SetChessBitBoards() and after a "personality" command, which    *
+ *   might have changed one of the piece/square tables.                        *
+ *                                                                             *
+ *******************************************************************************
+ */
+void InitializePieceSquare(TREE * RESTRICT tree) {
+  int side, square;
+
+  for (side = black; side <= white; side++) {
+    PcSqMG(side) = 0;
+    PcSqEG(side) = 0;
+  }
+  for (square = 0; square < 64; square++)
+    if (PcOnSq(square))
+      PcSqAdd((PcOnSq(square) > 0) ? white : black, Abs(PcOnSq(square)),
+          square);
+}
+
 /*
  *******************************************************************************
  *                                                                             *
@@ -1156,14 +1232,145 @@ void InitializePawnMasks(void) {
  *******************************************************************************
  */
 void InitializeSMP(void) {
-  LockInit(lock_smp);
-  LockInit(lock_split);
+  SpinLockInit(lock_smp);
+  SpinLockInit(lock_split);
   LockInit(lock_io);
-  LockInit(lock_root);
+  SpinLockInit(lock_root);
   LockInit(lock_buffer);
-  LockInit(block[0]->lock);
+  LockInit(lock_perft);
+  SpinLockInit(block[0]->lock);
 #if defined(UNIX) && (CPUS > 1)
   pthread_attr_init(&attributes);
   pthread_attr_setdetachstate(&attributes, PTHREAD_CREATE_DETACHED);
 #endif
 }
+
+/*
+ *******************************************************************************
+ *                                                                             *
+ *   InitializeTopology() reads the CPU topology from sysfs and decides which  *
+ *   logical CPU each search thread will be bound to.  On big.LITTLE and other *
+ *   mixed-capacity parts a helper running on a slow core finishes its share   *
+ *   of a split point late and holds up the fast ones, and two threads on SMT  *
+ *   siblings share one core's execution units.  So the CPUs are ordered by    *
+ *   cpu_capacity (highest first), and we first hand out one logical CPU per   *
+ *   distinct physical core (cluster/package + core_id), then the remaining    *
+ *   SMT siblings.  Kernels that do not export cpu_capacity fall back to the   *
+ *   maximum cpufreq frequency, and anything that exports neither ends up with *
+ *   the old thread N -> CPU N mapping.  Only the CPUs in our affinity mask   *
+ *   are used, so offline cores are skipped.  smp_affinity[tid] is used by     *
+ *   ThreadInit() when built with -DAFFINITY, and "mt" displays it.            *
+ *                                                                             *
+ *******************************************************************************
+ */
+static int InitializeTopologyRead(int cpu, const char *file, int missing) {
+  char path[128];
+  FILE *f;
+  int value;
+
+  sprintf(path, "/sys/devices/system/cpu/cpu%d/%s", cpu, file);
+  if (!(f = fopen(path, "r")))
+    return missing;
+  if (fscanf(f, "%d", &value) != 1)
+    value = missing;
+  fclose(f);
+  return value;
+}
+
+void InitializeTopology(void) {
+  CPU_INFO temp, placed[MAX_TOPOLOGY_CPUS];
+  int i, j, n, cpu, used[MAX_TOPOLOGY_CPUS], order[MAX_TOPOLOGY_CPUS];
+#if defined(AFFINITY)
+  cpu_set_t allowed;
+#endif
+
+/*
+ ************************************************************
+ *                                                          *
+ *  The candidate CPUs are the ones this process may run    *
+ *  on.  Cores that are offline (Android parks big cores    *
+ *  routinely) or outside our cpuset are not in the mask,   *
+ *  and binding a thread to one of them would fail.  The    *
+ *  numbering can have holes, so smp_cpus[].cpu keeps the   *
+ *  real CPU number.  Without the mask we fall back to the  *
+ *  online CPU count.                                       *
+ *                                                          *
+ ************************************************************
+ */
+  smp_ncpus = 0;
+#if defined(AFFINITY)
+  CPU_ZERO(&allowed);
+  if (!sched_getaffinity(0, sizeof(cpu_set_t), &allowed))
+    for (cpu = 0; cpu < CPU_SETSIZE && smp_ncpus < MAX_TOPOLOGY_CPUS; cpu++)
+      if (CPU_ISSET(cpu, &allowed))
+        smp_cpus[smp_ncpus++].cpu = cpu;
+#endif
+  if (!smp_ncpus) {
+#if defined(UNIX)
+    n = Min(Max((int) sysconf(_SC_NPROCESSORS_ONLN), 1), MAX_TOPOLOGY_CPUS);
+#else
+    n = Min(CPUS, MAX_TOPOLOGY_CPUS);
+#endif
+    for (cpu = 0; cpu < n; cpu++)
+      smp_cpus[smp_ncpus++].cpu = cpu;
+  }
+  for (i = 0; i < smp_ncpus; i++) {
+    cpu = smp_cpus[i].cpu;
+    smp_cpus[i].capacity = InitializeTopologyRead(cpu, "cpu_capacity", -1);
+    if (smp_cpus[i].capacity < 0)
+      smp_cpus[i].capacity =
+          InitializeTopologyRead(cpu, "cpufreq/cpuinfo_max_freq", 1024);
+    smp_cpus[i].cluster =
+        InitializeTopologyRead(cpu, "topology/cluster_id", -1);
+    if (smp_cpus[i].cluster < 0)
+      smp_cpus[i].cluster =
+          InitializeTopologyRead(cpu, "topology/physical_package_id", 0);
+    smp_cpus[i].core = InitializeTopologyRead(cpu, "topology/core_id", cpu);
+  }
+/*
+ ************************************************************
+ *                                                          *
+ *  Stable insertion sort on capacity, so that CPUs with    *
+ *  equal capacity keep their natural (kernel) order.       *
+ *                                                          *
+ ************************************************************
+ */
+  for (i = 1; i < smp_ncpus; i++) {
+    temp = smp_cpus[i];
+    for (j = i; j > 0 && smp_cpus[j - 1].capacity < temp.capacity; j--)
+      smp_cpus[j] = smp_cpus[j - 1];
+    smp_cpus[j] = temp;
+  }
+/*
+ ************************************************************
+ *                                                          *
+ *  First pass takes the first logical CPU of each physical *
+ *  core, second pass appends the SMT siblings.  smp_cpus[] *
+ *  is then left in placement order, so thread N runs on    *
+ *  smp_cpus[N % smp_ncpus].                                *
+ *                                                          *
+ ************************************************************
+ */
+  for (i = 0; i < smp_ncpus; i++)
+    used[i] = 0;
+  n = 0;
+  for (i = 0; i < smp_ncpus; i++) {
+    for (j = 0; j < n; j++)
+      if (smp_cpus[order[j]].cluster == smp_cpus[i].cluster &&
+          smp_cpus[order[j]].core == smp_cpus[i].core)
+        break;
+    if (j == n) {
+      order[n++] = i;
+      used[i] = 1;
+    }
+  }
+  for (i = 0; i < smp_ncpus; i++)
+    if (!used[i])
+      order[n++] = i;
+  for (i = 0; i < smp_ncpus; i++)
+    placed[i] = smp_cpus[order[i]];
+  for (i = 0; i < smp_ncpus; i++)
+    smp_cpus[i] = placed[i];
+  for (i = 0; i < CPUS; i++)
+    smp_affinity[i] = smp_cpus[i % smp_ncpus].cpu;
+}
@@ -1,7 +1,7 @@
 #include <signal.h>
 #include "chess.h"
 #include "data.h"
-/* last modified 01/17/09 */
+/* last modified 10/18/26 */
 /*
  *******************************************************************************
  *                                                                             *
@@ -64,7 +64,8 @@ void Interrupt(int ply) {
  ************************************************************
  *                                                          *
  *  "." command displays status of current search (this is  *
- *  part of winboard protocol.)                             *
+ *  part of winboard protocol.)  The protocol wants stat01  *
+ *  time in centiseconds, not our internal milliseconds.    *
  *                                                          *
  ************************************************************
  */
@@ -72,7 +73,7 @@ void Interrupt(int ply) {
         if (xboard) {
           end_time = ReadClock();
           time_used = (end_time - start_time);
-          _printf("stat01: %d ", time_used);
+          _printf("stat01: %d ", time_used / 10);
           _printf("%" PRIu64 " ", tree->nodes_searched);
           _printf("%d ", iteration_depth);
           for (i = 0; i < n_root_moves; i++)
@@ -1,7 +1,7 @@
 #include "chess.h"
 #include "data.h"
 #include "epdglue.h"
-/* last modified 04/24/14 */
+/* last modified 10/19/26 */
 /*
  *******************************************************************************
  *                                                                             *
@@ -38,12 +38,19 @@
  *   Those modes are handled within Book() and Ponder() but they all use the   *
  *   same iterated search as is used for normal moves.                         *
  *                                                                             *
+ *   (3) "multipv N" keeps the best N lines rather than just the best one, by  *
+ *   searching the root moves N times per iteration, each pass excluding the   *
+ *   moves that are already the head of a better line.  See the aspiration     *
+ *   loop below.                                                               *
+ *                                                                             *
  *******************************************************************************
  */
 int Iterate(int wtm, int search_type, int root_list_done) {
   TREE *const tree = block[0];
-  int i, root_alpha, old_root_alpha, old_root_beta;
+  int i, j, root_alpha, old_root_alpha, old_root_beta;
   int value = 0, twtm, correct, correct_count;
+  PATH temp_pv;
+  ROOT_MOVE temp_rm;
   char *fl_indicator, *fh_indicator;
 #if (CPUS > 1)
   pthread_t pt;
@@ -76,7 +83,14 @@ int Iterate(int wtm, int search_type, int root_list_done) {
  ************************************************************
  */
   idle_time = 0;
+  for (i = 0; i < CPUS; i++)
+    memset(&thread[i].stats, 0, sizeof(SMP_STATS));
+  smp_stats_start = LockClock();
+#if defined(STATS)
+  memset(search_stats, 0, sizeof(search_stats));
+#endif
   tree->curmv[0] = 0;
+  multipv_lines = 0;
   abort_search = 0;
   book_move = 0;
   program_start_time = ReadClock();
@@ -89,7 +103,8 @@ int Iterate(int wtm, int search_type, int root_list_done) {
   parallel_splits = 0;
   parallel_aborts = 0;
   correct_count = 0;
-  burp = 15 * 100;
+  solution_depth = 0;
+  burp = 15 * 1000;
   transposition_age = (transposition_age + 1) & 0x1ff;
   next_time_check = nodes_between_time_checks;
   tree->evaluations = 0;
@@ -97,12 +112,15 @@ int Iterate(int wtm, int search_type, int root_list_done) {
   tree->egtb_probes_successful = 0;
   tree->extensions_done = 0;
   tree->qchecks_done = 0;
+  tree->attack_map_hits = 0;
+  tree->attack_map_fills = 0;
   tree->moves_fpruned = 0;
   for (i = 0; i < 16; i++)
     tree->LMR_done[i] = 0;
   for (i = 0; i < 32; i++)
     tree->null_done[i] = 0;
   HistoryAge();
+  RepeatFilter(tree);
   root_wtm = wtm;
 /*
  ************************************************************
@@ -215,13 +233,17 @@ int Iterate(int wtm, int search_type, int root_list_done) {
  *                                                          *
  *  If we are using multiple threads, and they have not     *
  *  been started yet, then start them now as the search is  *
- *  ready to begin.                                         *
+ *  ready to begin.  A thread that could not be bound to    *
+ *  its CPU is reported once it has initialized.            *
  *                                                          *
  ************************************************************
  */
 #if (CPUS > 1)
       if (smp_max_threads > smp_idle + 1) {
         long proc;
+#  if defined(AFFINITY)
+        long first = smp_threads + 1;
+#  endif
 
         initialized_threads = 1;
         Print(128, "starting thread");
@@ -236,9 +258,18 @@ int Iterate(int wtm, int search_type, int root_list_done) {
           smp_threads++;
         }
         Print(128, " <done>\n");
+#  if defined(AFFINITY)
+        WaitForAllThreadsInitialized();
+        for (proc = first; proc < smp_max_threads; proc++)
+          if (smp_bind_error[proc])
+            Print(4095, "ERROR, unable to bind thread %d to cpu %d (%s)\n",
+                (int) proc, smp_affinity[proc],
+                strerror(smp_bind_error[proc]));
+#  endif
       }
       WaitForAllThreadsInitialized();
 #endif
+      TimerStart();
       if (search_nodes)
         nodes_between_time_checks = search_nodes;
       for (; iteration_depth <= MAXPLY - 5; iteration_depth++) {
@@ -284,7 +315,12 @@ int Iterate(int wtm, int search_type, int root_list_done) {
  *  without wasting excessive time doing this check.  As    *
  *  the target time limit gets shorter, we shorten the      *
  *  interval between time checks to avoid burning time off  *
- *  of the clock unnecessarily.                             *
+ *  of the clock unnecessarily.  We aim for one check per   *
+ *  1% of the target time, but never less often than every  *
+ *  100ms or more often than every millisecond, using the   *
+ *  last measured NPS to turn that into a node count.  When *
+ *  the timer thread is running it does this job instead,   *
+ *  so the node count is only a distant backstop.           *
  *                                                          *
  ************************************************************
  */
@@ -293,14 +329,14 @@ int Iterate(int wtm, int search_type, int root_list_done) {
           _printf("=      search iteration %2d       =\n", iteration_depth);
           _printf("==================================\n");
         }
-        if (tree->nodes_searched) {
-          nodes_between_time_checks = nodes_per_second / 10;
+        if (timer_running)
+          nodes_between_time_checks = MAX_TC_NODES;
+        else if (tree->nodes_searched) {
           if (!analyze_mode) {
-            if (time_limit > 300);
-            else if (time_limit > 50)
-              nodes_between_time_checks /= 10;
-            else
-              nodes_between_time_checks /= 100;
+            nodes_between_time_checks =
+                (uint64_t) nodes_per_second * Max(Min(time_limit / 100, 100),
+                1) / 1000;
+            nodes_between_time_checks = Max(nodes_between_time_checks, 1);
           } else
             nodes_between_time_checks = Min(nodes_per_second, 1000000);
         }
@@ -319,24 +355,48 @@ int Iterate(int wtm, int search_type, int root_list_done) {
  *  low) we stick in this loop until we have completed all  *
  *  root moves or TimeCheck() tells us it is time to stop.  *
  *                                                          *
+ *  With "multipv N" the aspiration loop is run N times per *
+ *  iteration.  Pass k searches only root_moves[k] and up,  *
+ *  since the moves above it were claimed by the k better   *
+ *  lines (status bit 8 is left set so NextRootMove() skips *
+ *  them).  Each pass has its own window, centered on the   *
+ *  score that line had last iteration.  The hash table and *
+ *  history are shared, so pass k inherits everything the   *
+ *  earlier passes learned.  When all passes are done, the  *
+ *  lines are sorted by score (along with the root moves    *
+ *  they belong to) and line 1 becomes the real PV.         *
+ *                                                          *
  ************************************************************
  */
-        failhi_delta = 16;
-        faillo_delta = 16;
-        while (1) {
-          thread[0].tree = block[0];
-          if (smp_max_threads > 1)
-            smp_split = 1;
-          tree->rep_index--;
-          value =
-              Search(tree, root_alpha, root_beta, wtm, iteration_depth, 1,
-              Check(wtm), 0);
-          tree->rep_index++;
-          end_time = ReadClock();
-          if (abort_search)
-            break;
-          old_root_alpha = root_alpha;
-          old_root_beta = root_beta;
+        for (multipv_index = 0; multipv_index < Min(multi_pv, n_root_moves);
+            multipv_index++) {
+          if (multipv_index) {
+            for (i = multipv_index; i < n_root_moves; i++)
+              root_moves[i].status &= 4;
+            if (multipv_index < multipv_lines) {
+              root_alpha = Max(-MATE, multipv_pv[multipv_index].pathv - 16);
+              root_beta = Min(MATE, multipv_pv[multipv_index].pathv + 16);
+            } else {
+              root_alpha = -MATE;
+              root_beta = MATE;
+            }
+          }
+          failhi_delta = 16;
+          faillo_delta = 16;
+          while (1) {
+            thread[0].tree = block[0];
+            if (smp_max_threads > 1)
+              smp_split = 1;
+            tree->rep_index--;
+            value =
+                Search(tree, root_alpha, root_beta, wtm, iteration_depth, 1,
+                Check(wtm), 0);
+            tree->rep_index++;
+            end_time = ReadClock();
+            if (abort_search)
+              break;
+            old_root_alpha = root_alpha;
+            old_root_beta = root_beta;
 /*
  ************************************************************
  *                                                          *
@@ -365,41 +425,42 @@ int Iterate(int wtm, int search_type, int root_list_done) {
  *                                                          *
  ************************************************************
  */
-          if (value >= root_beta) {
-            root_beta = Min(old_root_beta + failhi_delta, MATE);
-            failhi_delta *= 2;
-            if (failhi_delta > 10 * PAWN_VALUE)
-              failhi_delta = 99999;
-            root_moves[0].status &= 0xf7;
-            if ((root_moves[0].status & 2) == 0)
-              difficulty = ComputeDifficulty(difficulty, +1);
-            root_moves[0].status |= 2;
-            if (end_time - start_time >= noise_level) {
-              fh_indicator = (wtm) ? "++" : "--";
-              Print(2, "         %2i   %s     %2s   ", iteration_depth,
-                  Display2Times(end_time - start_time), fh_indicator);
-              if (display_options & 64)
-                Print(2, "%d. ", move_number);
-              if ((display_options & 64) && !wtm)
-                Print(2, "... ");
-              Print(2, "%s! ", OutputMove(tree, tree->pv[1].path[1], 1, wtm));
-              Print(2, "(%c%s)                  \n", (wtm) ? '>' : '<',
-                  DisplayEvaluationKibitz(old_root_beta, wtm));
-              kibitz_text[0] = 0;
-              if (display_options & 64)
-                sprintf(kibitz_text, " %d.", move_number);
-              if ((display_options & 64) && !wtm)
-                sprintf(kibitz_text + strlen(kibitz_text), " ...");
-              sprintf(kibitz_text + strlen(kibitz_text), " %s!",
-                  OutputMove(tree, tree->pv[1].path[1], 1, wtm));
-              idle_percent =
-                  100 - Min(100,
-                  100 * idle_time / (smp_max_threads * (end_time -
-                          start_time) + 1));
-              Kibitz(6, wtm, iteration_depth, end_time - start_time, value,
-                  tree->nodes_searched, idle_percent,
-                  tree->egtb_probes_successful, kibitz_text);
-            }
+            if (value >= root_beta) {
+              root_beta = Min(old_root_beta + failhi_delta, MATE);
+              failhi_delta *= 2;
+              if (failhi_delta > 10 * PAWN_VALUE)
+                failhi_delta = 99999;
+              root_moves[multipv_index].status &= 0xf7;
+              if (!multipv_index && (root_moves[0].status & 2) == 0)
+                difficulty = ComputeDifficulty(difficulty, +1);
+              root_moves[multipv_index].status |= 2;
+              if (end_time - start_time >= noise_level) {
+                fh_indicator = (wtm) ? "++" : "--";
+                Print(2, "         %2i   %s     %2s   ", iteration_depth,
+                    Display2Times(end_time - start_time), fh_indicator);
+                if (display_options & 64)
+                  Print(2, "%d. ", move_number);
+                if ((display_options & 64) && !wtm)
+                  Print(2, "... ");
+                Print(2, "%s! ", OutputMove(tree, tree->pv[1].path[1], 1,
+                        wtm));
+                Print(2, "(%c%s)                  \n", (wtm) ? '>' : '<',
+                    DisplayEvaluationKibitz(old_root_beta, wtm));
+                kibitz_text[0] = 0;
+                if (display_options & 64)
+                  sprintf(kibitz_text, " %d.", move_number);
+                if ((display_options & 64) && !wtm)
+                  sprintf(kibitz_text + strlen(kibitz_text), " ...");
+                sprintf(kibitz_text + strlen(kibitz_text), " %s!",
+                    OutputMove(tree, tree->pv[1].path[1], 1, wtm));
+                idle_percent =
+                    100 - Min(100,
+                    100 * idle_time / (smp_max_threads * (end_time -
+                            start_time) + 1));
+                Kibitz(6, wtm, iteration_depth, end_time - start_time, value,
+                    tree->nodes_searched, idle_percent,
+                    tree->egtb_probes_successful, kibitz_text);
+              }
 /*
  ************************************************************
  *                                                          *
@@ -428,54 +489,81 @@ int Iterate(int wtm, int search_type, int root_list_done) {
  *                                                          *
  ************************************************************
  */
-          } else if (value <= root_alpha) {
-            root_alpha = Max(old_root_alpha - faillo_delta, -MATE);
-            faillo_delta *= 2;
-            if (faillo_delta > 10 * PAWN_VALUE)
-              faillo_delta = 99999;
-            root_moves[0].status &= 0xf7;
-            if ((root_moves[0].status & 1) == 0)
-              difficulty = ComputeDifficulty(Max(100, difficulty), -1);
-            root_moves[0].status |= 1;
-            if (ReadClock() - start_time >= noise_level && !abort_search) {
-              fl_indicator = (wtm) ? "--" : "++";
-              Print(4, "         %2i   %s     %2s   ", iteration_depth,
-                  Display2Times(ReadClock() - start_time), fl_indicator);
-              if (display_options & 64)
-                Print(4, "%d. ", move_number);
-              if ((display_options & 64) && !wtm)
-                Print(4, "... ");
-              Print(4, "%s? ", OutputMove(tree, root_moves[0].move, 1, wtm));
-              Print(4, "(%c%s)                  \n", (Flip(wtm)) ? '>' : '<',
-                  DisplayEvaluationKibitz(old_root_alpha, wtm));
-            }
-          } else
+            } else if (value <= root_alpha) {
+              root_alpha = Max(old_root_alpha - faillo_delta, -MATE);
+              faillo_delta *= 2;
+              if (faillo_delta > 10 * PAWN_VALUE)
+                faillo_delta = 99999;
+              root_moves[multipv_index].status &= 0xf7;
+              if (!multipv_index && (root_moves[0].status & 1) == 0)
+                difficulty = ComputeDifficulty(Max(100, difficulty), -1);
+              root_moves[multipv_index].status |= 1;
+              if (ReadClock() - start_time >= noise_level && !abort_search) {
+                fl_indicator = (wtm) ? "--" : "++";
+                Print(4, "         %2i   %s     %2s   ", iteration_depth,
+                    Display2Times(ReadClock() - start_time), fl_indicator);
+                if (display_options & 64)
+                  Print(4, "%d. ", move_number);
+                if ((display_options & 64) && !wtm)
+                  Print(4, "... ");
+                Print(4, "%s? ", OutputMove(tree,
+                        root_moves[multipv_index].move, 1, wtm));
+                Print(4, "(%c%s)                  \n",
+                    (Flip(wtm)) ? '>' : '<',
+                    DisplayEvaluationKibitz(old_root_alpha, wtm));
+              }
+            } else
+              break;
+          }
+          if (!multipv_index && value > root_alpha && value < root_beta)
+            last_root_value = value;
+          if (abort_search)
             break;
+          multipv_pv[multipv_index] = tree->pv[0];
         }
-        if (value > root_alpha && value < root_beta)
-          last_root_value = value;
+        multipv_lines = multipv_index;
+        for (i = 1; i < multipv_lines; i++)
+          for (j = i; j > 0 && multipv_pv[j].pathv > multipv_pv[j - 1].pathv;
+              j--) {
+            temp_pv = multipv_pv[j];
+            multipv_pv[j] = multipv_pv[j - 1];
+            multipv_pv[j - 1] = temp_pv;
+            temp_rm = root_moves[j];
+            root_moves[j] = root_moves[j - 1];
+            root_moves[j - 1] = temp_rm;
+          }
+        if (multi_pv > 1 && multipv_lines) {
+          tree->pv[0] = multipv_pv[0];
+          value = tree->pv[0].pathv;
+        }
+        multipv_index = 0;
 /*
  ************************************************************
  *                                                          *
  *  If we are running a test suite, check to see if we can  *
  *  exit the search.  This happens when N successive        *
  *  iterations produce the correct solution.  N is set by   *
- *  the test command in Option().                           *
+ *  the test command in Option().  Output() normally notes  *
+ *  when the solution became best, but a solution that was  *
+ *  never displayed (say the first move searched at depth   *
+ *  1) is credited to the end of this iteration.            *
  *                                                          *
  ************************************************************
  */
-        correct = solution_type;
-        for (i = 0; i < number_of_solutions; i++) {
-          if (!solution_type) {
-            if (solutions[i] == tree->pv[0].path[1])
-              correct = 1;
-          } else if (solutions[i] == tree->pv[0].path[1])
-            correct = 0;
-        }
+        correct = TestSolution(tree->pv[0].path[1]);
         if (correct)
           correct_count++;
         else
           correct_count = 0;
+        if (number_of_solutions) {
+          if (!correct)
+            solution_depth = 0;
+          else if (!solution_depth) {
+            solution_depth = iteration_depth;
+            solution_time = ReadClock() - start_time;
+            solution_nodes = tree->nodes_searched;
+          }
+        }
 /*
  ************************************************************
  *                                                          *
@@ -528,14 +616,18 @@ int Iterate(int wtm, int search_type, int root_list_done) {
  *                                                          *
  ************************************************************
  */
-        if (end_time - start_time > 10)
+        if (end_time - start_time > 100)
           nodes_per_second =
-              tree->nodes_searched * 100 / (uint64_t) (end_time - start_time);
+              tree->nodes_searched * 1000 / (uint64_t) (end_time - start_time);
         else
           nodes_per_second = 1000000;
         if (!abort_search && value != -(MATE - 1)) {
           if (end_time - start_time > noise_level) {
-            DisplayPV(tree, 5, wtm, end_time - start_time, &tree->pv[0], 0);
+            for (multipv_index = 0; multipv_index < multipv_lines;
+                multipv_index++)
+              DisplayPV(tree, 5, wtm, end_time - start_time,
+                  &multipv_pv[multipv_index], 0);
+            multipv_index = 0;
             noise_block = 0;
           } else
             noise_block = 1;
@@ -601,10 +693,11 @@ int Iterate(int wtm, int search_type, int root_list_done) {
  *                                                          *
  ************************************************************
  */
+      TimerStop();
       end_time = ReadClock();
       if (end_time > 10)
         nodes_per_second =
-            (uint64_t) tree->nodes_searched * 100 / Max((uint64_t) end_time -
+            (uint64_t) tree->nodes_searched * 1000 / Max((uint64_t) end_time -
             start_time, 1);
       if (abort_search != 2 && !puzzling) {
         if (noise_block)
@@ -623,10 +716,18 @@ int Iterate(int wtm, int search_type, int root_list_done) {
         Print(8, "  fh1=%d%%",
             tree->fail_high_first_move * 100 / tree->fail_highs);
         Print(8, "  50move=%d", Reversible(0));
+        if (time_abort_deadline)
+          Print(8, "  overshoot=%dms",
+              (int) (end_time - start_time) - time_abort_deadline);
         Print(8, "  nps=%s\n", DisplayKMB(nodes_per_second, 0));
         Print(16, "        ext=%s", DisplayKMB(tree->extensions_done, 0));
         Print(16, "  pruned=%s", DisplayKMB(tree->moves_fpruned, 0));
         Print(16, "  qchks=%s", DisplayKMB(tree->qchecks_done, 0));
+        Print(16, "  amaps=%s", DisplayKMB(tree->attack_map_hits +
+                tree->attack_map_fills, 0));
+        Print(16, "(%d%% reused)",
+            (int) (tree->attack_map_hits * 100 / Max(tree->attack_map_hits +
+                    tree->attack_map_fills, 1)));
         Print(16, "  predicted=%d\n", predicted);
         Print(16, "        LMReductions: ");
         for (i = 1; i < 16; i++)
@@ -643,6 +744,10 @@ int Iterate(int wtm, int search_type, int root_list_done) {
         Print(16, "  data=%d%%", 100 * max_split_blocks / Max(MAX_BLOCKS, 1));
         Print(16, "  probes=%s", DisplayKMB(tree->egtb_probes, 0));
         Print(16, "  hits=%s\n", DisplayKMB(tree->egtb_probes_successful, 0));
+        if (smp_max_threads > 1)
+          ThreadStats(0);
+        if (smp_autotune)
+          AutoTuneOnline(end_time - start_time);
       }
     } while (0);
 /*
@@ -0,0 +1,457 @@
+#include "chess.h"
+#include "data.h"
+#if defined(UNIX)
+#  include <fcntl.h>
+#  include <unistd.h>
+#  include <sys/mman.h>
+#endif
+/* last modified 10/18/26 */
+/*
+ *******************************************************************************
+ *                                                                             *
+ *   JournalOpen() starts the binary search journal ("journal on").  Each      *
+ *   search thread gets its own file, <prefix>.<thread>, holding a 64 byte     *
+ *   header followed by a ring buffer of "events" 16 byte events (rounded up   *
+ *   to a power of two).  The file is mapped into memory, so recording an      *
+ *   event is a handful of stores with no system call and no lock, and what    *
+ *   has been recorded survives even if the program dies.  When the buffer is  *
+ *   full the oldest events are overwritten, so the file always holds the most *
+ *   recent part of the search.  Threads that did not exist when the journal   *
+ *   was started (a later "mt" increase) are not recorded.                     *
+ *                                                                             *
+ *   Returns the number of threads being recorded.                             *
+ *                                                                             *
+ *******************************************************************************
+ */
+int JournalOpen(char *prefix, uint64_t events) {
+#if defined(UNIX)
+  JOURNAL_HEADER *buffer;
+  char name[FILENAME_MAX];
+  uint64_t capacity = 1024;
+  size_t size;
+  int tid, fd, nthreads = Max(smp_max_threads, 1);
+
+  JournalClose();
+  while (capacity < events)
+    capacity *= 2;
+  size = sizeof(JOURNAL_HEADER) + capacity * sizeof(JOURNAL_EVENT);
+  for (tid = 0; tid < nthreads && tid < CPUS; tid++) {
+    sprintf(name, "%s.%d", prefix, tid);
+    fd = open(name, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0 || ftruncate(fd, size)) {
+      Print(4095, "ERROR, unable to create %s\n", name);
+      if (fd >= 0)
+        close(fd);
+      break;
+    }
+    buffer =
+        (JOURNAL_HEADER *) mmap(0, size, PROT_READ | PROT_WRITE, MAP_SHARED,
+        fd, 0);
+    close(fd);
+    if (buffer == MAP_FAILED) {
+      Print(4095, "ERROR, unable to map %s\n", name);
+      break;
+    }
+    memcpy(buffer->magic, "CRAFTYJL", 8);
+    buffer->version = JOURNAL_VERSION;
+    buffer->event_size = sizeof(JOURNAL_EVENT);
+    buffer->thread = tid;
+    buffer->capacity = capacity;
+    buffer->head = 0;
+    buffer->nodes = 0;
+    buffer->last_nodes = 0;
+    buffer->last_tree = 0;
+    journal_buffer[tid] = buffer;
+  }
+  if (tid < nthreads && tid < CPUS) {
+    JournalClose();
+    return 0;
+  }
+  return tid;
+#else
+  Print(4095, "the search journal is not supported on this system\n");
+  return 0;
+#endif
+}
+
+/* last modified 10/18/26 */
+/*
+ *******************************************************************************
+ *                                                                             *
+ *   JournalClose() stops the journal and unmaps the files, which are left     *
+ *   behind for JournalDecode().                                               *
+ *                                                                             *
+ *******************************************************************************
+ */
+void JournalClose(void) {
+#if defined(UNIX)
+  JOURNAL_HEADER *buffer;
+  int tid;
+
+  for (tid = 0; tid < CPUS; tid++)
+    if ((buffer = journal_buffer[tid])) {
+      journal_buffer[tid] = 0;
+      munmap(buffer, sizeof(JOURNAL_HEADER) +
+          buffer->capacity * sizeof(JOURNAL_EVENT));
+    }
+#endif
+}
+
+/* last modified 10/18/26 */
+/*
+ *******************************************************************************
+ *                                                                             *
+ *   JournalEvent() appends one event to the thread's ring buffer.  It is only *
+ *   called through the Journal() macro, which skips it when the thread is not *
+ *   being recorded.  The head count is stored last, so a reader never sees a  *
+ *   count that includes an event that has not been written yet.               *
+ *                                                                             *
+ *   The node count is this thread's own.  A thread moves to a new TREE block  *
+ *   at each split point, whose counter starts at zero and is later added to   *
+ *   its parent's, so only the growth of tree->nodes_searched since the last   *
+ *   event in the same block is counted.                                       *
+ *                                                                             *
+ *******************************************************************************
+ */
+void JournalEvent(TREE * RESTRICT tree, int type, int ply, int depth, int move,
+    int phase, int alpha, int beta, int value) {
+  JOURNAL_HEADER *buffer = journal_buffer[tree->thread_id];
+  JOURNAL_EVENT *event = (JOURNAL_EVENT *) (buffer + 1) +
+      (buffer->head & (buffer->capacity - 1));
+
+  if (buffer->last_tree != (uintptr_t) tree ||
+      tree->nodes_searched < buffer->last_nodes) {
+    buffer->last_tree = (uintptr_t) tree;
+    buffer->last_nodes = tree->nodes_searched;
+  }
+  buffer->nodes += tree->nodes_searched - buffer->last_nodes;
+  buffer->last_nodes = tree->nodes_searched;
+  event->move = (move & 0x1fffff) | (phase & 15) << 21 | type << 25;
+  event->nodes = (uint32_t) buffer->nodes;
+  event->alpha = Max(Min(alpha, 32767), -32767);
+  event->beta = Max(Min(beta, 32767), -32767);
+  event->value = Max(Min(value, 32767), -32767);
+  event->ply = ply;
+  event->depth = Min(depth, 255);
+  buffer->head++;
+}
+
+/* last modified 10/19/26 */
+/*
+ *******************************************************************************
+ *                                                                             *
+ *   JournalDecode() is the offline half of the journal ("journal decode").    *
+ *   It reads one thread's file and rebuilds the search tree from the events:  *
+ *   a JOURNAL_SEARCH event at ply p opens a node and closes any open node at  *
+ *   ply >= p, and the JOURNAL_MOVE/JOURNAL_NULL event at ply p-1 that follows *
+ *   supplies the value of the node it closes.  If the ring buffer wrapped,    *
+ *   the oldest nodes in the file have no recorded parent and are treated as   *
+ *   roots, and a helper thread's file starts a new root at each split point   *
+ *   it joins.  Subtree sizes count only the nodes searched by this thread.    *
+ *   Since positions are not recorded, moves are shown in coordinate form with *
+ *   the moving piece (Ng1f3, e7e8Q).  The output is:                          *
+ *                                                                             *
+ *   (1) a per-ply summary:  nodes, hash and null-move cutoffs, moves          *
+ *       searched, fail highs and how often the first move failed high.        *
+ *                                                                             *
+ *   (2) the hot path:  from the largest root, repeatedly the child with the   *
+ *       largest subtree, with its share of its parent's nodes.                *
+ *                                                                             *
+ *   (3) hot spots:  the "top" largest subtrees with at most "depth" plies of  *
+ *       remaining depth, where the tree is expected to be small.  These are   *
+ *       where extensions or the quiescence search blew up.                    *
+ *                                                                             *
+ *   (4) with plies > 0, the tree itself down to that many plies below the     *
+ *       shallowest node, one line per node:  move, depth, window, value (the  *
+ *       node's own point of view), subtree nodes and node type (pv, cut, all, *
+ *       hash, null for a null-move cutoff, or open if the journal ends before *
+ *       the node searched any move).                                          *
+ *                                                                             *
+ *******************************************************************************
+ */
+void JournalDecode(char *name, int plies, int top, int depth) {
+  JOURNAL_HEADER header;
+  JOURNAL_EVENT *events = 0, *event;
+  FILE *input;
+  char window[32];
+  int32_t *parent = 0, *stack, *hot;
+  uint32_t *nodes = 0;
+  int32_t *value = 0;
+  uint8_t *node_type = 0, *moves = 0;
+  int type, ply, i, j, n, child, count, root = -1, base = MAXPLY;
+  uint64_t first, per_ply[MAXPLY + 1][6], total_nodes = 0;
+  static const char *types[6] = { "open", "pv", "cut", "all", "hash", "null" };
+
+/*
+ ************************************************************
+ *                                                          *
+ *  Read the header and the events, oldest first.           *
+ *                                                          *
+ ************************************************************
+ */
+  if (!(input = fopen(name, "rb"))) {
+    Print(4095, "ERROR, unable to open %s\n", name);
+    return;
+  }
+  if (fread(&header, sizeof(header), 1, input) != 1 ||
+      memcmp(header.magic, "CRAFTYJL", 8) ||
+      header.version != JOURNAL_VERSION ||
+      header.event_size != sizeof(JOURNAL_EVENT) || !header.capacity ||
+      (header.capacity & (header.capacity - 1))) {
+    Print(4095, "ERROR, %s is not a search journal\n", name);
+    fclose(input);
+    return;
+  }
+  count = (int) Min(header.head, header.capacity);
+  first = header.head - count;
+  events = (JOURNAL_EVENT *) malloc((size_t) Max(count, 1) *
+      sizeof(JOURNAL_EVENT));
+  j = (int) (first & (header.capacity - 1));
+  n = (int) Min(count, header.capacity - j);
+  i = 0;
+  if (!fseek(input, sizeof(header) + (long) j * sizeof(JOURNAL_EVENT),
+          SEEK_SET))
+    i = fread(events, sizeof(JOURNAL_EVENT), n, input);
+  if (i == n && count > n && !fseek(input, sizeof(header), SEEK_SET))
+    i += fread(events + n, sizeof(JOURNAL_EVENT), count - n, input);
+  fclose(input);
+  count = i;
+  parent = (int32_t *) malloc((size_t) Max(count, 1) * sizeof(int32_t));
+  nodes = (uint32_t *) malloc((size_t) Max(count, 1) * sizeof(uint32_t));
+  value = (int32_t *) malloc((size_t) Max(count, 1) * sizeof(int32_t));
+  node_type = (uint8_t *) malloc((size_t) Max(count, 1));
+  moves = (uint8_t *) malloc((size_t) Max(count, 1));
+  stack = (int32_t *) malloc((MAXPLY + 2) * sizeof(int32_t));
+  hot = (int32_t *) malloc((size_t) Max(top, 1) * sizeof(int32_t));
+/*
+ ************************************************************
+ *                                                          *
+ *  Pass one rebuilds the tree.  stack[p] is the open node  *
+ *  at ply p (or -1), closing a node fixes its subtree size *
+ *  from the node counter in the event that closes it.      *
+ *  node_type[] is 0 until the node is resolved (a node     *
+ *  whose moves never raised alpha is an all node), and     *
+ *  moves[] counts the moves searched at the node, to find  *
+ *  first-move fail highs.  A node is normally resolved as  *
+ *  "all" by the parent's move that closes it, but a root   *
+ *  has no such move, so afterward any node that searched   *
+ *  moves without raising alpha becomes "all" too.  Only a  *
+ *  node cut off by the end of the journal stays "open".    *
+ *                                                          *
+ ************************************************************
+ */
+  memset(per_ply, 0, sizeof(per_ply));
+  for (i = 0; i <= MAXPLY + 1; i++)
+    stack[i] = -1;
+  for (i = 0; i < count; i++) {
+    event = events + i;
+    type = event->move >> 25;
+    ply = Min(event->ply, MAXPLY);
+    parent[i] = -1;
+    nodes[i] = 0;
+    value[i] = -MATE - 1;
+    node_type[i] = 0;
+    moves[i] = 0;
+    child = (type == JOURNAL_SEARCH) ? -1 : stack[ply + 1];
+    for (j = (type == JOURNAL_SEARCH) ? ply : ply + 1; j <= MAXPLY; j++)
+      if (stack[j] >= 0) {
+        nodes[stack[j]] = event->nodes - events[stack[j]].nodes;
+        stack[j] = -1;
+      }
+    switch (type) {
+      case JOURNAL_SEARCH:
+        if (ply > 0)
+          parent[i] = stack[ply - 1];
+        stack[ply] = i;
+        base = Min(base, ply);
+        per_ply[ply][0]++;
+        break;
+      case JOURNAL_HASH:
+        per_ply[ply][1]++;
+        if ((j = stack[ply]) >= 0) {
+          value[j] = event->value;
+          node_type[j] = 4;
+          nodes[j] = event->nodes - events[j].nodes;
+          stack[ply] = -1;
+        }
+        break;
+      case JOURNAL_NULL:
+      case JOURNAL_MOVE:
+        if (type == JOURNAL_NULL && event->value >= event->beta)
+          per_ply[ply][2]++;
+        if (type == JOURNAL_MOVE) {
+          per_ply[ply][3]++;
+          if (event->value >= event->beta)
+            per_ply[ply][4]++;
+        }
+        if (child >= 0) {
+          value[child] = -event->value;
+          if (!node_type[child])
+            node_type[child] = 3;
+        }
+        if ((j = stack[ply]) < 0)
+          break;
+        if (event->value >= event->beta) {
+          node_type[j] = (type == JOURNAL_NULL) ? 5 : 2;
+          if (type == JOURNAL_MOVE && !moves[j])
+            per_ply[ply][5]++;
+        } else if (event->value > event->alpha && node_type[j] != 2)
+          node_type[j] = 1;
+        if (type == JOURNAL_MOVE && moves[j] < 255)
+          moves[j]++;
+        break;
+    }
+  }
+  if (count)
+    for (j = 0; j <= MAXPLY; j++)
+      if (stack[j] >= 0)
+        nodes[stack[j]] = events[count - 1].nodes - events[stack[j]].nodes;
+  for (i = 0; i < count; i++)
+    if (!node_type[i] && moves[i])
+      node_type[i] = 3;
+/*
+ ************************************************************
+ *                                                          *
+ *  Nodes without a parent are the roots, display the       *
+ *  per-ply summary.                                        *
+ *                                                          *
+ ************************************************************
+ */
+  for (i = 0; i < count; i++)
+    if (events[i].move >> 25 == JOURNAL_SEARCH && parent[i] < 0 &&
+        (root < 0 || nodes[i] > nodes[root]))
+      root = i;
+  for (i = 0; i < count; i++)
+    if (events[i].move >> 25 == JOURNAL_SEARCH && parent[i] < 0)
+      total_nodes += nodes[i];
+  Print(4095, "\n%s:  thread %u, %" PRIu64 " events recorded, %d decoded%s\n",
+      name, header.thread, header.head, count,
+      (header.head > header.capacity) ? " (wrapped)" : "");
+  Print(4095, "\n  ply      nodes  hash cuts  null cuts      moves  fail highs"
+      "   fh1%%\n");
+  for (ply = base; ply <= MAXPLY; ply++)
+    if (per_ply[ply][0] || per_ply[ply][3])
+      Print(4095, "  %3d %10" PRIu64 " %10" PRIu64 " %10" PRIu64 " %10"
+          PRIu64 "  %10" PRIu64 "  %5.1f\n", ply, per_ply[ply][0],
+          per_ply[ply][1], per_ply[ply][2], per_ply[ply][3], per_ply[ply][4],
+          100.0 * per_ply[ply][5] / Max(per_ply[ply][4], 1));
+/*
+ ************************************************************
+ *                                                          *
+ *  The hot path, following the largest child down from     *
+ *  the largest root.                                       *
+ *                                                          *
+ ************************************************************
+ */
+  if (root >= 0) {
+    Print(4095, "\n  hot path (%s nodes):\n", DisplayKMB(total_nodes, 0));
+    for (i = root; i >= 0;) {
+      Print(4095, "  %*s%-7s d=%-3d nodes=%-8s %5.1f%%  %s\n",
+          2 * (events[i].ply - base), "", JournalMove(events + i),
+          events[i].depth, DisplayKMB(nodes[i], 0),
+          100.0 * nodes[i] / Max((parent[i] >= 0) ? nodes[parent[i]] :
+              total_nodes, 1), types[node_type[i]]);
+      for (n = -1, j = i + 1; j < count; j++) {
+        if (events[j].ply < events[i].ply || (events[j].ply == events[i].ply
+                && events[j].move >> 25 == JOURNAL_SEARCH))
+          break;
+        if (parent[j] == i && events[j].move >> 25 == JOURNAL_SEARCH &&
+            (n < 0 || nodes[j] > nodes[n]))
+          n = j;
+      }
+      i = n;
+    }
+  }
+/*
+ ************************************************************
+ *                                                          *
+ *  Hot spots, the largest subtrees with little remaining   *
+ *  depth, each with the path that leads to it.             *
+ *                                                          *
+ ************************************************************
+ */
+  for (n = 0; n < top; n++) {
+    hot[n] = -1;
+    for (i = 0; i < count; i++)
+      if (events[i].move >> 25 == JOURNAL_SEARCH && events[i].depth <= depth
+          && (hot[n] < 0 || nodes[i] > nodes[hot[n]])) {
+        for (j = 0; j < n && hot[j] != i; j++);
+        if (j == n)
+          hot[n] = i;
+      }
+    if (hot[n] < 0)
+      break;
+    if (!n)
+      Print(4095, "\n  hot spots (depth <= %d):\n", depth);
+    i = hot[n];
+    sprintf(window, "[%d,%d]", events[i].alpha, events[i].beta);
+    Print(4095, "  %8s  d=%-3d %-13s %-4s ", DisplayKMB(nodes[i], 0),
+        events[i].depth, window, types[node_type[i]]);
+    for (j = 0; i >= 0 && j <= MAXPLY; j++, i = parent[i])
+      stack[j] = i;
+    while (--j >= 0)
+      Print(4095, " %s", JournalMove(events + stack[j]));
+    Print(4095, "\n");
+  }
+/*
+ ************************************************************
+ *                                                          *
+ *  Pass two prints the tree in order, to "plies" plies.    *
+ *                                                          *
+ ************************************************************
+ */
+  if (plies > 0)
+    Print(4095, "\n  tree:\n");
+  for (i = 0; plies > 0 && i < count; i++)
+    if (events[i].move >> 25 == JOURNAL_SEARCH &&
+        events[i].ply < base + plies) {
+      Print(4095, "  %*s%-7s d=%-3d [%d,%d] ", 2 * (events[i].ply - base), "",
+          JournalMove(events + i), events[i].depth, events[i].alpha,
+          events[i].beta);
+      if (value[i] < -MATE)
+        Print(4095, "v=?");
+      else
+        Print(4095, "v=%d", value[i]);
+      Print(4095, " nodes=%s %s\n", DisplayKMB(nodes[i], 0),
+          types[node_type[i]]);
+    }
+  free(events);
+  free(parent);
+  free(nodes);
+  free(value);
+  free(node_type);
+  free(moves);
+  free(stack);
+  free(hot);
+}
+
+/* last modified 10/18/26 */
+/*
+ *******************************************************************************
+ *                                                                             *
+ *   JournalMove() converts the move in a recorded event to text without       *
+ *   needing the position:  the piece (omitted for pawns), the from and to     *
+ *   squares and any promotion piece, "null" for a null move, or "root" for    *
+ *   the node that Iterate() searches at ply 1.  The result is in a static     *
+ *   buffer that is overwritten by the next call.                              *
+ *                                                                             *
+ *******************************************************************************
+ */
+char *JournalMove(JOURNAL_EVENT * event) {
+  static char text[16];
+  char *p = text;
+  int move = event->move & 0x1fffff;
+
+  if (event->ply <= 1 && (event->move >> 25) == JOURNAL_SEARCH)
+    return "root";
+  if (!move)
+    return "null";
+  if (Piece(move) != pawn)
+    *p++ = translate[6 + Piece(move)];
+  p += sprintf(p, "%c%c%c%c", 'a' + File(From(move)), '1' + Rank(From(move)),
+      'a' + File(To(move)), '1' + Rank(To(move)));
+  if (Promote(move))
+    *p++ = translate[6 + Promote(move)];
+  *p = 0;
+  return text;
+}
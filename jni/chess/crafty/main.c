@@ -55,6 +55,7 @@ int chess_main(int argc, char **argv) {
 
 	Print(128, "\nCrafty v%s (%d cpus)\n\n", version, Max(smp_max_threads, 1));
 	NewGame(1);
+	ReadRC(tree);
 
 	while(1) {
     presult = 0;
@@ -235,7 +236,7 @@ int chess_main(int argc, char **argv) {
          if (move_number < 40 || !accept_draws)
            drawsc = -300;
          if (value <= drawsc && (tc_increment != 0 ||
-                 tc_time_remaining[Flip(game_wtm)] >= 1000)) {
+                 tc_time_remaining[Flip(game_wtm)] >= 10000)) {
            Print(128, "Draw accepted.\n");
            Print(4095, "1/2-1/2 {Draw agreed}\n");
            strcpy(pgn_result, "1/2-1/2");
@@ -369,7 +370,7 @@ int chess_main(int argc, char **argv) {
            if (xboard)
              Print(4095, "1/2-1/2 {Insufficient material}\n");
          }
-         if (time_limit > 300)
+         if (time_limit > 3000)
            if (log_file)
              DisplayChessBoardFile(log_file, tree->position);
    /*
@@ -4535,6 +4536,14 @@ int main(int argc, char **argv) {
 
   Print(128, "\nCrafty v%s (%d cpus)\n\n", version, Max(smp_max_threads, 1));
   NewGame(1);
+/*
+ ************************************************************
+ *                                                          *
+ *  Execute the commands in the rc file, if there is one.   *
+ *                                                          *
+ ************************************************************
+ */
+  ReadRC(tree);
 
 /*
  ************************************************************
@@ -4792,7 +4801,7 @@ int main(int argc, char **argv) {
       if (move_number < 40 || !accept_draws)
         drawsc = -300;
       if (value <= drawsc && (tc_increment != 0 ||
-              tc_time_remaining[Flip(game_wtm)] >= 1000)) {
+              tc_time_remaining[Flip(game_wtm)] >= 10000)) {
         if (xboard)
           Print(4095, "offer draw\n");
         else {
@@ -4963,7 +4972,7 @@ int main(int argc, char **argv) {
           Print(4095, "1/2-1/2 {Insufficient material}\n");
       }
 #if !defined(TEST)
-      if (time_limit > 300)
+      if (time_limit > 3000)
 #endif
         if (log_file)
           DisplayChessBoardFile(log_file, tree->position);
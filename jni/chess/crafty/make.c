@@ -1,15 +1,15 @@
 #include "chess.h"
 #include "data.h"
-/* last modified 02/22/14 */
+/* last modified 10/18/26 */
 /*
  *******************************************************************************
  *                                                                             *
  *   MakeMove() is responsible for updating the position database whenever a   *
  *   piece is moved.  It performs the following operations:  (1) update the    *
  *   board structure itself by moving the piece and removing any captured      *
- *   piece.  (2) update the hash keys.  (3) update material counts.  (4) then  *
- *   update castling status.  (5) and finally update number of moves since     *
- *   last reversible move.                                                     *
+ *   piece.  (2) update the hash keys.  (3) update material counts and the     *
+ *   incremental piece/square totals.  (4) then update castling status.  (5)   *
+ *   and finally update number of moves since last reversible move.            *
  *                                                                             *
  *   There are some special-cases handled here, such as en passant captures    *
  *   where the enemy pawn is not on the <target> square, castling which moves  *
@@ -21,7 +21,8 @@
  *                                                                             *
  *******************************************************************************
  */
-void MakeMove(TREE * RESTRICT tree, int ply, int move, int side) {
+COLORED void MakeMoveColor(TREE * RESTRICT tree, int ply, int move,
+    const int side) {
   uint64_t bit_move;
   int piece, from, to, captured, promote, enemy = Flip(side);
   int cpiece;
@@ -56,6 +57,7 @@ void MakeMove(TREE * RESTRICT tree, int ply, int move, int side) {
   tree->status[ply + 1] = tree->status[ply];
   tree->save_hash_key[ply] = HashKey;
   tree->save_pawn_hash_key[ply] = PawnHashKey;
+  RepFilter(HashKey)++;
   if (EnPassant(ply + 1)) {
     HashEP(EnPassant(ply + 1));
     EnPassant(ply + 1) = 0;
@@ -82,6 +84,8 @@ void MakeMove(TREE * RESTRICT tree, int ply, int move, int side) {
   Hash(side, piece, to);
   PcOnSq(from) = 0;
   PcOnSq(to) = pieces[side][piece];
+  PcSqSub(side, piece, from);
+  PcSqAdd(side, piece, to);
 /*
  ************************************************************
  *                                                          *
@@ -101,6 +105,7 @@ void MakeMove(TREE * RESTRICT tree, int ply, int move, int side) {
         Hash(enemy, pawn, to + epsq[side]);
         HashP(enemy, to + epsq[side]);
         PcOnSq(to + epsq[side]) = 0;
+        PcSqSub(enemy, pawn, to + epsq[side]);
         Material -= PieceValues(enemy, pawn);
         TotalPieces(enemy, pawn)--;
         TotalAllPieces--;
@@ -114,6 +119,8 @@ void MakeMove(TREE * RESTRICT tree, int ply, int move, int side) {
         HashP(side, to);
         Hash(side, promote, to);
         PcOnSq(to) = pieces[side][promote];
+        PcSqSub(side, pawn, to);
+        PcSqAdd(side, promote, to);
         TotalPieces(side, occupied) += p_vals[promote];
         TotalPieces(side, promote)++;
         Material += PieceValues(side, promote);
@@ -197,6 +204,7 @@ void MakeMove(TREE * RESTRICT tree, int ply, int move, int side) {
     Clear(to, Pieces(enemy, captured));
     Clear(to, Occupied(enemy));
     Material -= PieceValues(enemy, captured);
+    PcSqSub(enemy, captured, to);
     TotalPieces(enemy, captured)--;
     if (captured != pawn)
       TotalPieces(enemy, occupied) -= p_vals[captured];
@@ -238,12 +246,41 @@ void MakeMove(TREE * RESTRICT tree, int ply, int move, int side) {
         break;
     }
   }
+/*
+ ************************************************************
+ *                                                          *
+ *  If the neural network evaluation is in use, update its  *
+ *  accumulators for the pieces that moved.                 *
+ *                                                          *
+ ************************************************************
+ */
+#if defined(NNUE)
+  if (nnue_enabled)
+    NnueMakeMove(tree, ply, move, side);
+#endif
 #if defined(DEBUG)
   ValidatePosition(tree, ply + 1, move, "MakeMove(2)");
 #endif
   return;
 }
 
+/* last modified 10/18/26 */
+/*
+ *******************************************************************************
+ *                                                                             *
+ *   MakeMove() picks the copy of MakeMoveColor() for the side on move.  The   *
+ *   body above is compiled once per side so that <side> and <enemy> are       *
+ *   constants inside each copy.                                               *
+ *                                                                             *
+ *******************************************************************************
+ */
+void MakeMove(TREE * RESTRICT tree, int ply, int move, int side) {
+  if (side)
+    MakeMoveColor(tree, ply, move, white);
+  else
+    MakeMoveColor(tree, ply, move, black);
+}
+
 /* last modified 05/08/14 */
 /*
  *******************************************************************************
@@ -13,7 +13,8 @@
  *                                                                             *
  *******************************************************************************
  */
-int *GenerateCaptures(TREE * RESTRICT tree, int ply, int side, int *move) {
+COLORED int *GenerateCapturesColor(TREE * RESTRICT tree, int ply,
+    const int side, int *move) {
   uint64_t target, piecebd, moves;
   uint64_t promotions, pcapturesl, pcapturesr;
   int from, to, temp, common, enemy = Flip(side);
@@ -142,6 +143,22 @@ int *GenerateCaptures(TREE * RESTRICT tree, int ply, int side, int *move) {
   return move;
 }
 
+/* last modified 10/18/26 */
+/*
+ *******************************************************************************
+ *                                                                             *
+ *   GenerateCaptures() dispatches to one of two copies of the generator       *
+ *   above, one per side, so the pawn shifts, edge masks and Advanced() scan   *
+ *   direction are fixed when each copy is compiled.                           *
+ *                                                                             *
+ *******************************************************************************
+ */
+int *GenerateCaptures(TREE * RESTRICT tree, int ply, int side, int *move) {
+  if (side)
+    return GenerateCapturesColor(tree, ply, white, move);
+  return GenerateCapturesColor(tree, ply, black, move);
+}
+
 /* modified 02/22/14 */
 /*
  *******************************************************************************
@@ -449,12 +466,13 @@ int *GenerateChecks(TREE * RESTRICT tree, int side, int *move) {
   return move;
 }
 
-/* modified 02/22/14 */
+/* modified 10/19/26 */
 /*
  *******************************************************************************
  *                                                                             *
  *   GenerateCheckEvasions() is used to generate moves when the king is in     *
- *   check.                                                                    *
+ *   check.  If it is ever called when the king is not in check it generates   *
+ *   nothing, rather than indexing the board with LSB(0) = 64.                 *
  *                                                                             *
  *   Three types of check-evasion moves are generated:                         *
  *                                                                             *
@@ -492,6 +510,8 @@ int *GenerateCheckEvasions(TREE * RESTRICT tree, int ply, int side, int *move) {
  */
   king_square = KingSQ(side);
   checksqs = AttacksTo(tree, king_square) & Occupied(enemy);
+  if (!checksqs)
+    return move;
   checkers = PopCnt(checksqs);
   if (checkers == 1) {
     checking_square = LSB(checksqs);
@@ -529,10 +549,11 @@ int *GenerateCheckEvasions(TREE * RESTRICT tree, int ply, int side, int *move) {
  */
   from = king_square;
   temp = from + (king << 12);
-  for (moves = king_attacks[from] & ~Occupied(side); moves; Clear(to, moves)) {
+  moves = king_attacks[from] & ~Occupied(side) & ~AttackMap(tree, ply,
+      enemy)[0];
+  for (; moves; Clear(to, moves)) {
     to = Advanced(side, moves);
-    if (!Attacks(tree, enemy, to)
-        && directions[from][to] != check_direction1 &&
+    if (directions[from][to] != check_direction1 &&
         directions[from][to] != check_direction2)
       *move++ = temp | (to << 6) | (Abs(PcOnSq(to)) << 15);
   }
@@ -700,7 +721,7 @@ int *GenerateCheckEvasions(TREE * RESTRICT tree, int ply, int side, int *move) {
   return move;
 }
 
-/* modified 02/22/14 */
+/* modified 10/18/26 */
 /*
  *******************************************************************************
  *                                                                             *
@@ -723,7 +744,8 @@ int *GenerateCheckEvasions(TREE * RESTRICT tree, int ply, int side, int *move) {
  *                                                                             *
  *******************************************************************************
  */
-int *GenerateNoncaptures(TREE * RESTRICT tree, int ply, int side, int *move) {
+COLORED int *GenerateNoncapturesColor(TREE * RESTRICT tree, int ply,
+    const int side, int *move) {
   uint64_t target, piecebd, moves;
   uint64_t padvances1, padvances2, pcapturesl, pcapturesr;
   int from, to, temp, common, enemy = Flip(side);
@@ -737,15 +759,13 @@ int *GenerateNoncaptures(TREE * RESTRICT tree, int ply, int side, int *move) {
  */
   if (Castle(ply, side) > 0) {
     if (Castle(ply, side) & 1 && !(OccupiedSquares & OO[side])
-        && !Attacks(tree, enemy, OOsqs[side][0])
-        && !Attacks(tree, enemy, OOsqs[side][1])
-        && !Attacks(tree, enemy, OOsqs[side][2])) {
+        && !(AttackMap(tree, ply, enemy)[0] & (SetMask(OOsqs[side][0]) |
+                SetMask(OOsqs[side][1]) | SetMask(OOsqs[side][2])))) {
       *move++ = (king << 12) + (OOto[side] << 6) + OOfrom[side];
     }
     if (Castle(ply, side) & 2 && !(OccupiedSquares & OOO[side])
-        && !Attacks(tree, enemy, OOOsqs[side][0])
-        && !Attacks(tree, enemy, OOOsqs[side][1])
-        && !Attacks(tree, enemy, OOOsqs[side][2])) {
+        && !(AttackMap(tree, ply, enemy)[0] & (SetMask(OOOsqs[side][0]) |
+                SetMask(OOOsqs[side][1]) | SetMask(OOOsqs[side][2])))) {
       *move++ = (king << 12) + (OOOto[side] << 6) + OOfrom[side];
     }
   }
@@ -907,6 +927,21 @@ int *GenerateNoncaptures(TREE * RESTRICT tree, int ply, int side, int *move) {
   return move;
 }
 
+/* last modified 10/18/26 */
+/*
+ *******************************************************************************
+ *                                                                             *
+ *   GenerateNoncaptures() is the same kind of side dispatch as                *
+ *   GenerateCaptures(), for the non-capture generator.                        *
+ *                                                                             *
+ *******************************************************************************
+ */
+int *GenerateNoncaptures(TREE * RESTRICT tree, int ply, int side, int *move) {
+  if (side)
+    return GenerateNoncapturesColor(tree, ply, white, move);
+  return GenerateNoncapturesColor(tree, ply, black, move);
+}
+
 /* modified 02/22/14 */
 /*
  *******************************************************************************
@@ -971,3 +1006,119 @@ int PinnedOnKing(TREE * RESTRICT tree, int side, int square) {
   }
   return 0;
 }
+
+/* last modified 10/18/26 */
+/*
+ *******************************************************************************
+ *                                                                             *
+ *   GenerateLegalMasks() computes the two bitboards LegalMove() needs to test *
+ *   a pseudo-legal move for legality without making it, and saves them in     *
+ *   tree->next_status[ply] so that this is done once per node rather than     *
+ *   once per move.                                                            *
+ *                                                                             *
+ *   pinned is the set of pieces for <side> that are pinned on their own king. *
+ *   We find these from the king's square by generating rook and bishop        *
+ *   attacks through our own pieces (only enemy pieces block), which stops on  *
+ *   the first enemy piece on each ray.  If that piece is a slider that moves  *
+ *   in that direction, and exactly one piece stands between it and the king,  *
+ *   that piece (which must be ours) is pinned.  If no piece stands between    *
+ *   them, the slider is giving check instead.                                 *
+ *                                                                             *
+ *   check_mask is the set of squares a piece other than the king may move to  *
+ *   without leaving the king in check.  All 64 squares if not in check, the   *
+ *   checking piece plus the squares between it and the king if in check by    *
+ *   one piece, and no squares at all for a double check.                      *
+ *                                                                             *
+ *******************************************************************************
+ */
+void GenerateLegalMasks(TREE * RESTRICT tree, int ply, int side) {
+  uint64_t snipers, between, checkers, pinned = 0;
+  int king_square = KingSQ(side), sniper, enemy = Flip(side);
+
+  checkers =
+      (knight_attacks[king_square] & Knights(enemy)) |
+      (pawn_attacks[side][king_square] & Pawns(enemy));
+  snipers =
+      (RookAttacks(king_square,
+          Occupied(enemy)) & (Rooks(enemy) | Queens(enemy))) |
+      (BishopAttacks(king_square,
+          Occupied(enemy)) & (Bishops(enemy) | Queens(enemy)));
+  for (; snipers; Clear(sniper, snipers)) {
+    sniper = LSB(snipers);
+    between = InterposeSquares(king_square, sniper) & OccupiedSquares;
+    if (!between)
+      checkers |= SetMask(sniper);
+    else if (!(between & (between - 1)))
+      pinned |= between;
+  }
+  tree->next_status[ply].pinned = pinned;
+  if (!checkers)
+    tree->next_status[ply].check_mask = ~(uint64_t) 0;
+  else if (checkers & (checkers - 1))
+    tree->next_status[ply].check_mask = 0;
+  else
+    tree->next_status[ply].check_mask =
+        checkers | InterposeSquares(king_square, LSB(checkers));
+}
+
+/* last modified 10/18/26 */
+/*
+ *******************************************************************************
+ *                                                                             *
+ *   LegalMove() is the legality test that replaces "MakeMove() then Check()". *
+ *   <move> must be pseudo-legal in the current position (it came from one of  *
+ *   the move generators or passed ValidMove()) and GenerateLegalMasks() must  *
+ *   have been called for this ply.  Four cases:                               *
+ *                                                                             *
+ *   (1) king moves.  Castling has already been fully tested by the generator  *
+ *       or ValidMove(), otherwise the destination must not be attacked with   *
+ *       the king removed from the board, so that the king can not step back   *
+ *       along the line of a checking slider.  When not in check no slider     *
+ *       reaches the king, so removing it changes nothing and the attack map   *
+ *       for this ply (see AttackMap()) answers for every king move at once.   *
+ *                                                                             *
+ *   (2) en passant captures remove two pieces from one rank, which can expose *
+ *       the king in ways the pin test does not see, so we simply test the     *
+ *       resulting occupancy directly.  These are rare enough not to matter.   *
+ *                                                                             *
+ *   (3) everything else has to land in check_mask, and                        *
+ *                                                                             *
+ *   (4) a pinned piece has to stay on the ray between its king and the        *
+ *       pinning piece (which includes capturing the pinning piece).           *
+ *                                                                             *
+ *******************************************************************************
+ */
+int LegalMove(TREE * RESTRICT tree, int ply, int side, int move) {
+  uint64_t occ;
+  int from = From(move), to = To(move), enemy = Flip(side);
+  int king_square = KingSQ(side);
+
+  if (Piece(move) == king) {
+    if (Abs(to - from) == 2)
+      return 1;
+    if (tree->next_status[ply].check_mask == ~(uint64_t) 0)
+      return !(AttackMap(tree, ply, enemy)[0] & SetMask(to));
+    occ = OccupiedSquares ^ SetMask(from);
+    return !((RookAttacks(to, occ) & (Rooks(enemy) | Queens(enemy))) ||
+        (BishopAttacks(to, occ) & (Bishops(enemy) | Queens(enemy))) ||
+        (knight_attacks[to] & Knights(enemy)) ||
+        (pawn_attacks[side][to] & Pawns(enemy)) ||
+        (king_attacks[to] & Kings(enemy)));
+  }
+  if (Piece(move) == pawn && Captured(move) == pawn && !PcOnSq(to)) {
+    int capsq = to + epsq[side];
+
+    occ = (OccupiedSquares ^ SetMask(from) ^ SetMask(capsq)) | SetMask(to);
+    return !((RookAttacks(king_square,
+                occ) & (Rooks(enemy) | Queens(enemy))) ||
+        (BishopAttacks(king_square,
+                occ) & (Bishops(enemy) | Queens(enemy))) ||
+        (knight_attacks[king_square] & Knights(enemy)) ||
+        (pawn_attacks[side][king_square] & Pawns(enemy) & ~SetMask(capsq)));
+  }
+  if (!(tree->next_status[ply].check_mask & SetMask(to)))
+    return 0;
+  if (tree->next_status[ply].pinned & SetMask(from))
+    return directions[king_square][from] == directions[king_square][to];
+  return 1;
+}
@@ -1,6 +1,6 @@
 #include "chess.h"
 #include "data.h"
-/* last modified 09/21/14 */
+/* last modified 10/19/26 */
 /*
  *******************************************************************************
  *                                                                             *
@@ -8,12 +8,15 @@
  *   when the king is in check.  We use GenerateEvasions() (in movgen.c) to    *
  *   generate a list of moves that get us out of check.  The only unusual      *
  *   feature is that these moves are all legal and do not need to be vetted    *
- *   with the usual Check() function to test for legality.                     *
+ *   with the usual Check() function to test for legality.  The hash move is   *
+ *   the exception, since it only passed ValidMove(), so it is also tested     *
+ *   with LegalMove().                                                         *
  *                                                                             *
  *******************************************************************************
  */
 int NextEvasion(TREE * RESTRICT tree, int ply, int side) {
-  int *movep, *sortv;
+  int *movep, key;
+  uint64_t *recp, best;
 
   switch (tree->next_status[ply].phase) {
 /*
@@ -30,7 +33,9 @@ int NextEvasion(TREE * RESTRICT tree, int ply, int side) {
       if (tree->hash_move[ply]) {
         tree->next_status[ply].phase = GENERATE_ALL_MOVES;
         tree->curmv[ply] = tree->hash_move[ply];
-        if (ValidMove(tree, ply, side, tree->curmv[ply]))
+        GenerateLegalMasks(tree, ply, side);
+        if (ValidMove(tree, ply, side, tree->curmv[ply]) &&
+            LegalMove(tree, ply, side, tree->curmv[ply]))
           return HASH_MOVE;
 #if defined(DEBUG)
         else
@@ -61,64 +66,42 @@ int NextEvasion(TREE * RESTRICT tree, int ply, int side) {
       tree->last[ply] =
           GenerateCheckEvasions(tree, ply, side, tree->last[ply - 1]);
       tree->next_status[ply].phase = REMAINING_MOVES;
-      for (movep = tree->last[ply - 1], sortv = tree->sort_value;
-          movep < tree->last[ply]; movep++, sortv++)
-        if (tree->hash_move[ply] && *movep == tree->hash_move[ply]) {
-          *sortv = -999999;
-          *movep = 0;
-        } else {
+      for (movep = tree->last[ply - 1], recp = MoveRecords(ply - 1);
+          movep < tree->last[ply]; movep++, recp++)
+        if (tree->hash_move[ply] && *movep == tree->hash_move[ply])
+          *recp = 0;
+        else {
           if (pcval[Piece(*movep)] <= pcval[Captured(*movep)])
-            *sortv = 1024 * pcval[Captured(*movep)] - pcval[Piece(*movep)];
+            key = 1024 * pcval[Captured(*movep)] - pcval[Piece(*movep)];
           else {
-            *sortv = Swap(tree, *movep, side);
-            if (*sortv >= 0)
-              *sortv = 1024 * pcval[Captured(*movep)] - pcval[Piece(*movep)];
+            key = Swap(tree, ply, *movep, side);
+            if (key >= 0)
+              key = 1024 * pcval[Captured(*movep)] - pcval[Piece(*movep)];
           }
+          *recp = Record(*movep, key);
         }
+      tree->next_status[ply].last = MoveRecords(ply - 1);
 /*
  ************************************************************
  *                                                          *
- *  This is a simple insertion sort algorithm.  It seems be *
- *  be no faster than a normal bubble sort, but using this  *
- *  eliminated a lot of explaining about "why?". :)         *
- *                                                          *
- ************************************************************
- */
-      if (tree->last[ply] > tree->last[ply - 1] + 1) {
-        int temp1, temp2, *tmovep, *tsortv, *end;
-
-        sortv = tree->sort_value + 1;
-        end = tree->last[ply];
-        for (movep = tree->last[ply - 1] + 1; movep < end; movep++, sortv++) {
-          temp1 = *movep;
-          temp2 = *sortv;
-          tmovep = movep - 1;
-          tsortv = sortv - 1;
-          while (tmovep >= tree->last[ply - 1] && *tsortv < temp2) {
-            *(tsortv + 1) = *tsortv;
-            *(tmovep + 1) = *tmovep;
-            tmovep--;
-            tsortv--;
-          }
-          *(tmovep + 1) = temp1;
-          *(tsortv + 1) = temp2;
-        }
-      }
-      tree->next_status[ply].last = tree->last[ply - 1];
-/*
- ************************************************************
- *                                                          *
- *  Now try the moves in sorted order.                      *
+ *  Now try the moves in sorted order.  Rather than sorting *
+ *  the whole list up front, NextRecord() pulls the best    *
+ *  remaining record forward one move at a time, so a       *
+ *  cutoff on an early evasion skips the rest of the sort.  *
+ *  Removed moves have a zero record, which sorts below any *
+ *  real move, so the first zero we select ends the list.   *
  *                                                          *
  ************************************************************
  */
     case REMAINING_MOVES:
-      for (; tree->next_status[ply].last < tree->last[ply];
-          tree->next_status[ply].last++)
-        if (*tree->next_status[ply].last) {
-          tree->curmv[ply] = *tree->next_status[ply].last++;
+      if (tree->next_status[ply].last < MoveRecords(ply)) {
+        best =
+            NextRecord(tree->next_status[ply].last++, MoveRecords(ply));
+        if (best) {
+          tree->curmv[ply] = RecordMove(best);
           return REMAINING_MOVES;
         }
+      }
       return NONE;
     default:
       _printf("oops!  next_status.phase is bad! [evasion %d]\n",
@@ -127,7 +110,7 @@ int NextEvasion(TREE * RESTRICT tree, int ply, int side) {
   return NONE;
 }
 
-/* last modified 09/21/14 */
+/* last modified 10/19/26 */
 /*
  *******************************************************************************
  *                                                                             *
@@ -138,10 +121,18 @@ int NextEvasion(TREE * RESTRICT tree, int ply, int side) {
  *   save them in the NEXT structure and make sure to exclude them when        *
  *   searching after a move generation to avoid the duplicated effort.         *
  *                                                                             *
+ *   Every move returned is legal.  The pinned piece and check masks are      *
+ *   computed once when we enter the node (GenerateLegalMasks()) and each      *
+ *   move is tested with LegalMove() as it is generated or, for the hash and   *
+ *   killer moves, right after ValidMove().  Illegal moves are dropped from    *
+ *   the list the same way the hash move is, so Search() never has to make an *
+ *   illegal move and then call Check() to discover that.                     *
+ *                                                                             *
  *******************************************************************************
  */
 int NextMove(TREE * RESTRICT tree, int ply, int depth, int side) {
-  int *movep, *sortv, *bestp, bestval, hvalue;
+  int *movep, bestval, hvalue;
+  uint64_t *recp, *bestp;
 
   switch (tree->next_status[ply].phase) {
 /*
@@ -154,13 +145,15 @@ int NextMove(TREE * RESTRICT tree, int ply, int depth, int side) {
  ************************************************************
  */
     case HASH_MOVE:
+      GenerateLegalMasks(tree, ply, side);
       tree->next_status[ply].excluded = 0;
       tree->next_status[ply].phase = GENERATE_CAPTURE_MOVES;
       if (tree->hash_move[ply]) {
         tree->curmv[ply] = tree->hash_move[ply];
         tree->next_status[ply].done[tree->next_status[ply].excluded++]
             = tree->curmv[ply];
-        if (ValidMove(tree, ply, side, tree->curmv[ply]))
+        if (ValidMove(tree, ply, side, tree->curmv[ply]) &&
+            LegalMove(tree, ply, side, tree->curmv[ply]))
           return HASH_MOVE;
 #if defined(DEBUG)
         else
@@ -183,47 +176,23 @@ int NextMove(TREE * RESTRICT tree, int ply, int depth, int side) {
       tree->next_status[ply].phase = CAPTURE_MOVES;
       tree->last[ply] =
           GenerateCaptures(tree, ply, side, tree->last[ply - 1]);
+      Stat(tree, capture_gens);
+      StatAdd(tree, captures_generated, tree->last[ply] - tree->last[ply - 1]);
       tree->next_status[ply].remaining = 0;
-      for (movep = tree->last[ply - 1], sortv = tree->sort_value;
-          movep < tree->last[ply]; movep++, sortv++)
+      for (movep = tree->last[ply - 1], recp = MoveRecords(ply - 1);
+          movep < tree->last[ply]; movep++, recp++)
         if (*movep == tree->hash_move[ply]) {
-          *sortv = -999999;
-          *movep = 0;
+          *recp = 0;
           tree->next_status[ply].excluded = 0;
-        } else {
-          *sortv = 1024 * pcval[Captured(*movep)] - pcval[Piece(*movep)];
+        } else if (!LegalMove(tree, ply, side, *movep))
+          *recp = 0;
+        else {
+          *recp =
+              Record(*movep, 1024 * pcval[Captured(*movep)] -
+              pcval[Piece(*movep)]);
           tree->next_status[ply].remaining++;
         }
-/*
- ************************************************************
- *                                                          *
- *  This is a simple insertion sort algorithm.  It seems to *
- *  be no faster than a normal bubble sort, but using this  *
- *  eliminated a lot of explaining about "why?". :)         *
- *                                                          *
- ************************************************************
- */
-      if (tree->last[ply] > tree->last[ply - 1] + 1) {
-        int temp1, temp2, *tmovep, *tsortv, *end;
-
-        sortv = tree->sort_value + 1;
-        end = tree->last[ply];
-        for (movep = tree->last[ply - 1] + 1; movep < end; movep++, sortv++) {
-          temp1 = *movep;
-          temp2 = *sortv;
-          tmovep = movep - 1;
-          tsortv = sortv - 1;
-          while (tmovep >= tree->last[ply - 1] && *tsortv < temp2) {
-            *(tsortv + 1) = *tsortv;
-            *(tmovep + 1) = *tmovep;
-            tmovep--;
-            tsortv--;
-          }
-          *(tmovep + 1) = temp1;
-          *(tsortv + 1) = temp2;
-        }
-      }
-      tree->next_status[ply].last = tree->last[ply - 1];
+      tree->next_status[ply].last = MoveRecords(ply - 1);
 /*
  ************************************************************
  *                                                          *
@@ -232,15 +201,23 @@ int NextMove(TREE * RESTRICT tree, int ply, int depth, int side) {
  *  lesser-valued piece, and Swap() says it loses material, *
  *  this capture will be deferred until later.              *
  *                                                          *
+ *  The list is not sorted in advance.  NextRecord() moves  *
+ *  the best remaining capture up to the front each time we *
+ *  need one, so a cutoff on the first capture costs just a *
+ *  single pass over the list.  Deferred captures are left  *
+ *  in front in sorted order for the REMAINING_MOVES phase. *
+ *                                                          *
  ************************************************************
  */
     case CAPTURE_MOVES:
       while (tree->next_status[ply].remaining) {
-        tree->curmv[ply] = *(tree->next_status[ply].last++);
+        tree->curmv[ply] =
+            RecordMove(NextRecord(tree->next_status[ply].last++,
+                MoveRecords(ply)));
         if (!--tree->next_status[ply].remaining)
           tree->next_status[ply].phase = KILLER_MOVE_1;
         if (pcval[Piece(tree->curmv[ply])] > pcval[Captured(tree->curmv[ply])]
-            && Swap(tree, tree->curmv[ply], side) < 0)
+            && Swap(tree, ply, tree->curmv[ply], side) < 0)
           continue;
         *(tree->next_status[ply].last - 1) = 0;
         return CAPTURE_MOVES;
@@ -259,7 +236,8 @@ int NextMove(TREE * RESTRICT tree, int ply, int depth, int side) {
  */
     case KILLER_MOVE_1:
       if (!Exclude(tree, ply, tree->killers[ply].move1) &&
-          ValidMove(tree, ply, side, tree->killers[ply].move1)) {
+          ValidMove(tree, ply, side, tree->killers[ply].move1) &&
+          LegalMove(tree, ply, side, tree->killers[ply].move1)) {
         tree->curmv[ply] = tree->killers[ply].move1;
         tree->next_status[ply].done[tree->next_status[ply].excluded++]
             = tree->curmv[ply];
@@ -268,7 +246,8 @@ int NextMove(TREE * RESTRICT tree, int ply, int depth, int side) {
       }
     case KILLER_MOVE_2:
       if (!Exclude(tree, ply, tree->killers[ply].move2) &&
-          ValidMove(tree, ply, side, tree->killers[ply].move2)) {
+          ValidMove(tree, ply, side, tree->killers[ply].move2) &&
+          LegalMove(tree, ply, side, tree->killers[ply].move2)) {
         tree->curmv[ply] = tree->killers[ply].move2;
         tree->next_status[ply].done[tree->next_status[ply].excluded++]
             = tree->curmv[ply];
@@ -280,7 +259,8 @@ int NextMove(TREE * RESTRICT tree, int ply, int depth, int side) {
       }
     case KILLER_MOVE_3:
       if (!Exclude(tree, ply, tree->killers[ply - 2].move1) &&
-          ValidMove(tree, ply, side, tree->killers[ply - 2].move1)) {
+          ValidMove(tree, ply, side, tree->killers[ply - 2].move1) &&
+          LegalMove(tree, ply, side, tree->killers[ply - 2].move1)) {
         tree->curmv[ply] = tree->killers[ply - 2].move1;
         tree->next_status[ply].done[tree->next_status[ply].excluded++]
             = tree->curmv[ply];
@@ -289,7 +269,8 @@ int NextMove(TREE * RESTRICT tree, int ply, int depth, int side) {
       }
     case KILLER_MOVE_4:
       if (!Exclude(tree, ply, tree->killers[ply - 2].move2) &&
-          ValidMove(tree, ply, side, tree->killers[ply - 2].move2)) {
+          ValidMove(tree, ply, side, tree->killers[ply - 2].move2) &&
+          LegalMove(tree, ply, side, tree->killers[ply - 2].move2)) {
         tree->curmv[ply] = tree->killers[ply - 2].move2;
         tree->next_status[ply].done[tree->next_status[ply].excluded++]
             = tree->curmv[ply];
@@ -305,8 +286,11 @@ int NextMove(TREE * RESTRICT tree, int ply, int depth, int side) {
  ************************************************************
  */
     case GENERATE_ALL_MOVES:
-      tree->last[ply] = GenerateNoncaptures(tree, ply, side, tree->last[ply]);
-      tree->next_status[ply].last = tree->last[ply - 1];
+      movep = tree->last[ply];
+      tree->last[ply] = GenerateNoncaptures(tree, ply, side, movep);
+      Stat(tree, noncapture_gens);
+      StatAdd(tree, noncaptures_generated, tree->last[ply] - movep);
+      tree->next_status[ply].last = MoveRecords(ply - 1);
 /*
  ************************************************************
  *                                                          *
@@ -316,26 +300,39 @@ int NextMove(TREE * RESTRICT tree, int ply, int depth, int side) {
  *  history score.  This phase is only done one time, as it *
  *  also purges the hash and killer moves from the list.    *
  *                                                          *
+ *  Captures left over from the capture phase were already  *
+ *  tested by LegalMove() and can't be the hash move or a   *
+ *  killer (History() never stores a capture), so only the  *
+ *  records we pack for the new non-captures are vetted.    *
+ *                                                          *
  ************************************************************
  */
       tree->next_status[ply].remaining = 1;
       tree->next_status[ply].phase = HISTORY_MOVES;
       bestval = -99999999;
       bestp = 0;
-      for (movep = tree->last[ply - 1]; movep < tree->last[ply]; movep++)
-        if (*movep) {
-          if (Exclude(tree, ply, *movep))
-            *movep = 0;
-          else {
-            hvalue = history[side][HistoryIndex(*movep)];
-            if (hvalue > bestval) {
-              bestval = hvalue;
-              bestp = movep;
-            }
+      for (recp = MoveRecords(ply - 1);
+          recp < tree->move_record + (movep - tree->move_list); recp++)
+        if (*recp) {
+          hvalue = history[side][HistoryIndex(RecordMove(*recp))];
+          if (hvalue > bestval) {
+            bestval = hvalue;
+            bestp = recp;
+          }
+        }
+      for (; movep < tree->last[ply]; movep++, recp++)
+        if (Exclude(tree, ply, *movep) || !LegalMove(tree, ply, side, *movep))
+          *recp = 0;
+        else {
+          *recp = Record(*movep, 0);
+          hvalue = history[side][HistoryIndex(*movep)];
+          if (hvalue > bestval) {
+            bestval = hvalue;
+            bestp = recp;
           }
         }
       if (bestp) {
-        tree->curmv[ply] = *bestp;
+        tree->curmv[ply] = RecordMove(*bestp);
         *bestp = 0;
         if (bestval < -1000)
           tree->phase[ply] = REMAINING_MOVES;
@@ -356,30 +353,30 @@ int NextMove(TREE * RESTRICT tree, int ply, int depth, int side) {
       if (depth >= 6) {
         bestval = -99999999;
         bestp = 0;
-        for (movep = tree->last[ply - 1]; movep < tree->last[ply]; movep++)
-          if (*movep) {
-            hvalue = history[side][HistoryIndex(*movep)];
+        for (recp = MoveRecords(ply - 1); recp < MoveRecords(ply); recp++)
+          if (*recp) {
+            hvalue = history[side][HistoryIndex(RecordMove(*recp))];
             if (hvalue > bestval) {
               bestval = hvalue;
-              bestp = movep;
+              bestp = recp;
             }
           }
         if (bestp) {
-          tree->curmv[ply] = *bestp;
+          tree->curmv[ply] = RecordMove(*bestp);
           *bestp = 0;
           if (bestval < -1000)
             tree->phase[ply] = REMAINING_MOVES;
           tree->next_status[ply].remaining++;
           if (tree->next_status[ply].remaining > 10) {
             tree->next_status[ply].phase = REMAINING_MOVES;
-            tree->next_status[ply].last = tree->last[ply - 1];
+            tree->next_status[ply].last = MoveRecords(ply - 1);
           }
           return (HISTORY_MOVES);
         }
       }
     remaining_moves:
       tree->next_status[ply].phase = REMAINING_MOVES;
-      tree->next_status[ply].last = tree->last[ply - 1];
+      tree->next_status[ply].last = MoveRecords(ply - 1);
 /*
  ************************************************************
  *                                                          *
@@ -391,10 +388,10 @@ int NextMove(TREE * RESTRICT tree, int ply, int depth, int side) {
  ************************************************************
  */
     case REMAINING_MOVES:
-      for (; tree->next_status[ply].last < tree->last[ply];
+      for (; tree->next_status[ply].last < MoveRecords(ply);
           tree->next_status[ply].last++)
         if (*tree->next_status[ply].last) {
-          tree->curmv[ply] = *tree->next_status[ply].last++;
+          tree->curmv[ply] = RecordMove(*tree->next_status[ply].last++);
           return REMAINING_MOVES;
         }
       return NONE;
@@ -405,7 +402,36 @@ int NextMove(TREE * RESTRICT tree, int ply, int depth, int side) {
   return NONE;
 }
 
-/* last modified 09/21/14 */
+/* last modified 10/18/26 */
+/*
+ *******************************************************************************
+ *                                                                             *
+ *   NextRecord() does one step of a selection sort on a list of packed move   *
+ *   records.  It finds the record with the largest ordering key between       *
+ *   first and end and moves it to first, sliding the records it passed over   *
+ *   down one slot.  Sliding rather than swapping keeps records with equal     *
+ *   keys in the order they were generated, so the moves come out in exactly   *
+ *   the order a stable sort of the whole list would have produced, but we     *
+ *   only pay for the part of the sort that is actually used before a cutoff.  *
+ *   The selected record is returned.                                          *
+ *                                                                             *
+ *******************************************************************************
+ */
+uint64_t NextRecord(uint64_t * first, uint64_t * end) {
+  uint64_t *recp, *bestp, best;
+
+  bestp = first;
+  for (recp = first + 1; recp < end; recp++)
+    if (RecordKey(*recp) > RecordKey(*bestp))
+      bestp = recp;
+  best = *bestp;
+  for (; bestp > first; bestp--)
+    *bestp = *(bestp - 1);
+  *first = best;
+  return best;
+}
+
+/* last modified 10/18/26 */
 /*
  *******************************************************************************
  *                                                                             *
@@ -499,7 +525,7 @@ int NextRootMove(TREE * RESTRICT tree, TREE * RESTRICT mytree, int side) {
         for (i = 1; i < MAX_BLOCKS; i++)
           if (block[i] && block[i]->used)
             total_nodes += block[i]->nodes_searched;
-        nodes_per_second = total_nodes * 100 / Max(end_time - start_time, 1);
+        nodes_per_second = total_nodes * 1000 / Max(end_time - start_time, 1);
         i = strlen(mytree->root_move_text);
         i = (i < 8) ? i : 8;
         strncat(mytree->root_move_text, "          ", 8 - i);
@@ -0,0 +1,399 @@
+#include "chess.h"
+#include "data.h"
+#if defined(NNUE)
+/* last modified 10/18/26 */
+/*
+ *******************************************************************************
+ *                                                                             *
+ *   NnueEvaluate() is the alternative to the normal hand-written evaluation,  *
+ *   used in place of it when a network has been loaded with the "nnue"        *
+ *   command.  The network is deliberately small so that it runs well on a     *
+ *   phone:                                                                    *
+ *                                                                             *
+ *   (1) the input layer has one input for each piece type and color on each   *
+ *       square (768), seen from each side's point of view.  For black the     *
+ *       board is flipped vertically and the colors are swapped, so the same   *
+ *       weights serve both sides.                                             *
+ *                                                                             *
+ *   (2) the feature transformer turns those into NNUE_HIDDEN 16 bit sums per  *
+ *       side (the "accumulators").  Only a handful of inputs change on any    *
+ *       one move, so MakeMove() and UnmakeMove() just add and subtract the    *
+ *       weight columns for the pieces that moved (see NnueMakeMove()), and    *
+ *       the accumulators are only computed from scratch by NnueRefresh()      *
+ *       when a position is set up.                                            *
+ *                                                                             *
+ *   (3) the output layer takes the side-to-move accumulator followed by the   *
+ *       other side's, clipped to 0..NNUE_QA, and produces one score.  The     *
+ *       transformer weights are scaled by NNUE_QA and the output weights by   *
+ *       NNUE_QB, so the score in centipawns is sum * NNUE_SCALE / (QA * QB).  *
+ *                                                                             *
+ *   The score is returned from the point of view of the side on move, just    *
+ *   like Evaluate().                                                          *
+ *                                                                             *
+ *******************************************************************************
+ */
+int NnueEvaluate(TREE * RESTRICT tree, int wtm) {
+  int32_t sum;
+
+  sum =
+      NnueDot(tree->position.nnue_acc[wtm],
+      nnue_output_weights) + NnueDot(tree->position.nnue_acc[Flip(wtm)],
+      nnue_output_weights + NNUE_HIDDEN) + nnue_output_bias;
+  return (int) ((int64_t) sum * NNUE_SCALE / (NNUE_QA * NNUE_QB));
+}
+
+/* last modified 10/18/26 */
+/*
+ *******************************************************************************
+ *                                                                             *
+ *   NnueMakeMove() and NnueUnmakeMove() are called from MakeMove() and        *
+ *   UnmakeMove() to update the accumulators.  A move changes at most four     *
+ *   inputs (castling moves two pieces, a capture/promotion removes two and    *
+ *   adds one), so the changes are collected as lists of weight columns to     *
+ *   add and subtract, and NnueAccumulate() applies them all in one pass over  *
+ *   each accumulator.  Unmaking a move simply swaps the two lists, since 16   *
+ *   bit addition wraps around exactly.                                        *
+ *                                                                             *
+ *******************************************************************************
+ */
+void NnueMakeMove(TREE * RESTRICT tree, int ply, int move, int side) {
+  NnueUpdate(tree, ply, move, side, 1);
+}
+
+void NnueUnmakeMove(TREE * RESTRICT tree, int ply, int move, int side) {
+  NnueUpdate(tree, ply, move, side, 0);
+}
+
+void NnueUpdate(TREE * RESTRICT tree, int ply, int move, int side, int make) {
+  const int16_t *add[2], *sub[2];
+  int piece = Piece(move), from = From(move), to = To(move);
+  int captured = Captured(move), promote = Promote(move);
+  int adds[2][3], subs[2][3], nadd = 0, nsub = 0;
+  int i, persp, enemy = Flip(side);
+
+/*
+ ************************************************************
+ *                                                          *
+ *  Build the lists of (color, piece, square) inputs that   *
+ *  go from 0 to 1 (adds) and from 1 to 0 (subs) when the   *
+ *  move is made.                                           *
+ *                                                          *
+ ************************************************************
+ */
+#  define NnueInput(list, n, c, p, sq) \
+    (list[n][0] = (c), list[n][1] = (p), list[n][2] = (sq), n++)
+  NnueInput(subs, nsub, side, piece, from);
+  NnueInput(adds, nadd, side, (promote) ? promote : piece, to);
+  if (captured) {
+    if (piece == pawn && captured == pawn && EnPassant(ply) == to)
+      NnueInput(subs, nsub, enemy, pawn, to + epsq[side]);
+    else
+      NnueInput(subs, nsub, enemy, captured, to);
+  } else if (piece == king && Abs(to - from) == 2) {
+    if (to == rook_G[side]) {
+      NnueInput(subs, nsub, side, rook, rook_H[side]);
+      NnueInput(adds, nadd, side, rook, rook_F[side]);
+    } else {
+      NnueInput(subs, nsub, side, rook, rook_A[side]);
+      NnueInput(adds, nadd, side, rook, rook_D[side]);
+    }
+  }
+#  undef NnueInput
+/*
+ ************************************************************
+ *                                                          *
+ *  Now apply them to each side's accumulator, with the     *
+ *  lists swapped if we are unmaking the move.              *
+ *                                                          *
+ ************************************************************
+ */
+  for (persp = black; persp <= white; persp++) {
+    for (i = 0; i < nadd; i++)
+      add[i] =
+          nnue_input_weights + NnueIndex(persp, adds[i][0], adds[i][1],
+          adds[i][2]) * NNUE_HIDDEN;
+    for (i = 0; i < nsub; i++)
+      sub[i] =
+          nnue_input_weights + NnueIndex(persp, subs[i][0], subs[i][1],
+          subs[i][2]) * NNUE_HIDDEN;
+    if (make)
+      NnueAccumulate(tree->position.nnue_acc[persp], add, nadd, sub, nsub);
+    else
+      NnueAccumulate(tree->position.nnue_acc[persp], sub, nsub, add, nadd);
+  }
+}
+
+/* last modified 10/18/26 */
+/*
+ *******************************************************************************
+ *                                                                             *
+ *   NnueAccumulate() and NnueDot() are the two kernels that do nearly all of  *
+ *   the work.  NnueAccumulate() adds/subtracts weight columns to/from an      *
+ *   accumulator.  NnueDot() clips an accumulator to 0..NNUE_QA and returns    *
+ *   its dot product with a row of output weights.  Each has a SIMD version    *
+ *   for whatever the compiler target supports (NNUE_KERNEL) and plain C       *
+ *   otherwise (NnueDotReference() is the plain C version of NnueDot()).       *
+ *                                                                             *
+ *******************************************************************************
+ */
+void NnueAccumulate(int16_t * acc, const int16_t ** add, int nadd,
+    const int16_t ** sub, int nsub) {
+  int i, k;
+
+#  if defined(__AVX2__)
+  for (i = 0; i < NNUE_HIDDEN; i += 16) {
+    __m256i v = _mm256_loadu_si256((__m256i *) (acc + i));
+
+    for (k = 0; k < nadd; k++)
+      v = _mm256_add_epi16(v, _mm256_loadu_si256((const __m256i *) (add[k] +
+                  i)));
+    for (k = 0; k < nsub; k++)
+      v = _mm256_sub_epi16(v, _mm256_loadu_si256((const __m256i *) (sub[k] +
+                  i)));
+    _mm256_storeu_si256((__m256i *) (acc + i), v);
+  }
+#  elif defined(__SSE2__) || defined(_M_X64)
+  for (i = 0; i < NNUE_HIDDEN; i += 8) {
+    __m128i v = _mm_loadu_si128((__m128i *) (acc + i));
+
+    for (k = 0; k < nadd; k++)
+      v = _mm_add_epi16(v, _mm_loadu_si128((const __m128i *) (add[k] + i)));
+    for (k = 0; k < nsub; k++)
+      v = _mm_sub_epi16(v, _mm_loadu_si128((const __m128i *) (sub[k] + i)));
+    _mm_storeu_si128((__m128i *) (acc + i), v);
+  }
+#  elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+  for (i = 0; i < NNUE_HIDDEN; i += 8) {
+    int16x8_t v = vld1q_s16(acc + i);
+
+    for (k = 0; k < nadd; k++)
+      v = vaddq_s16(v, vld1q_s16(add[k] + i));
+    for (k = 0; k < nsub; k++)
+      v = vsubq_s16(v, vld1q_s16(sub[k] + i));
+    vst1q_s16(acc + i, v);
+  }
+#  else
+  for (k = 0; k < nadd; k++)
+    for (i = 0; i < NNUE_HIDDEN; i++)
+      acc[i] += add[k][i];
+  for (k = 0; k < nsub; k++)
+    for (i = 0; i < NNUE_HIDDEN; i++)
+      acc[i] -= sub[k][i];
+#  endif
+}
+
+int32_t NnueDot(const int16_t * acc, const int16_t * weights) {
+#  if defined(__AVX2__)
+  __m256i sum = _mm256_setzero_si256(), zero = _mm256_setzero_si256();
+  __m256i qa = _mm256_set1_epi16(NNUE_QA), v;
+  __m128i s;
+  int i;
+
+  for (i = 0; i < NNUE_HIDDEN; i += 16) {
+    v = _mm256_loadu_si256((const __m256i *) (acc + i));
+    v = _mm256_min_epi16(_mm256_max_epi16(v, zero), qa);
+    sum =
+        _mm256_add_epi32(sum, _mm256_madd_epi16(v,
+            _mm256_loadu_si256((const __m256i *) (weights + i))));
+  }
+  s = _mm_add_epi32(_mm256_castsi256_si128(sum),
+      _mm256_extracti128_si256(sum, 1));
+  s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0x4e));
+  s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0xb1));
+  return _mm_cvtsi128_si32(s);
+#  elif defined(__SSE2__) || defined(_M_X64)
+  __m128i sum = _mm_setzero_si128(), zero = _mm_setzero_si128();
+  __m128i qa = _mm_set1_epi16(NNUE_QA), v;
+  int i;
+
+  for (i = 0; i < NNUE_HIDDEN; i += 8) {
+    v = _mm_loadu_si128((const __m128i *) (acc + i));
+    v = _mm_min_epi16(_mm_max_epi16(v, zero), qa);
+    sum =
+        _mm_add_epi32(sum, _mm_madd_epi16(v,
+            _mm_loadu_si128((const __m128i *) (weights + i))));
+  }
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4e));
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xb1));
+  return _mm_cvtsi128_si32(sum);
+#  elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+  int32x4_t sum = vdupq_n_s32(0);
+  int16x8_t zero = vdupq_n_s16(0), qa = vdupq_n_s16(NNUE_QA), v, w;
+  int i;
+
+  for (i = 0; i < NNUE_HIDDEN; i += 8) {
+    v = vminq_s16(vmaxq_s16(vld1q_s16(acc + i), zero), qa);
+    w = vld1q_s16(weights + i);
+    sum = vmlal_s16(sum, vget_low_s16(v), vget_low_s16(w));
+    sum = vmlal_s16(sum, vget_high_s16(v), vget_high_s16(w));
+  }
+#    if defined(__aarch64__)
+  return vaddvq_s32(sum);
+#    else
+  {
+    int32x2_t s = vadd_s32(vget_low_s32(sum), vget_high_s32(sum));
+
+    return vget_lane_s32(vpadd_s32(s, s), 0);
+  }
+#    endif
+#  else
+  return NnueDotReference(acc, weights);
+#  endif
+}
+
+/* last modified 10/18/26 */
+/*
+ *******************************************************************************
+ *                                                                             *
+ *   NnueDotReference() and NnueRefresh() are the plain C reference versions.  *
+ *   NnueRefresh() computes both accumulators from scratch, which is needed    *
+ *   whenever a position is set up rather than reached by MakeMove(), and      *
+ *   when the network is first switched on.                                    *
+ *                                                                             *
+ *******************************************************************************
+ */
+int32_t NnueDotReference(const int16_t * acc, const int16_t * weights) {
+  int32_t sum = 0;
+  int i;
+
+  for (i = 0; i < NNUE_HIDDEN; i++)
+    sum += Min(Max(acc[i], 0), NNUE_QA) * weights[i];
+  return sum;
+}
+
+void NnueRefresh(TREE * RESTRICT tree) {
+  const int16_t *column;
+  int persp, square, i;
+
+  if (!nnue_input_weights)
+    return;
+  for (persp = black; persp <= white; persp++) {
+    for (i = 0; i < NNUE_HIDDEN; i++)
+      tree->position.nnue_acc[persp][i] = nnue_input_bias[i];
+    for (square = 0; square < 64; square++)
+      if (PcOnSq(square)) {
+        column =
+            nnue_input_weights + NnueIndex(persp,
+            (PcOnSq(square) > 0) ? white : black, Abs(PcOnSq(square)),
+            square) * NNUE_HIDDEN;
+        for (i = 0; i < NNUE_HIDDEN; i++)
+          tree->position.nnue_acc[persp][i] += column[i];
+      }
+  }
+}
+
+/* last modified 10/18/26 */
+/*
+ *******************************************************************************
+ *                                                                             *
+ *   NnueLoad() reads a network from "filename".  The file is little-endian    *
+ *   throughout:                                                               *
+ *                                                                             *
+ *     "CNUE"                       4 byte signature                           *
+ *     version                      int32, must be 1                           *
+ *     hidden                       int32, must equal NNUE_HIDDEN              *
+ *     input weights                int16 [768][hidden]                        *
+ *     input biases                 int16 [hidden]                             *
+ *     output weights               int16 [2][hidden] (side on move first)     *
+ *     output bias                  int32                                      *
+ *                                                                             *
+ *   Input number ((c != side) * 6 + piece - 1) * 64 + square is a piece of    *
+ *   color c on square (flipped vertically for black), seen by "side".  The    *
+ *   whole file is read and checked before anything is replaced, so a bad      *
+ *   file leaves the current network (if any) in place.  Returns 1 if the      *
+ *   network was loaded, 0 otherwise.                                          *
+ *                                                                             *
+ *******************************************************************************
+ */
+int NnueLoad(char *filename) {
+  FILE *file;
+  unsigned char *data, *p;
+  size_t count = (NNUE_INPUTS + 3) * NNUE_HIDDEN, size, i;
+
+  size = 12 + 2 * count + 4;
+  if (!(file = fopen(filename, "rb"))) {
+    Print(4095, "ERROR.  unable to open network file %s\n", filename);
+    return 0;
+  }
+  data = (unsigned char *) malloc(size + 1);
+  if (!data) {
+    fclose(file);
+    return 0;
+  }
+  i = fread(data, 1, size + 1, file);
+  fclose(file);
+  if (i != size || memcmp(data, "CNUE", 4) || NnueRead32(data + 4) != 1 ||
+      NnueRead32(data + 8) != NNUE_HIDDEN) {
+    Print(4095, "ERROR.  %s is not a version 1 network with %d hidden units"
+        " (%d bytes)\n", filename, NNUE_HIDDEN, (int) size);
+    free(data);
+    return 0;
+  }
+  if (!nnue_input_weights) {
+    AlignedMalloc((void **) &nnue_input_weights, 64,
+        count * sizeof(int16_t));
+    nnue_input_bias = nnue_input_weights + NNUE_INPUTS * NNUE_HIDDEN;
+    nnue_output_weights = nnue_input_bias + NNUE_HIDDEN;
+  }
+  for (i = 0, p = data + 12; i < count; i++, p += 2)
+    nnue_input_weights[i] = (int16_t) (p[0] | (p[1] << 8));
+  nnue_output_bias = NnueRead32(p);
+  free(data);
+  strncpy(nnue_file, filename, sizeof(nnue_file) - 1);
+  return 1;
+}
+
+int32_t NnueRead32(unsigned char *p) {
+  return (int32_t) (p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t) p[3] <<
+          24));
+}
+
+/* last modified 10/18/26 */
+/*
+ *******************************************************************************
+ *                                                                             *
+ *   NnueTest() checks the incrementally updated accumulators and the SIMD     *
+ *   kernels against the scalar reference versions.  It plays every legal      *
+ *   move (and every legal reply) from the current position, and at each of    *
+ *   those positions compares the accumulators with a fresh NnueRefresh()      *
+ *   and the SIMD score with the one from NnueDotReference().  Returns the     *
+ *   number of mismatches found.                                               *
+ *                                                                             *
+ *******************************************************************************
+ */
+int NnueTest(TREE * RESTRICT tree, int ply, int depth, int wtm) {
+  POSITION incremental;
+  int *mv, errors = 0, simd, reference;
+
+  incremental = tree->position;
+  NnueRefresh(tree);
+  simd = NnueEvaluate(tree, wtm);
+  reference =
+      (int) ((int64_t) (NnueDotReference(tree->position.nnue_acc[wtm],
+              nnue_output_weights) +
+          NnueDotReference(tree->position.nnue_acc[Flip(wtm)],
+              nnue_output_weights + NNUE_HIDDEN) +
+          nnue_output_bias) * NNUE_SCALE / (NNUE_QA * NNUE_QB));
+  if (memcmp(incremental.nnue_acc, tree->position.nnue_acc,
+          sizeof(incremental.nnue_acc)) || simd != reference) {
+    Print(4095, "ERROR.  nnue mismatch at ply %d (%s): eval %d, reference %d\n",
+        ply, (memcmp(incremental.nnue_acc, tree->position.nnue_acc,
+                sizeof(incremental.nnue_acc))) ? "accumulators" : "kernel",
+        simd, reference);
+    errors++;
+  }
+  if (depth <= 0)
+    return errors;
+  tree->last[ply] = GenerateCaptures(tree, ply, wtm, tree->last[ply - 1]);
+  tree->last[ply] = GenerateNoncaptures(tree, ply, wtm, tree->last[ply]);
+  GenerateLegalMasks(tree, ply, wtm);
+  for (mv = tree->last[ply - 1]; mv < tree->last[ply]; mv++) {
+    if (!LegalMove(tree, ply, wtm, *mv))
+      continue;
+    MakeMove(tree, ply, *mv, wtm);
+    errors += NnueTest(tree, ply + 1, depth - 1, Flip(wtm));
+    UnmakeMove(tree, ply, *mv, wtm);
+  }
+  return errors;
+}
+#endif
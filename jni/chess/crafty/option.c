@@ -7,7 +7,7 @@
 #  include <signal.h>
 #endif
 #include "epdglue.h"
-/* last modified 08/10/14 */
+/* last modified 10/19/26 */
 /*
  *******************************************************************************
  *                                                                             *
@@ -193,6 +193,12 @@ int Option(TREE * RESTRICT tree) {
 	 *  stream of commands can be put into a file and they are  *
 	 *  not executed instantly.                                 *
 	 *                                                          *
+	 *  "batch <in.epd> <out.jsonl> [workers=N] [depth=D]       *
+	 *  [nodes=K] [time=T] [hash=keep]" instead searches every  *
+	 *  position in <in.epd> and writes one JSON result per     *
+	 *  line to <out.jsonl> (see BatchAnalyze()).  T is in      *
+	 *  seconds.                                                *
+	 *                                                          *
 	 ************************************************************
 	 */
 	  else if (OptionMatch("batch", *args)) {
@@ -200,8 +206,40 @@ int Option(TREE * RESTRICT tree) {
 	      batch_mode = 1;
 	    else if (!strcmp(args[1], "off"))
 	      batch_mode = 0;
-	    else
+	    else if (nargs > 2) {
+	      int workers = 1, depth = 0, msecs = 0, keep_hash = 0, i;
+	      uint64_t nodes = 0;
+
+	      if (thinking || pondering)
+	        return 2;
+	      nargs = ReadParse(buffer, args, " \t;=");
+	      for (i = 3; i < nargs - 1; i += 2) {
+	        if (!strcmp(args[i], "workers"))
+	          workers = atoi(args[i + 1]);
+	        else if (!strcmp(args[i], "depth"))
+	          depth = atoi(args[i + 1]);
+	        else if (!strcmp(args[i], "nodes"))
+	          nodes = atoll(args[i + 1]);
+	        else if (!strcmp(args[i], "time"))
+	          msecs = atof(args[i + 1]) * 1000;
+	        else if (!strcmp(args[i], "hash"))
+	          keep_hash = !strcmp(args[i + 1], "keep");
+	        else {
+	          _printf("unknown batch option %s\n", args[i]);
+	          return 1;
+	        }
+	      }
+	      if (!depth && !nodes && !msecs) {
+	        _printf("batch needs a depth=, nodes= or time= limit\n");
+	        return 1;
+	      }
+	      BatchAnalyze(args[1], args[2], workers, depth, nodes, msecs,
+	          keep_hash);
+	    } else {
 	      _printf("usage:  batch on|off\n");
+	      _printf("        batch <in.epd> <out.jsonl> [workers=N] [depth=D]");
+	      _printf(" [nodes=K] [time=T] [hash=keep]\n");
+	    }
 	  }
 	/*
 	 ************************************************************
@@ -218,22 +256,72 @@ int Option(TREE * RESTRICT tree) {
 	 *                                                          *
 	 *  "bench" runs internal performance benchmark             *
 	 *                                                          *
+	 *  "bench file=<epd> depth=N repeat=K mt=N hash=SIZE       *
+	 *  json=<file>" (all optional) runs it on other positions, *
+	 *  several times, with pinned threads and hash size, and   *
+	 *  appends the results to a JSON file.  See Bench().       *
+	 *                                                          *
+	 *  "bench scaling maxmt=N ..." (same options) runs the set *
+	 *  with 1..N threads and reports speedup, search overhead  *
+	 *  and idle time.  See BenchScaling().                     *
+	 *                                                          *
+	 *  "bench bitops" times the MSB/LSB/PopCnt bitboard        *
+	 *  operators that were compiled in.                        *
+	 *                                                          *
 	 ************************************************************
 	 */
 	  else if (OptionMatch("bench", *args)) {
-	    Bench(0);
+	    char *file = 0, *json = 0;
+	    int i, depth = 0, repeats = 1, threads = 0, scaling = 0;
+	    size_t hash = 0;
+
+	    nargs = ReadParse(buffer, args, " \t;=");
+	    if (nargs > 1 && !strcmp(args[1], "bitops")) {
+	      BenchBitOps();
+	      return 1;
+	    }
+	    if (nargs > 1 && !strcmp(args[1], "scaling"))
+	      scaling = 1;
+	    for (i = 1 + scaling; i < nargs - 1; i += 2) {
+	      if (!strcmp(args[i], "file"))
+	        file = args[i + 1];
+	      else if (!strcmp(args[i], "depth"))
+	        depth = atoi(args[i + 1]);
+	      else if (!strcmp(args[i], "repeat"))
+	        repeats = atoi(args[i + 1]);
+	      else if (!strcmp(args[i], "mt") || !strcmp(args[i], "maxmt"))
+	        threads = atoi(args[i + 1]);
+	      else if (!strcmp(args[i], "hash"))
+	        hash = atoiKMB(args[i + 1]);
+	      else if (!strcmp(args[i], "json"))
+	        json = args[i + 1];
+	      else
+	        break;
+	    }
+	    if (i < nargs || (hash && hash < 64 * 1024)) {
+	      _printf("usage:  bench [file=<epd>] [depth=N] [repeat=K] [mt=N]"
+	          " [hash=SIZE] [json=<file>]\n");
+	      _printf("        bench scaling [maxmt=N] [file=<epd>] [depth=N]"
+	          " [repeat=K] [hash=SIZE] [json=<file>]\n");
+	      _printf("        (hash must be at least 64K bytes)\n");
+	      return 1;
+	    }
+	    if (scaling)
+	      BenchScaling(file, depth, repeats, threads, hash, json);
+	    else
+	      Bench(0, file, depth, repeats, threads, hash, json);
 	  } else if (OptionMatch("bench1", *args) || OptionMatch("bench-1", *args)) {
-	    Bench(-1);
+	    Bench(-1, 0, 0, 1, 0, 0, 0);
 	  } else if (OptionMatch("bench2", *args) || OptionMatch("bench-2", *args)) {
-	    Bench(-2);
+	    Bench(-2, 0, 0, 1, 0, 0, 0);
 	  } else if (OptionMatch("bench3", *args) || OptionMatch("bench-3", *args)) {
-	    Bench(-3);
+	    Bench(-3, 0, 0, 1, 0, 0, 0);
 	  } else if (OptionMatch("bench+1", *args)) {
-	    Bench(1);
+	    Bench(1, 0, 0, 1, 0, 0, 0);
 	  } else if (OptionMatch("bench+2", *args)) {
-	    Bench(2);
+	    Bench(2, 0, 0, 1, 0, 0, 0);
 	  } else if (OptionMatch("bench+3", *args)) {
-	    Bench(3);
+	    Bench(3, 0, 0, 1, 0, 0, 0);
 	  }
 	/*
 	 ************************************************************
@@ -1113,23 +1201,23 @@ int Option(TREE * RESTRICT tree) {
 	#endif
 	    if (!tc_sudden_death) {
 	      Print(128, "%d moves/%d minutes %d seconds primary time control\n",
-	          tc_moves, tc_time / 6000, (tc_time / 100) % 60);
+	          tc_moves, tc_time / 60000, (tc_time / 1000) % 60);
 	      Print(128, "%d moves/%d minutes %d seconds secondary time control\n",
-	          tc_secondary_moves, tc_secondary_time / 6000,
-	          (tc_secondary_time / 100) % 60);
+	          tc_secondary_moves, tc_secondary_time / 60000,
+	          (tc_secondary_time / 1000) % 60);
 	      if (tc_increment)
-	        Print(128, "increment %d seconds.\n", tc_increment / 100);
+	        Print(128, "increment %d seconds.\n", tc_increment / 1000);
 	    } else if (tc_sudden_death == 1) {
-	      Print(128, " game/%d minutes primary time control\n", tc_time / 6000);
+	      Print(128, " game/%d minutes primary time control\n", tc_time / 60000);
 	      if (tc_increment)
-	        Print(128, "increment %d seconds.\n", (tc_increment / 100) % 60);
+	        Print(128, "increment %d seconds.\n", (tc_increment / 1000) % 60);
 	    } else if (tc_sudden_death == 2) {
 	      Print(128, "%d moves/%d minutes primary time control\n", tc_moves,
-	          tc_time / 6000);
+	          tc_time / 60000);
 	      Print(128, "game/%d minutes secondary time control\n",
-	          tc_secondary_time / 6000);
+	          tc_secondary_time / 60000);
 	      if (tc_increment)
-	        Print(128, "increment %d seconds.\n", tc_increment / 100);
+	        Print(128, "increment %d seconds.\n", tc_increment / 1000);
 	    }
 	    Print(128, "book frequency (freq)..............%4.2f\n",
 	        book_weight_freq);
@@ -1138,6 +1226,64 @@ int Option(TREE * RESTRICT tree) {
 	    Print(128, "book learning (learn)..............%4.2f\n",
 	        book_weight_learn);
 	  }
+	/*
+	 ************************************************************
+	 *                                                          *
+	 *  "journal" controls the binary search journal (see       *
+	 *  journal.c).  "journal on [file=<prefix>] [events=N]"    *
+	 *  records every search from now on into one memory-       *
+	 *  mapped ring buffer of N events (default 1M, 16 bytes    *
+	 *  each) per thread, in <prefix>.0, <prefix>.1 and so on   *
+	 *  (default prefix crafty.jnl).  "journal off" stops it.   *
+	 *  "journal decode file=<file> [tree=P] [top=N] [depth=D]" *
+	 *  rebuilds the search tree from one thread's file and     *
+	 *  displays a per-ply summary, the hot path and the N      *
+	 *  largest subtrees with at most D plies of remaining      *
+	 *  depth (defaults 10 and 3), plus the tree itself to P    *
+	 *  plies if tree= is given.                                *
+	 *                                                          *
+	 ************************************************************
+	 */
+	  else if (OptionMatch("journal", *args)) {
+	    char *file = 0;
+	    int i, plies = 0, top = 10, depth = 3;
+	    uint64_t events = 1048576;
+
+	    if (thinking || pondering)
+	      return 2;
+	    nargs = ReadParse(buffer, args, " \t;=");
+	    for (i = 2; i < nargs - 1; i += 2) {
+	      if (!strcmp(args[i], "file"))
+	        file = args[i + 1];
+	      else if (!strcmp(args[i], "events"))
+	        events = atoiKMB(args[i + 1]);
+	      else if (!strcmp(args[i], "tree"))
+	        plies = atoi(args[i + 1]);
+	      else if (!strcmp(args[i], "top"))
+	        top = atoi(args[i + 1]);
+	      else if (!strcmp(args[i], "depth"))
+	        depth = atoi(args[i + 1]);
+	      else
+	        break;
+	    }
+	    if (nargs > 1 && i >= nargs && !strcmp(args[1], "on")) {
+	      if ((i = JournalOpen((file) ? file : "crafty.jnl", events)))
+	        Print(128, "journaling %d thread%s to %s.*\n", i,
+	            (i > 1) ? "s" : "", (file) ? file : "crafty.jnl");
+	    } else if (nargs > 1 && i >= nargs && !strcmp(args[1], "off")) {
+	      JournalClose();
+	      Print(128, "journal stopped\n");
+	    } else if (nargs > 1 && i >= nargs && !strcmp(args[1], "decode") &&
+	        file)
+	      JournalDecode(file, plies, top, depth);
+	    else {
+	      _printf("usage:  journal on [file=<prefix>] [events=N]\n");
+	      _printf("        journal off\n");
+	      _printf("        journal decode file=<file> [tree=P] [top=N]"
+	          " [depth=D]\n");
+	      return 1;
+	    }
+	  }
 	/*
 	 ************************************************************
 	 *                                                          *
@@ -1220,8 +1366,8 @@ int Option(TREE * RESTRICT tree) {
 	    tc_time = atoi(args[2]) * 60;
 	    if (strchr(args[2], ':'))
 	      tc_time = tc_time + atoi(strchr(args[2], ':') + 1);
-	    tc_time *= 100;
-	    tc_increment = atoi(args[3]) * 100;
+	    tc_time *= 1000;
+	    tc_increment = atof(args[3]) * 1000;
 	    tc_time_remaining[white] = tc_time;
 	    tc_time_remaining[black] = tc_time;
 	    if (!tc_moves) {
@@ -1239,15 +1385,15 @@ int Option(TREE * RESTRICT tree) {
 	    }
 	    if (!tc_sudden_death) {
 	      Print(128, "%d moves/%d seconds primary time control\n", tc_moves,
-	          tc_time / 100);
+	          tc_time / 1000);
 	      Print(128, "%d moves/%d seconds secondary time control\n",
-	          tc_secondary_moves, tc_secondary_time / 100);
+	          tc_secondary_moves, tc_secondary_time / 1000);
 	      if (tc_increment)
-	        Print(128, "increment %d seconds.\n", tc_increment / 100);
+	        Print(128, "increment %.2f seconds.\n", tc_increment / 1000.0);
 	    } else if (tc_sudden_death == 1) {
-	      Print(128, " game/%d seconds primary time control\n", tc_time / 100);
+	      Print(128, " game/%d seconds primary time control\n", tc_time / 1000);
 	      if (tc_increment)
-	        Print(128, "increment %d seconds.\n", tc_increment / 100);
+	        Print(128, "increment %.2f seconds.\n", tc_increment / 1000.0);
 	    }
 	    if (adaptive_hash) {
 	      float percent;
@@ -1255,7 +1401,7 @@ int Option(TREE * RESTRICT tree) {
 	      uint64_t positions_per_move;
 
 	      TimeSet(think);
-	      time_limit /= 100;
+	      time_limit /= 1000;
 	      positions_per_move = time_limit * adaptive_hash / 16;
 	      optimal_hash_size = positions_per_move * 16;
 	      _printf("optimal=%d\n", optimal_hash_size);
@@ -1697,6 +1843,21 @@ int Option(TREE * RESTRICT tree) {
 	        fclose(output_file);
 	    }
 	  }
+	/*
+	 ************************************************************
+	 *                                                          *
+	 *   "lockstats" displays the contention counters for the   *
+	 *   SMP spinlocks (acquisitions, contended acquisitions    *
+	 *   and the average spin count while contended).           *
+	 *   "lockstats clear" zeroes them before a test run.       *
+	 *                                                          *
+	 ************************************************************
+	 */
+	  else if (OptionMatch("lockstats", *args)) {
+	    if (thinking || pondering)
+	      return 2;
+	    ThreadLockStats(nargs > 1 && !strcmp(args[1], "clear"));
+	  }
 	/*
 	 ************************************************************
 	 *                                                          *
@@ -1769,6 +1930,28 @@ int Option(TREE * RESTRICT tree) {
 	    else if (mode == normal_mode)
 	      _printf("normal mode.\n");
 	  }
+	/*
+	 ************************************************************
+	 *                                                          *
+	 *   "multipv" command sets the number of best lines that   *
+	 *   the search keeps and displays for each depth.  The     *
+	 *   default of 1 is the normal search.  Larger values are  *
+	 *   mainly useful in analyze mode, where N lines are found *
+	 *   in one search that shares its hash table and history  *
+	 *   rather than N separate searches.  The move played is   *
+	 *   always the first line.                                 *
+	 *                                                          *
+	 ************************************************************
+	 */
+	  else if (OptionMatch("multipv", *args)) {
+	    if (nargs < 2) {
+	      _printf("usage:  multipv <n>\n");
+	      return 1;
+	    }
+	    multi_pv = Max(1, Min(atoi(args[1]), MAX_MULTIPV));
+	    Print(128, "search will keep the best %d line%s.\n", multi_pv,
+	        (multi_pv > 1) ? "s" : "");
+	  }
 	/*
 	 ************************************************************
 	 *                                                          *
@@ -1877,6 +2060,61 @@ int Option(TREE * RESTRICT tree) {
 	    NewGame(0);
 	    return 3;
 	  }
+	/*
+	 ************************************************************
+	 *                                                          *
+	 *  "nnue" selects the evaluation.  "nnue <file>" loads a   *
+	 *  network (see NnueLoad()) and uses it in place of the    *
+	 *  normal evaluation.  "nnue off" goes back to the normal  *
+	 *  evaluation and "nnue on" switches to the network that   *
+	 *  was loaded last.  "nnue test [depth]" checks the        *
+	 *  incremental updates and SIMD kernels against the plain  *
+	 *  C reference code (see NnueTest()).  "nnue" alone shows  *
+	 *  which evaluation is in use.  The line is re-parsed      *
+	 *  without '/' as a separator so a path can be given.      *
+	 *                                                          *
+	 ************************************************************
+	 */
+	  else if (OptionMatch("nnue", *args)) {
+	#if defined(NNUE)
+	    int errors;
+
+	    if (thinking || pondering)
+	      return 2;
+	    nargs = ReadParse(buffer, args, " \t;=");
+	    if (nargs > 1 && !strcmp(args[1], "off"))
+	      nnue_enabled = 0;
+	    else if (nargs > 1 && !strcmp(args[1], "on")) {
+	      if (!nnue_input_weights) {
+	        Print(4095, "ERROR.  no network loaded, use \"nnue <file>\"\n");
+	        return 1;
+	      }
+	      nnue_enabled = 1;
+	    } else if (nargs > 1 && !strcmp(args[1], "test")) {
+	      if (!nnue_enabled) {
+	        Print(4095, "ERROR.  nnue test requires \"nnue on\"\n");
+	        return 1;
+	      }
+	      tree->status[1] = tree->status[0];
+	      tree->last[0] = tree->move_list;
+	      errors = NnueTest(tree, 1, (nargs > 2) ? atoi(args[2]) : 3, game_wtm);
+	      Print(4095, "nnue test: %d errors\n", errors);
+	      return 1;
+	    } else if (nargs > 1) {
+	      if (!NnueLoad(args[1]))
+	        return 1;
+	      nnue_enabled = 1;
+	    }
+	    if (nnue_enabled)
+	      NnueRefresh(tree);
+	    Print(4095, "evaluation: %s", (nnue_enabled) ? "nnue" : "normal");
+	    if (nnue_input_weights)
+	      Print(4095, "  (network %s, %s kernels)", nnue_file, NNUE_KERNEL);
+	    Print(4095, "\n");
+	#else
+	    Print(4095, "ERROR.  nnue requires a -DNNUE build\n");
+	#endif
+	  }
 	/*
 	 ************************************************************
 	 *                                                          *
@@ -1894,9 +2132,9 @@ int Option(TREE * RESTRICT tree) {
 	      _printf("usage:  noise <n>\n");
 	      return 1;
 	    }
-	    noise_level = atof(args[1]) * 100;
+	    noise_level = atof(args[1]) * 1000;
 	    Print(128, "noise level set to %.2f seconds.\n",
-	        (float) noise_level / 100.0);
+	        (float) noise_level / 1000.0);
 	  }
 	/*
 	 ************************************************************
@@ -1947,9 +2185,9 @@ int Option(TREE * RESTRICT tree) {
 	      _printf("usage:  operator <seconds>\n");
 	      return 1;
 	    }
-	    tc_operator_time = ParseTime(args[1]) * 100;
+	    tc_operator_time = ParseTime(args[1]) * 1000;
 	    Print(128, "reserving %d seconds per move for operator overhead.\n",
-	        tc_operator_time / 100);
+	        tc_operator_time / 1000);
 	  }
 	/*
 	 ************************************************************
@@ -1965,8 +2203,8 @@ int Option(TREE * RESTRICT tree) {
 	      _printf("usage:  otime <time(unit=.01 secs))>\n");
 	      return 1;
 	    }
-	    tc_time_remaining[Flip(root_wtm)] = atoi(args[1]);
-	    if (log_file && time_limit > 99)
+	    tc_time_remaining[Flip(root_wtm)] = atoi(args[1]) * 10;
+	    if (log_file && time_limit > 999)
 	      fprintf(log_file, "time remaining: %s (opponent).\n",
 	          DisplayTime(tc_time_remaining[Flip(root_wtm)]));
 	    if (call_flag && xboard && tc_time_remaining[Flip(root_wtm)] < 1) {
@@ -2187,24 +2425,28 @@ int Option(TREE * RESTRICT tree) {
 	        personality_packet[param].value[i] = atoi(args[i + 2]);
 	    }
 	    InitializeKingSafety();
+	    InitializePieceSquare(tree);
 	  }
 	/*
 	 ************************************************************
 	 *                                                          *
-	 *  "bookpath", "logpath" and "tbpath" set the default      *
-	 *  paths to locate or save these files.                    *
+	 *  "bookpath", "logpath", "rcpath" and "tbpath" set the    *
+	 *  default paths to locate or save these files.  rcpath    *
+	 *  is where ReadRC() and "smptune save" find the rc file,  *
+	 *  the app passes its data directory, where wrapper.c has  *
+	 *  extracted crafty.rc.                                    *
 	 *                                                          *
 	 ************************************************************
 	 */
 	  else if (OptionMatch("logpath", *args) || OptionMatch("bookpath", *args)
-	      || OptionMatch("tbpath", *args)) {
+	      || OptionMatch("rcpath", *args) || OptionMatch("tbpath", *args)) {
 	    if (OptionMatch("logpath", *args) || OptionMatch("bookpath", *args)) {
 	      if (log_file)
 	        Print(4095, "ERROR -- this must be used on command line only\n");
 	    }
 	    nargs = ReadParse(buffer, args, " \t=");
 	    if (nargs < 2) {
-	      _printf("usage:  bookpath|perspath|logpath|tbpath <path>\n");
+	      _printf("usage:  bookpath|perspath|logpath|rcpath|tbpath <path>\n");
 	      return 1;
 	    }
 	    if (!strchr(args[1], '(')) {
@@ -2212,6 +2454,8 @@ int Option(TREE * RESTRICT tree) {
 	        strcpy(book_path, args[1]);
 	      else if (strstr(args[0], "logpath"))
 	        strcpy(log_path, args[1]);
+	      else if (strstr(args[0], "rcpath"))
+	        strncpy(rc_path, args[1], sizeof(rc_path) - 1);
 	#if !defined(NOEGTB)
 	      else if (strstr(args[0], "tbpath"))
 	        strcpy(tb_path, args[1]);
@@ -2283,36 +2527,44 @@ int Option(TREE * RESTRICT tree) {
 	/*
 	 ************************************************************
 	 *                                                          *
-	 *  "perft" command turns tests move generator/make_move.   *
+	 *  "perft <depth> [divide]" counts the leaf nodes of the   *
+	 *  full-width tree to <depth> plies, using smp_max_threads *
+	 *  threads, and displays the total, time and nodes per     *
+	 *  second.  "divide" also displays the count below each    *
+	 *  root move.  "perft suite [deep]" checks the counts for  *
+	 *  a set of positions with known answers (see              *
+	 *  PerftSuite()).  "perft hash <size>" sets the size of    *
+	 *  the perft hash table (default 16M, 0 turns it off.)     *
 	 *                                                          *
 	 ************************************************************
 	 */
 	  else if (OptionMatch("perft", *args)) {
-	    int i, clock_before, clock_after;
-	    float time_used;
+	    int depth;
 
 	    if (thinking || pondering)
 	      return 2;
-	    clock_before = clock();
-	    while (clock() == clock_before);
-	    clock_before = clock();
 	    if (nargs < 2) {
-	      _printf("usage:  perftest <depth>\n");
+	      Print(128, "usage:  perft <depth> [divide]\n");
+	      Print(128, "        perft suite [deep]\n");
+	      Print(128, "        perft hash <size>\n");
 	      return 1;
 	    }
-	    tree->status[1] = tree->status[0];
-	    tree->last[0] = tree->move_list;
-	    i = atoi(args[1]);
-	    if (i <= 0) {
-	      Print(128, "usage:  perft <maxply>\n");
-	      return 1;
+	    if (!strcmp(args[1], "suite"))
+	      PerftSuite(nargs > 2 && !strcmp(args[2], "deep"));
+	    else if (!strcmp(args[1], "hash")) {
+	      if (nargs > 2)
+	        perft_hash_bytes = atoiKMB(args[2]);
+	      Print(128, "perft hash table size=%s\n", (perft_hash_bytes >=
+	              sizeof(HASH_ENTRY)) ? DisplayKMB((1ull << MSB(perft_hash_bytes)),
+	              1) : "off");
+	    } else {
+	      depth = atoi(args[1]);
+	      if (depth <= 0) {
+	        Print(128, "usage:  perft <depth> [divide]\n");
+	        return 1;
+	      }
+	      Perft(tree, depth, nargs > 2 && !strcmp(args[2], "divide"));
 	    }
-	    total_moves = 0;
-	    OptionPerft(tree, 1, i, game_wtm);
-	    clock_after = clock();
-	    time_used =
-	        ((float) clock_after - (float) clock_before) / (float) CLOCKS_PER_SEC;
-	    _printf("total moves=%" PRIu64 "  time=%.2f\n", total_moves, time_used);
 	  }
 	/*
 	 ************************************************************
@@ -2391,6 +2643,33 @@ int Option(TREE * RESTRICT tree) {
 	  else if (!strcmp("playother", *args)) {
 	    force = 0;
 	  }
+	/*
+	 ************************************************************
+	 *                                                          *
+	 *  "pmu on|off" enables/disables the hardware performance  *
+	 *  counters (cycles, instructions, cache, branch and TLB   *
+	 *  misses) that bench and perft then report per position.  *
+	 *  Linux only, see PmuOpen().                              *
+	 *                                                          *
+	 ************************************************************
+	 */
+	  else if (OptionMatch("pmu", *args)) {
+	    if (nargs < 2) {
+	      _printf("usage:  pmu on|off\n");
+	      return 1;
+	    }
+	    if (!strcmp(args[1], "on")) {
+	      pmu_enabled = (PmuOpen() > 0);
+	      if (!pmu_enabled) {
+	        PmuClose();
+	        Print(4095, "pmu: no hardware counters available\n");
+	      }
+	    } else {
+	      pmu_enabled = 0;
+	      PmuClose();
+	    }
+	    Print(128, "hardware counters %s\n", (pmu_enabled) ? "on" : "off");
+	  }
 	/*
 	 ************************************************************
 	 *                                                          *
@@ -3020,9 +3299,9 @@ int Option(TREE * RESTRICT tree) {
 	      return 1;
 	    }
 	    tc_moves_remaining[white] = atoi(args[1]);
-	    tc_time_remaining[white] = ParseTime(args[2]) * 6000;
+	    tc_time_remaining[white] = ParseTime(args[2]) * 60000;
 	    tc_moves_remaining[black] = atoi(args[3]);
-	    tc_time_remaining[black] = ParseTime(args[4]) * 6000;
+	    tc_time_remaining[black] = ParseTime(args[4]) * 60000;
 	    Print(128, "time remaining: %s (white).\n",
 	        DisplayTime(tc_time_remaining[white]));
 	    Print(128, "time remaining: %s (black).\n",
@@ -3157,6 +3436,21 @@ int Option(TREE * RESTRICT tree) {
 	    Print(128, " %s", DisplayEvaluation(tb, 1));
 	    Print(128, " %s", DisplayEvaluation(mgb, 1));
 	    Print(128, " %s  |\n", DisplayEvaluation(egb, 1));
+	    mgb = -PcSqMG(black);
+	    egb = -PcSqEG(black);
+	    mgw = PcSqMG(white);
+	    egw = PcSqEG(white);
+	    tree->score_mg += mgw + mgb;
+	    tree->score_eg += egw + egb;
+	    tb = (mgb * phase + egb * (62 - phase)) / 62;
+	    tw = (mgw * phase + egw * (62 - phase)) / 62;
+	    Print(128, "piece/square...%s  |", DisplayEvaluation(tb + tw, 1));
+	    Print(128, " %s", DisplayEvaluation(tw, 1));
+	    Print(128, " %s", DisplayEvaluation(mgw, 1));
+	    Print(128, " %s  |", DisplayEvaluation(egw, 1));
+	    Print(128, " %s", DisplayEvaluation(tb, 1));
+	    Print(128, " %s", DisplayEvaluation(mgb, 1));
+	    Print(128, " %s  |\n", DisplayEvaluation(egb, 1));
 	    mgb = tree->score_mg;
 	    egb = tree->score_eg;
 	    EvaluateKnights(tree, black);
@@ -3371,7 +3665,8 @@ int Option(TREE * RESTRICT tree) {
 	 *   "smpmt" command is used to set the maximum number of   *
 	 *   parallel threads to use, assuming that Crafty was      *
 	 *   compiled with -DSMP.  This value can not be set        *
-	 *   larger than the compiled-in -DCPUS=n value.            *
+	 *   larger than the compiled-in -DCPUS=n value.  It also   *
+	 *   displays the CPU each thread will be bound to.         *
 	 *                                                          *
 	 *   "smpnice" command turns on "nice" mode where idle      *
 	 *   processors are terminated between searches to avoid    *
@@ -3386,6 +3681,20 @@ int Option(TREE * RESTRICT tree) {
 	 *   searched at any node before we can do a parallel split *
 	 *   to search the remaining moves there in parallel.       *
 	 *                                                          *
+	 *   "smpstats" displays the per-thread SMP counters from   *
+	 *   the last search (splits, joins, idle and join-wait     *
+	 *   time, lock wait time by class, aborts) as one JSON     *
+	 *   object per thread, for scripts that tune the smp*      *
+	 *   settings.                                              *
+	 *                                                          *
+	 *   "smptune [reps] [seconds]" tunes smpmin, smpsn and     *
+	 *   smpgroup for this machine by timing the bench          *
+	 *   positions (see AutoTune()) and saves the result to the *
+	 *   rc file.  "smptune on|off" enables/disables nudging    *
+	 *   smpmin and smpsn after each search from the SMP        *
+	 *   counters, and "smptune save" writes the current values *
+	 *   to the rc file.                                        *
+	 *                                                          *
 	 ************************************************************
 	 */
 	  else if (OptionMatch("smpmin", *args)) {
@@ -3427,6 +3736,7 @@ int Option(TREE * RESTRICT tree) {
 	    for (proc = 1; proc < CPUS; proc++)
 	      if (proc >= smp_max_threads)
 	        thread[proc].tree = (TREE *) - 1;
+	    ThreadPlacement();
 	  } else if (OptionMatch("smpnice", *args)) {
 	    if (nargs < 2) {
 	      _printf("usage:  smpnice 0|1\n");
@@ -3454,6 +3764,24 @@ int Option(TREE * RESTRICT tree) {
 	    }
 	    smp_split_nodes = atoi(args[1]);
 	    Print(128, "minimum nodes before a split %d.\n", smp_split_nodes);
+	  } else if (OptionMatch("smpstats", *args)) {
+	    if (thinking || pondering)
+	      return 2;
+	    ThreadStats(1);
+	  } else if (OptionMatch("smptune", *args)) {
+	    if (thinking || pondering)
+	      return 2;
+	    if (nargs > 1 && !strcmp(args[1], "on")) {
+	      smp_autotune = 1;
+	      Print(128, "SMP online tuning enabled.\n");
+	    } else if (nargs > 1 && !strcmp(args[1], "off")) {
+	      smp_autotune = 0;
+	      Print(128, "SMP online tuning disabled.\n");
+	    } else if (nargs > 1 && !strcmp(args[1], "save"))
+	      AutoTuneSave();
+	    else
+	      AutoTune((nargs > 1) ? atoi(args[1]) : 3,
+	          (nargs > 2) ? atoi(args[2]) : 3);
 	  }
 	/*
 	 ************************************************************
@@ -3507,9 +3835,27 @@ int Option(TREE * RESTRICT tree) {
 	      _printf("usage:  st <time>\n");
 	      return 1;
 	    }
-	    search_time_limit = atof(args[1]) * 100;
+	    search_time_limit = atof(args[1]) * 1000;
 	    Print(128, "search time set to %.2f.\n",
-	        (float) search_time_limit / 100.0);
+	        (float) search_time_limit / 1000.0);
+	  }
+	/*
+	 ************************************************************
+	 *                                                          *
+	 *  "stats [json]" displays the search counters from the    *
+	 *  last search:  moves searched and cutoffs by move        *
+	 *  ordering phase, moves generated versus searched, the    *
+	 *  qsearch/full-width node ratio and the lazy evaluation   *
+	 *  exit rate (see SearchStats()).  "json" prints one JSON  *
+	 *  object per thread instead.  Note:  this requires        *
+	 *  -DSTATS as an option when building Crafty.              *
+	 *                                                          *
+	 ************************************************************
+	 */
+	  else if (OptionMatch("stats", *args)) {
+	    if (thinking || pondering)
+	      return 2;
+	    SearchStats(nargs > 1 && !strcmp(args[1], "json"));
 	  }
 	/*
 	 ************************************************************
@@ -3521,7 +3867,7 @@ int Option(TREE * RESTRICT tree) {
 	 */
 	  else if (OptionMatch("surplus", *args)) {
 	    if (nargs == 2)
-	      tc_safety_margin = atoi(args[1]) * 6000;
+	      tc_safety_margin = atoi(args[1]) * 60000;
 	    Print(128, "time surplus set to %s.\n", DisplayTime(tc_safety_margin));
 	  }
 	/*
@@ -3567,27 +3913,35 @@ int Option(TREE * RESTRICT tree) {
 	 ************************************************************
 	 *                                                          *
 	 *  "test" command runs a test suite of problems and        *
-	 *  displays results.                                       *
+	 *  displays results.  "workers=N" searches N positions at  *
+	 *  a time (see Test() and BatchAnalyze()).  Otherwise, and *
+	 *  always on Android, each position is searched using the  *
+	 *  "mt" threads.                                           *
 	 *                                                          *
 	 ************************************************************
 	 */
-#if defined(TEST)
 	  else if (OptionMatch("test", *args)) {
+	    int i, workers = 1;
+
 	    nargs = ReadParse(buffer, args, "\t ;=");
 	    if (thinking || pondering)
 	      return 2;
 	    if (nargs < 2) {
-	      _printf("usage:  test <filename> [exitcnt]\n");
+	      _printf("usage:  test <filename> [exitcnt] [workers=N]\n");
+	      _printf("        workers=1 (or Android) uses mt threads\n");
 	      return 1;
 	    }
-	    if (nargs > 2)
-	      early_exit = atoi(args[2]);
-	    Test(args[1]);
+	    for (i = 2; i < nargs; i++)
+	      if (!strcmp(args[i], "workers") && i + 1 < nargs)
+	        workers = atoi(args[++i]);
+	      else
+	        early_exit = atoi(args[i]);
+	    Test(args[1], workers);
+	    early_exit = 99;
 	    ponder_move = 0;
 	    last_pv.pathd = 0;
 	    last_pv.pathl = 0;
 	  }
-#endif
 	/*
 	 ************************************************************
 	 *                                                          *
@@ -3621,21 +3975,21 @@ int Option(TREE * RESTRICT tree) {
 	 */
 	  else if (OptionMatch("time", *args)) {
 	    if (xboard) {
-	      tc_time_remaining[root_wtm] = atoi(args[1]);
-	      if (log_file && time_limit > 99)
+	      tc_time_remaining[root_wtm] = atoi(args[1]) * 10;
+	      if (log_file && time_limit > 999)
 	        fprintf(log_file, "time remaining: %s (Crafty).\n",
 	            DisplayTime(tc_time_remaining[root_wtm]));
 	    } else {
 	      if (thinking || pondering)
 	        return 2;
 	      tc_moves = 60;
-	      tc_time = 180000;
+	      tc_time = 1800000;
 	      tc_moves_remaining[white] = 60;
 	      tc_moves_remaining[black] = 60;
-	      tc_time_remaining[white] = 180000;
-	      tc_time_remaining[black] = 180000;
+	      tc_time_remaining[white] = 1800000;
+	      tc_time_remaining[black] = 1800000;
 	      tc_secondary_moves = 60;
-	      tc_secondary_time = 180000;
+	      tc_secondary_time = 1800000;
 	      tc_increment = 0;
 	      tc_sudden_death = 0;
 	/*
@@ -3648,7 +4002,7 @@ int Option(TREE * RESTRICT tree) {
 	        }
 	      if (nargs > 2) {
 	        tc_moves = atoi(args[1]);
-	        tc_time = atoi(args[2]) * 100;
+	        tc_time = atoi(args[2]) * 1000;
 	      }
 	/*
 	 now let's pick off the secondary time control (moves/minutes)
@@ -3661,32 +4015,32 @@ int Option(TREE * RESTRICT tree) {
 	          tc_secondary_moves = 1000;
 	        } else
 	          tc_secondary_moves = atoi(args[3]);
-	        tc_secondary_time = atoi(args[4]) * 100;
+	        tc_secondary_time = atoi(args[4]) * 1000;
 	      }
 	      if (nargs > 5)
-	        tc_increment = atoi(args[5]) * 100;
+	        tc_increment = atof(args[5]) * 1000;
 	      tc_time_remaining[white] = tc_time;
 	      tc_time_remaining[black] = tc_time;
 	      tc_moves_remaining[white] = tc_moves;
 	      tc_moves_remaining[black] = tc_moves;
 	      if (!tc_sudden_death) {
 	        Print(128, "%d moves/%d minutes primary time control\n", tc_moves,
-	            tc_time / 100);
+	            tc_time / 1000);
 	        Print(128, "%d moves/%d minutes secondary time control\n",
-	            tc_secondary_moves, tc_secondary_time / 100);
+	            tc_secondary_moves, tc_secondary_time / 1000);
 	        if (tc_increment)
-	          Print(128, "increment %d seconds.\n", tc_increment / 100);
+	          Print(128, "increment %.2f seconds.\n", tc_increment / 1000.0);
 	      } else if (tc_sudden_death == 1) {
-	        Print(128, " game/%d minutes primary time control\n", tc_time / 100);
+	        Print(128, " game/%d minutes primary time control\n", tc_time / 1000);
 	        if (tc_increment)
-	          Print(128, "increment %d seconds.\n", tc_increment / 100);
+	          Print(128, "increment %.2f seconds.\n", tc_increment / 1000.0);
 	      } else if (tc_sudden_death == 2) {
 	        Print(128, "%d moves/%d minutes primary time control\n", tc_moves,
-	            tc_time / 100);
+	            tc_time / 1000);
 	        Print(128, "game/%d minutes secondary time control\n",
-	            tc_secondary_time / 100);
+	            tc_secondary_time / 1000);
 	        if (tc_increment)
-	          Print(128, "increment %d seconds.\n", tc_increment / 100);
+	          Print(128, "increment %.2f seconds.\n", tc_increment / 1000.0);
 	      }
 	      tc_time *= 60;
 	      tc_time_remaining[white] *= 60;
@@ -3971,38 +4325,3 @@ int OptionMatch(char *command, char *input) {
     return 1;
   return 0;
 }
-void OptionPerft(TREE * RESTRICT tree, int ply, int depth, int wtm) {
-  int *mv;
-#if defined(TRACE)
-  static char line[256];
-  static char move[16], *p[64];
-#endif
-  tree->last[ply] = GenerateCaptures(tree, ply, wtm, tree->last[ply - 1]);
-  for (mv = tree->last[ply - 1]; mv < tree->last[ply]; mv++)
-    if (Captured(*mv) == king)
-      return;
-  tree->last[ply] = GenerateNoncaptures(tree, ply, wtm, tree->last[ply]);
-#if defined(TRACE)
-  p[1] = line;
-#endif
-  for (mv = tree->last[ply - 1]; mv < tree->last[ply]; mv++) {
-#if defined(TRACE)
-    strcpy(move, OutputMove(tree, *mv, ply, wtm));
-#endif
-    MakeMove(tree, ply, *mv, wtm);
-#if defined(TRACE)
-    if (ply <= trace_level) {
-      strcpy(p[ply], move);
-      strcpy(line + strlen(line), " ");
-      p[ply + 1] = line + strlen(line);
-      if (ply == trace_level)
-        _printf("%s\n", line);
-    }
-#endif
-    if (depth - 1)
-      OptionPerft(tree, ply + 1, depth - 1, Flip(wtm));
-    else if (!Check(wtm))
-      total_moves++;
-    UnmakeMove(tree, ply, *mv, wtm);
-  }
-}
@@ -0,0 +1,380 @@
+#include "chess.h"
+#include "data.h"
+/* last modified 10/19/26 */
+/*
+ *******************************************************************************
+ *                                                                             *
+ *   Perft() counts the leaf nodes of the full-width tree below the current    *
+ *   position to "depth" plies.  The counts are known exactly for many         *
+ *   positions, which makes this the standard test of the move generator,      *
+ *   make/unmake and legality code, and the nodes per second it reports is a   *
+ *   useful benchmark of the same code with no evaluation or search overhead.  *
+ *                                                                             *
+ *   The legal root moves are generated once and handed out one at a time to   *
+ *   smp_max_threads workers (see PerftThread()), each of which searches the   *
+ *   subtree below its move using its own split block.  The per-move counts    *
+ *   are saved so that "divide" can print them, which is how a bad count is    *
+ *   tracked down to the move (and then the position) that causes it.          *
+ *                                                                             *
+ *   "divide" is 1 to print the count for each root move, 0 to print only the  *
+ *   total and -1 to print nothing (used by PerftSuite()).  The return value   *
+ *   is the total leaf count.  With "pmu on" the hardware counters are read    *
+ *   around the count and displayed per leaf node.                             *
+ *                                                                             *
+ *******************************************************************************
+ */
+uint64_t Perft(TREE * RESTRICT tree, int depth, int divide) {
+  TREE *worker;
+  uint64_t total = 0, counts[PMU_COUNTERS];
+  unsigned int start, elapsed;
+  int *mv, i, threads = 1, valid = 0;
+#if (CPUS > 1) && defined(UNIX)
+  pthread_t workers[CPUS];
+  long t;
+#endif
+
+/*
+ ************************************************************
+ *                                                          *
+ *  Generate the legal root moves, and set up the hash      *
+ *  table (which is cleared so that repeated runs take the  *
+ *  same time.)                                             *
+ *                                                          *
+ ************************************************************
+ */
+  PerftHashInit();
+  if (pmu_enabled && divide >= 0)
+    PmuStart();
+  start = ReadClock();
+  tree->status[1] = tree->status[0];
+  tree->last[0] = tree->move_list;
+  tree->last[1] = GenerateCaptures(tree, 1, game_wtm, tree->last[0]);
+  tree->last[1] = GenerateNoncaptures(tree, 1, game_wtm, tree->last[1]);
+  GenerateLegalMasks(tree, 1, game_wtm);
+  perft_nmoves = 0;
+  for (mv = tree->last[0]; mv < tree->last[1]; mv++)
+    if (LegalMove(tree, 1, game_wtm, *mv)) {
+      perft_moves[perft_nmoves] = *mv;
+      perft_counts[perft_nmoves++] = 1;
+    }
+  perft_next = 0;
+  perft_depth = depth;
+  perft_wtm = game_wtm;
+/*
+ ************************************************************
+ *                                                          *
+ *  Start the workers.  Any search threads left spinning in *
+ *  ThreadWait() are terminated first (they are restarted   *
+ *  by the next search) since they would otherwise compete  *
+ *  with the perft threads for the same processors.         *
+ *                                                          *
+ ************************************************************
+ */
+  if (depth > 1) {
+#if (CPUS > 1) && defined(UNIX)
+    threads = Max(Min(Min(smp_max_threads, CPUS), perft_nmoves), 1);
+#endif
+    for (i = 0; i < threads; i++) {
+      worker = block[i * MAX_BLOCKS_PER_CPU + 1];
+      worker->position = tree->position;
+      worker->status[1] = tree->status[1];
+      worker->last[1] = worker->move_list;
+    }
+#if (CPUS > 1) && defined(UNIX)
+    if (threads > 1 && smp_threads) {
+      for (t = 1; t < CPUS; t++)
+        thread[t].tree = (TREE *) - 1;
+      while (smp_threads)
+        Pause();
+      smp_idle = 0;
+      smp_split = 0;
+    }
+    for (t = 1; t < threads; t++)
+      pthread_create(&workers[t], 0, PerftThread, (void *) t);
+#endif
+    PerftThread((void *) 0);
+#if (CPUS > 1) && defined(UNIX)
+    for (t = 1; t < threads; t++)
+      pthread_join(workers[t], 0);
+#  if defined(AFFINITY)
+    for (t = 1; t < threads; t++)
+      if (smp_bind_error[t])
+        Print(4095, "ERROR, unable to bind perft thread %d to cpu %d (%s)\n",
+            (int) t, smp_affinity[t], strerror(smp_bind_error[t]));
+#  endif
+#endif
+  }
+  for (i = 0; i < perft_nmoves; i++)
+    total += perft_counts[i];
+  total_moves = total;
+  elapsed = Max(ReadClock() - start, 1);
+  if (pmu_enabled && divide >= 0)
+    valid = PmuStop(counts);
+/*
+ ************************************************************
+ *                                                          *
+ *  Display the results.                                    *
+ *                                                          *
+ ************************************************************
+ */
+  if (divide > 0)
+    for (i = 0; i < perft_nmoves; i++)
+      Print(4095, "  %-8s %" PRIu64 "\n", OutputMove(tree, perft_moves[i], 1,
+              game_wtm), perft_counts[i]);
+  if (divide >= 0) {
+    Print(4095, "total moves=%" PRIu64 "  time=%.2f\n", total,
+        (float) elapsed / 1000.0);
+    Print(4095, "nodes per second=%s  threads=%d  ",
+        DisplayKMB(total * 1000 / elapsed, 0), threads);
+    Print(4095, "hash=%s\n", (perft_hash_table_size) ?
+        DisplayKMB(perft_hash_table_size * sizeof(HASH_ENTRY), 1) : "off");
+    if (pmu_enabled)
+      PmuDisplay("", counts, valid, total);
+  }
+  return total;
+}
+
+/* last modified 10/19/26 */
+/*
+ *******************************************************************************
+ *                                                                             *
+ *   PerftThread() is the body of each perft worker.  It takes the next        *
+ *   unclaimed root move, makes it on its own split block and counts the       *
+ *   subtree below it, until the root move list is exhausted.  Thread 0 is     *
+ *   the thread that issued the command.  A new thread inherits thread 0's     *
+ *   single-CPU affinity mask, so with -DAFFINITY each worker first binds      *
+ *   itself to smp_affinity[tid] as ThreadInit() does, otherwise they would    *
+ *   all share one core.                                                       *
+ *                                                                             *
+ *******************************************************************************
+ */
+void *STDCALL PerftThread(void *tid) {
+  TREE *const tree = block[(long) tid * MAX_BLOCKS_PER_CPU + 1];
+  int i;
+#if defined(AFFINITY) && (CPUS > 1)
+  cpu_set_t cpuset;
+
+  if (tid) {
+    CPU_ZERO(&cpuset);
+    CPU_SET(smp_affinity[(long) tid], &cpuset);
+    smp_bind_error[(long) tid] =
+        (sched_setaffinity(0, sizeof(cpu_set_t), &cpuset)) ? errno : 0;
+  }
+#endif
+  while (1) {
+#if (CPUS > 1)
+    Lock(lock_perft);
+#endif
+    i = perft_next++;
+#if (CPUS > 1)
+    Unlock(lock_perft);
+#endif
+    if (i >= perft_nmoves)
+      break;
+    MakeMove(tree, 1, perft_moves[i], perft_wtm);
+    perft_counts[i] = PerftNodes(tree, 2, perft_depth - 1, Flip(perft_wtm));
+    UnmakeMove(tree, 1, perft_moves[i], perft_wtm);
+  }
+  return 0;
+}
+
+/* last modified 10/18/26 */
+/*
+ *******************************************************************************
+ *                                                                             *
+ *   PerftNodes() is the recursive part of perft.  Two things make it much     *
+ *   faster than the obvious make/count/unmake at every node:                  *
+ *                                                                             *
+ *   (1) bulk counting.  One ply from the leaves, the legal moves are simply   *
+ *       counted with LegalMove() rather than made and unmade, since making    *
+ *       the move tells us nothing we need.                                    *
+ *                                                                             *
+ *   (2) a perft hash table.  Transpositions are very common in a full-width   *
+ *       tree, so the count for each position (and remaining depth) is stored  *
+ *       and reused.  The table uses the same lockless scheme as the search    *
+ *       hash (word1 = key ^ word2) so that all threads share it with no       *
+ *       locking;  an entry torn by two simultaneous stores simply fails the   *
+ *       key test and is treated as a miss.  word2 holds the count in the      *
+ *       upper 56 bits and the depth in the lower 8, and every store replaces  *
+ *       whatever was there.                                                   *
+ *                                                                             *
+ *******************************************************************************
+ */
+uint64_t PerftNodes(TREE * RESTRICT tree, int ply, int depth, int wtm) {
+  HASH_ENTRY *entry = 0;
+  uint64_t key = 0, word2, nodes = 0;
+  int *mv;
+
+  if (depth <= 0)
+    return 1;
+  if (depth > 1 && perft_hash_table_size) {
+    key = (wtm) ? HashKey : ~HashKey;
+    entry = perft_hash_table + (key & perft_hash_mask);
+    word2 = entry->word2;
+    if ((entry->word1 ^ word2) == key && (int) (word2 & 255) == depth)
+      return word2 >> 8;
+  }
+  tree->last[ply] = GenerateCaptures(tree, ply, wtm, tree->last[ply - 1]);
+  tree->last[ply] = GenerateNoncaptures(tree, ply, wtm, tree->last[ply]);
+  GenerateLegalMasks(tree, ply, wtm);
+  if (depth == 1) {
+    for (mv = tree->last[ply - 1]; mv < tree->last[ply]; mv++)
+      nodes += LegalMove(tree, ply, wtm, *mv);
+    return nodes;
+  }
+  for (mv = tree->last[ply - 1]; mv < tree->last[ply]; mv++) {
+    if (!LegalMove(tree, ply, wtm, *mv))
+      continue;
+    MakeMove(tree, ply, *mv, wtm);
+    nodes += PerftNodes(tree, ply + 1, depth - 1, Flip(wtm));
+    UnmakeMove(tree, ply, *mv, wtm);
+  }
+  if (entry) {
+    word2 = (nodes << 8) | depth;
+    entry->word1 = key ^ word2;
+    entry->word2 = word2;
+  }
+  return nodes;
+}
+
+/* last modified 10/18/26 */
+/*
+ *******************************************************************************
+ *                                                                             *
+ *   PerftHashInit() (re)allocates the perft hash table if "perft hash" has    *
+ *   changed its size since the last run, and clears it.  A size of zero       *
+ *   turns the table off.                                                      *
+ *                                                                             *
+ *******************************************************************************
+ */
+void PerftHashInit(void) {
+  size_t entries = 0, i;
+
+  if (perft_hash_bytes >= sizeof(HASH_ENTRY))
+    entries = (1ull << MSB(perft_hash_bytes)) / sizeof(HASH_ENTRY);
+  if (entries != perft_hash_table_size) {
+    if (!entries)
+      perft_hash_table_size = 0;
+    else {
+      if (perft_hash_table)
+        AlignedRemalloc((void *) ((void *) &perft_hash_table), 64,
+            sizeof(HASH_ENTRY) * entries);
+      else
+        AlignedMalloc((void *) ((void *) &perft_hash_table), 64,
+            sizeof(HASH_ENTRY) * entries);
+      if (!perft_hash_table) {
+        Print(4095, "ERROR.  not enough memory for perft hash table.\n");
+        entries = 0;
+      }
+      perft_hash_table_size = entries;
+      perft_hash_mask = entries - 1;
+    }
+  }
+  for (i = 0; i < perft_hash_table_size; i++) {
+    perft_hash_table[i].word1 = 0;
+    perft_hash_table[i].word2 = 0;
+  }
+}
+
+/* last modified 10/18/26 */
+/*
+ *******************************************************************************
+ *                                                                             *
+ *   PerftSuite() runs perft on a set of positions with published node counts  *
+ *   and reports any that do not match.  The positions are the usual ones      *
+ *   (the initial position, "kiwipete", and several that exercise en passant,  *
+ *   castling, promotions and discovered/pinned checks) plus short endgames    *
+ *   chosen because they catch specific move generator bugs.  The normal run   *
+ *   takes a few seconds;  "deep" adds one more ply to the six main positions  *
+ *   and takes a few minutes, so it is more useful as a benchmark.             *
+ *                                                                             *
+ *******************************************************************************
+ */
+void PerftSuite(int deep) {
+  TREE *const tree = block[0];
+  static const struct {
+    char *fen;
+    int depth;
+    uint64_t nodes;
+    int deep;
+  } suite[] = {
+    {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 5,
+          4865609ull, 0},
+    {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 6,
+          119060324ull, 1},
+    {"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 4,
+          4085603ull, 0},
+    {"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 5,
+          193690690ull, 1},
+    {"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 5, 674624ull, 0},
+    {"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 6, 11030083ull, 1},
+    {"r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 4,
+          422333ull, 0},
+    {"r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 5,
+          15833292ull, 1},
+    {"rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 4,
+          2103487ull, 0},
+    {"rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 5,
+          89941194ull, 1},
+    {"r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+          4, 3894594ull, 0},
+    {"r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+          5, 164075551ull, 1},
+    {"3k4/3p4/8/K1P4r/8/8/8/8 b - - 0 1", 6, 1134888ull, 0},
+    {"8/8/1k6/2b5/2pP4/8/5K2/8 b - d3 0 1", 6, 1440467ull, 0},
+    {"8/5bk1/8/2Pp4/8/1K6/8/8 w - d6 0 1", 6, 824064ull, 0},
+    {"8/8/4k3/8/2p5/8/B2P2K1/8 w - - 0 1", 6, 1015133ull, 0},
+    {"5k2/8/8/8/8/8/8/4K2R w K - 0 1", 6, 661072ull, 0},
+    {"3k4/8/8/8/8/8/8/R3K3 w Q - 0 1", 6, 803711ull, 0},
+    {"r3k2r/1b4bq/8/8/8/8/7B/R3K2R w KQkq - 0 1", 4, 1274206ull, 0},
+    {"r3k2r/8/3Q4/8/8/5q2/8/R3K2R b KQkq - 0 1", 4, 1720476ull, 0},
+    {"2K2r2/4P3/8/8/8/8/8/3k4 w - - 0 1", 6, 3821001ull, 0},
+    {"8/8/1P2K3/8/2n5/1q6/8/5k2 b - - 0 1", 5, 1004658ull, 0},
+    {"4k3/1P6/8/8/8/8/K7/8 w - - 0 1", 6, 217342ull, 0},
+    {"8/P1k5/K7/8/8/8/8/8 w - - 0 1", 6, 92683ull, 0},
+    {"K1k5/8/P7/8/8/8/8/8 w - - 0 1", 6, 2217ull, 0},
+    {"8/k1P5/8/1K6/8/8/8/8 w - - 0 1", 7, 567584ull, 0},
+    {"8/8/2k5/5q2/5n2/8/5K2/8 b - - 0 1", 4, 23527ull, 0},
+    {NULL, 0, 0, 0}
+  };
+  uint64_t nodes, total = 0, counts[PMU_COUNTERS], pmu[PMU_COUNTERS];
+  unsigned int start, elapsed, total_time = 0;
+  int pos, run = 0, failed = 0, valid = (1 << PMU_COUNTERS) - 1, i;
+
+  Print(4095, "perft suite:\n");
+  memset(pmu, 0, sizeof(pmu));
+  for (pos = 0; suite[pos].fen; pos++) {
+    if (suite[pos].deep && !deep)
+      continue;
+    strcpy(buffer, suite[pos].fen);
+    nargs = ReadParse(buffer, args, " \t;=");
+    SetBoard(tree, nargs, args, 0);
+    start = ReadClock();
+    if (pmu_enabled)
+      PmuStart();
+    nodes = Perft(tree, suite[pos].depth, -1);
+    if (pmu_enabled) {
+      valid &= PmuStop(counts);
+      for (i = 0; i < PMU_COUNTERS; i++)
+        pmu[i] += counts[i];
+    }
+    elapsed = ReadClock() - start;
+    total += nodes;
+    total_time += elapsed;
+    run++;
+    if (nodes != suite[pos].nodes)
+      failed++;
+    Print(4095, "  %2d  %-4s depth=%d  nodes=%-12" PRIu64 " %s\n", run,
+        (nodes == suite[pos].nodes) ? "ok" : "FAIL", suite[pos].depth, nodes,
+        DisplayTime(elapsed));
+    if (nodes != suite[pos].nodes)
+      Print(4095, "      %s  expected %" PRIu64 "\n", suite[pos].fen,
+          suite[pos].nodes);
+  }
+  Print(4095, "%d positions, %d failed, %" PRIu64 " nodes  time=%s  nps=%s\n",
+      run, failed, total, DisplayTime(total_time),
+      DisplayKMB(total * 1000 / Max(total_time, 1), 0));
+  if (pmu_enabled)
+    PmuDisplay("", pmu, valid, total);
+  NewGame(0);
+}
@@ -0,0 +1,203 @@
+#include "chess.h"
+#include "data.h"
+#if defined(UNIX) && defined(__linux__)
+#  include <errno.h>
+#  include <unistd.h>
+#  include <sys/ioctl.h>
+#  include <sys/syscall.h>
+#  include <linux/perf_event.h>
+#endif
+/* last modified 10/18/26 */
+/*
+ *******************************************************************************
+ *                                                                             *
+ *   PmuOpen() opens the hardware performance counters used by "pmu on" (see   *
+ *   Option()), one perf_event_open() counter per event:  cycles,              *
+ *   instructions, L1D read misses, last-level cache misses, branch misses     *
+ *   and dTLB read misses.  Each counter is opened on its own rather than as a *
+ *   group, so a CPU or VM that lacks one or two of them still provides the    *
+ *   rest.  Only user-mode events are counted, which is what a normal          *
+ *   perf_event_paranoid setting allows.                                       *
+ *                                                                             *
+ *   The counters follow the thread that opened them, and threads it creates   *
+ *   later (inherit) whose counts are added in when they exit.  That covers    *
+ *   perft's worker threads, but the search threads live from one search to    *
+ *   the next, so for "bench" the counts are those of the main thread, which   *
+ *   is exact with mt=1.                                                       *
+ *                                                                             *
+ *   Returns the number of counters available (0 if none, or on a system       *
+ *   without perf_event_open()).                                               *
+ *                                                                             *
+ *******************************************************************************
+ */
+int PmuOpen(void) {
+#if defined(UNIX) && defined(__linux__)
+  static const uint32_t types[PMU_COUNTERS] = {
+    PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE,
+    PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE
+  };
+  static const uint64_t configs[PMU_COUNTERS] = {
+    PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+        (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+    PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES,
+    PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+        (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)
+  };
+  struct perf_event_attr attr;
+  int i, available = 0;
+
+  for (i = 0; i < PMU_COUNTERS; i++) {
+    if (pmu_fd[i] < 0) {
+      memset(&attr, 0, sizeof(attr));
+      attr.size = sizeof(attr);
+      attr.type = types[i];
+      attr.config = configs[i];
+      attr.disabled = 1;
+      attr.inherit = 1;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      attr.read_format =
+          PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+      pmu_fd[i] = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+      if (pmu_fd[i] < 0)
+        Print(4095, "pmu: %s unavailable (%s)\n", pmu_names[i],
+            strerror(errno));
+    }
+    if (pmu_fd[i] >= 0)
+      available++;
+  }
+  return available;
+#else
+  Print(4095, "pmu: hardware counters are not supported on this system\n");
+  return 0;
+#endif
+}
+
+/* last modified 10/18/26 */
+/*
+ *******************************************************************************
+ *                                                                             *
+ *   PmuClose() closes whatever counters PmuOpen() opened.                     *
+ *                                                                             *
+ *******************************************************************************
+ */
+void PmuClose(void) {
+#if defined(UNIX) && defined(__linux__)
+  int i;
+
+  for (i = 0; i < PMU_COUNTERS; i++)
+    if (pmu_fd[i] >= 0) {
+      close(pmu_fd[i]);
+      pmu_fd[i] = -1;
+    }
+#endif
+}
+
+/* last modified 10/18/26 */
+/*
+ *******************************************************************************
+ *                                                                             *
+ *   PmuDisplay() prints the metrics derived from one set of counts:           *
+ *   instructions per cycle, and each kind of miss per node ("nodes" is        *
+ *   whatever the caller counts, search nodes for bench, leaf nodes for        *
+ *   perft).  Counters that were not available are shown as "n/a".             *
+ *                                                                             *
+ *******************************************************************************
+ */
+void PmuDisplay(char *label, uint64_t * counts, int valid, uint64_t nodes) {
+  int i;
+
+  Print(4095, "%s", label);
+  if ((valid & (1 << PMU_CYCLES)) && (valid & (1 << PMU_INSTRUCTIONS)))
+    Print(4095, "IPC=%.2f", (double) counts[PMU_INSTRUCTIONS] /
+        Max(counts[PMU_CYCLES], 1));
+  else
+    Print(4095, "IPC=n/a");
+  for (i = PMU_L1D_MISSES; i < PMU_COUNTERS; i++)
+    if (valid & (1 << i))
+      Print(4095, "  %s/node=%.3f", pmu_names[i], (double) counts[i] /
+          Max(nodes, 1));
+    else
+      Print(4095, "  %s/node=n/a", pmu_names[i]);
+  Print(4095, "\n");
+}
+
+/* last modified 10/18/26 */
+/*
+ *******************************************************************************
+ *                                                                             *
+ *   PmuStart() zeroes the counters and starts them.                           *
+ *                                                                             *
+ *******************************************************************************
+ */
+void PmuStart(void) {
+#if defined(UNIX) && defined(__linux__)
+  int i;
+
+  for (i = 0; i < PMU_COUNTERS; i++)
+    if (pmu_fd[i] >= 0) {
+      ioctl(pmu_fd[i], PERF_EVENT_IOC_RESET, 0);
+      ioctl(pmu_fd[i], PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+}
+
+/* last modified 10/18/26 */
+/*
+ *******************************************************************************
+ *                                                                             *
+ *   PmuStop() stops the counters and reads them into counts[].  If the kernel *
+ *   had to multiplex the counters (more events than the CPU has registers)    *
+ *   each count is scaled up by the fraction of the time it was actually       *
+ *   counting.  The return value is a mask with bit i set if counts[i] is      *
+ *   valid.  A counter that never ran or counted nothing at all is not, since  *
+ *   that is what many virtual machines do:  the open succeeds but the         *
+ *   counters always read zero.                                                *
+ *                                                                             *
+ *******************************************************************************
+ */
+int PmuStop(uint64_t * counts) {
+  int i, valid = 0;
+#if defined(UNIX) && defined(__linux__)
+  uint64_t values[3];
+
+  for (i = 0; i < PMU_COUNTERS; i++)
+    if (pmu_fd[i] >= 0)
+      ioctl(pmu_fd[i], PERF_EVENT_IOC_DISABLE, 0);
+#endif
+  for (i = 0; i < PMU_COUNTERS; i++) {
+    counts[i] = 0;
+#if defined(UNIX) && defined(__linux__)
+    if (pmu_fd[i] < 0 || read(pmu_fd[i], values, sizeof(values)) !=
+        sizeof(values) || !values[2] || !values[0])
+      continue;
+    counts[i] = (values[2] < values[1]) ?
+        (uint64_t) ((double) values[0] * values[1] / values[2]) : values[0];
+    valid |= 1 << i;
+#endif
+  }
+  return valid;
+}
+
+/* last modified 10/18/26 */
+/*
+ *******************************************************************************
+ *                                                                             *
+ *   PmuWrite() appends the valid counts as a "pmu" member of a JSON object    *
+ *   (for example ,"pmu":{"cycles":123,"instructions":456}).                   *
+ *                                                                             *
+ *******************************************************************************
+ */
+void PmuWrite(FILE * output, uint64_t * counts, int valid) {
+  int i, first = 1;
+
+  fprintf(output, ",\"pmu\":{");
+  for (i = 0; i < PMU_COUNTERS; i++)
+    if (valid & (1 << i)) {
+      fprintf(output, "%s\"%s\":%" PRIu64, (first) ? "" : ",", pmu_names[i],
+          counts[i]);
+      first = 0;
+    }
+  fprintf(output, "}");
+}
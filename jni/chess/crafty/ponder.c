@@ -1,6 +1,6 @@
 #include "chess.h"
 #include "data.h"
-/* last modified 02/23/14 */
+/* last modified 10/18/26 */
 /*
  *******************************************************************************
  *                                                                             *
@@ -91,7 +91,7 @@ int Ponder(int wtm) {
  */
   if (!ponder_move) {
     TimeSet(puzzle);
-    if (time_limit < 20)
+    if (time_limit < 200)
       return 0;
     puzzling = 1;
     tree->status[1] = tree->status[0];
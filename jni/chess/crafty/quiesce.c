@@ -1,6 +1,6 @@
 #include "chess.h"
 #include "data.h"
-/* last modified 09/21/14 */
+/* last modified 10/19/26 */
 /*
  *******************************************************************************
  *                                                                             *
@@ -40,13 +40,21 @@
  *   width search to escape checks and do not allow a stand-pat which would    *
  *   hide the effect of the check completely.                                  *
  *                                                                             *
+ *   (5) Legality.  At the first ply (checks != 0) each move is tested with    *
+ *   LegalMove() before it is made.  Deeper in the q-search we don't test at   *
+ *   all.  An illegal capture simply lets the opponent capture our king at     *
+ *   the next ply, which is noticed as soon as captures are generated there    *
+ *   and returns a score that the illegal move can't use.  That costs nothing  *
+ *   for the legal moves, which are nearly all of them.                        *
+ *                                                                             *
  *******************************************************************************
  */
 int Quiesce(TREE * RESTRICT tree, int alpha, int beta, int wtm, int ply,
     int checks) {
   int original_alpha = alpha, value;
   int *next;
-  int *movep, *sortv;
+  int *movep;
+  uint64_t *recp;
 
 /*
  ************************************************************
@@ -57,6 +65,7 @@ int Quiesce(TREE * RESTRICT tree, int alpha, int beta, int wtm, int ply,
  */
   if (ply >= MAXPLY - 1)
     return beta;
+  Stat(tree, q_nodes);
 #if defined(NODES)
   if (--temp_search_nodes <= 0) {
     abort_search = 1;
@@ -128,16 +137,20 @@ int Quiesce(TREE * RESTRICT tree, int alpha, int beta, int wtm, int ply,
  *  Swap() to exclude captures that appear to lose          *
  *  material, but we delay expending this effort as long as *
  *  possible, since beta cutoffs make it unnecessary to     *
- *  search all of these moves anyway.                       *
+ *  search all of these moves anyway.  The sort itself is   *
+ *  delayed the same way.  Each capture is packed with its  *
+ *  MVV/LVA key into a move record and NextRecord() pulls   *
+ *  the best one forward only when we are ready for it.     *
  *                                                          *
  ************************************************************
  */
   tree->last[ply] = GenerateCaptures(tree, ply, wtm, tree->last[ply - 1]);
-  sortv = tree->sort_value;
+  recp = MoveRecords(ply - 1);
   for (movep = tree->last[ply - 1]; movep < tree->last[ply]; movep++) {
     if (Captured(*movep) == king)
       return beta;
-    *sortv++ = 1024 * pcval[Captured(*movep)] - pcval[Piece(*movep)];
+    *recp++ =
+        Record(*movep, 1024 * pcval[Captured(*movep)] - pcval[Piece(*movep)]);
   }
   if (!checks && tree->last[ply] == tree->last[ply - 1]) {
     if (alpha != original_alpha) {
@@ -146,36 +159,7 @@ int Quiesce(TREE * RESTRICT tree, int alpha, int beta, int wtm, int ply,
     }
     return value;
   }
-/*
- ************************************************************
- *                                                          *
- *  This is a simple insertion sort algorithm.  It seems be *
- *  be no faster than a normal bubble sort, but using this  *
- *  eliminated a lot of explaining about "why?". :)         *
- *                                                          *
- ************************************************************
- */
-  if (tree->last[ply] > tree->last[ply - 1] + 1) {
-    int temp1, temp2, *tmovep, *tsortv, *end;
-
-    sortv = tree->sort_value + 1;
-    end = tree->last[ply];
-    for (movep = tree->last[ply - 1] + 1; movep < end; movep++, sortv++) {
-      temp1 = *movep;
-      temp2 = *sortv;
-      tmovep = movep - 1;
-      tsortv = sortv - 1;
-      while (tmovep >= tree->last[ply - 1] && *tsortv < temp2) {
-        *(tsortv + 1) = *tsortv;
-        *(tmovep + 1) = *tmovep;
-        tmovep--;
-        tsortv--;
-      }
-      *(tmovep + 1) = temp1;
-      *(tsortv + 1) = temp2;
-    }
-  }
-  tree->next_status[ply].last = tree->last[ply - 1];
+  tree->next_status[ply].last = MoveRecords(ply - 1);
 /*
  ************************************************************
  *                                                          *
@@ -201,12 +185,16 @@ int Quiesce(TREE * RESTRICT tree, int alpha, int beta, int wtm, int ply,
  *                                                          *
  ************************************************************
  */
-  for (next = tree->last[ply - 1]; next < tree->last[ply]; next++) {
-    tree->curmv[ply] = *next;
+  if (checks)
+    GenerateLegalMasks(tree, ply, wtm);
+  for (recp = MoveRecords(ply - 1); recp < MoveRecords(ply); recp++) {
+    tree->curmv[ply] = RecordMove(NextRecord(recp, MoveRecords(ply)));
     if (pcval[Piece(tree->curmv[ply])] > pcval[Captured(tree->curmv[ply])] &&
         TotalPieces(wtm, occupied)
         - p_vals[Captured(tree->curmv[ply])] > 0 &&
-        Swap(tree, tree->curmv[ply], wtm) < 0)
+        Swap(tree, ply, tree->curmv[ply], wtm) < 0)
+      continue;
+    if (checks && !LegalMove(tree, ply, wtm, tree->curmv[ply]))
       continue;
 #if defined(TRACE)
     if (ply <= trace_level)
@@ -214,15 +202,11 @@ int Quiesce(TREE * RESTRICT tree, int alpha, int beta, int wtm, int ply,
 #endif
     MakeMove(tree, ply, tree->curmv[ply], wtm);
     tree->nodes_searched++;
-    if (!checks)
+    if (checks && Check(Flip(wtm))) {
+      tree->qchecks_done++;
+      value = -QuiesceEvasions(tree, -beta, -alpha, Flip(wtm), ply + 1);
+    } else
       value = -Quiesce(tree, -beta, -alpha, Flip(wtm), ply + 1, 0);
-    else if (!Check(wtm)) {
-      if (Check(Flip(wtm))) {
-        tree->qchecks_done++;
-        value = -QuiesceEvasions(tree, -beta, -alpha, Flip(wtm), ply + 1);
-      } else
-        value = -Quiesce(tree, -beta, -alpha, Flip(wtm), ply + 1, 0);
-    }
     UnmakeMove(tree, ply, tree->curmv[ply], wtm);
     if (abort_search || tree->stop)
       return 0;
@@ -259,17 +243,16 @@ int Quiesce(TREE * RESTRICT tree, int alpha, int beta, int wtm, int ply,
  */
     for (next = tree->last[ply - 1]; next < tree->last[ply]; next++) {
       tree->curmv[ply] = *next;
-      if (Swap(tree, tree->curmv[ply], wtm) >= 0) {
+      if (LegalMove(tree, ply, wtm, tree->curmv[ply]) &&
+          Swap(tree, ply, tree->curmv[ply], wtm) >= 0) {
 #if defined(TRACE)
         if (ply <= trace_level)
           Trace(tree, ply, 0, wtm, alpha, beta, "Quiesce", REMAINING_MOVES);
 #endif
         MakeMove(tree, ply, tree->curmv[ply], wtm);
         tree->nodes_searched++;
-        if (!Check(wtm)) {
-          tree->qchecks_done++;
-          value = -QuiesceEvasions(tree, -beta, -alpha, Flip(wtm), ply + 1);
-        }
+        tree->qchecks_done++;
+        value = -QuiesceEvasions(tree, -beta, -alpha, Flip(wtm), ply + 1);
         UnmakeMove(tree, ply, tree->curmv[ply], wtm);
         if (abort_search || tree->stop)
           return 0;
@@ -329,6 +312,7 @@ int QuiesceEvasions(TREE * RESTRICT tree, int alpha, int beta, int wtm,
  */
   if (ply >= MAXPLY - 1)
     return beta;
+  Stat(tree, q_nodes);
 #if defined(NODES)
   if (--temp_search_nodes <= 0) {
     abort_search = 1;
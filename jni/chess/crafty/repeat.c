@@ -1,6 +1,6 @@
 #include "chess.h"
 #include "data.h"
-/* last modified 05/08/14 */
+/* last modified 10/18/26 */
 /*
  *******************************************************************************
  *                                                                             *
@@ -29,6 +29,13 @@
  *   in a sane state for the rest of the search.  Do NOT remove those to lines *
  *   in Iterate() or repetition detection will be broken.                      *
  *                                                                             *
+ *   Before scanning the list, Repeat() looks the position up in rep_filter[], *
+ *   a table of counters indexed by the top bits of the hash signature that    *
+ *   counts every position in the game history plus every position on the      *
+ *   current search path (see RepeatFilter()).  A zero counter means the       *
+ *   position can not be in the list at all, which is the answer at nearly     *
+ *   every node, so the scan is only done when the counter is non-zero.        *
+ *                                                                             *
  *******************************************************************************
  */
 int Repeat(TREE * RESTRICT tree, int ply) {
@@ -50,6 +57,8 @@ int Repeat(TREE * RESTRICT tree, int ply) {
     return 0;
   if (Reversible(ply) > 99)
     return 2;
+  if (!RepFilter(HashKey))
+    return 0;
 /*
  ************************************************************
  *                                                          *
@@ -114,3 +123,28 @@ int Repeat3x(TREE * RESTRICT tree) {
       reps++;
   return reps == 2;
 }
+
+/* last modified 10/18/26 */
+/*
+ *******************************************************************************
+ *                                                                             *
+ *   RepeatFilter() rebuilds the repetition filter Repeat() uses from the game *
+ *   history in rep_list[].  After this, MakeMove() adds the position it is    *
+ *   leaving and UnmakeMove() takes it back out (Search() does the same around *
+ *   a null move), so the filter always holds the history plus the current     *
+ *   path.  Iterate() calls this before each search, and a split copies the    *
+ *   parent's filter along with the rest of the path.                          *
+ *                                                                             *
+ *   A counter can only be non-zero for a position that is not in the list     *
+ *   when two signatures share the same top bits.  That costs an unneeded      *
+ *   scan, never a missed repetition.                                          *
+ *                                                                             *
+ *******************************************************************************
+ */
+void RepeatFilter(TREE * RESTRICT tree) {
+  int where;
+
+  memset(tree->rep_filter, 0, sizeof(tree->rep_filter));
+  for (where = 0; where <= tree->rep_index; where++)
+    RepFilter(tree->rep_list[where])++;
+}
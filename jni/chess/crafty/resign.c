@@ -1,6 +1,6 @@
 #include "chess.h"
 #include "data.h"
-/* last modified 02/24/14 */
+/* last modified 10/18/26 */
 /*
  *******************************************************************************
  *                                                                             *
@@ -51,7 +51,7 @@ void ResignOrDraw(TREE * RESTRICT tree, int value) {
  *                                                          *
  ************************************************************
  */
-  if ((tc_increment > 200) || (tc_time_remaining[Flip(root_wtm)] >= 3000)) {
+  if ((tc_increment > 2000) || (tc_time_remaining[Flip(root_wtm)] >= 30000)) {
     if (resign) {
       if (value < -(MATE - 15)) {
         if (++resign_counter >= resign_count)
@@ -76,7 +76,7 @@ void ResignOrDraw(TREE * RESTRICT tree, int value) {
  *                                                          *
  ************************************************************
  */
-  if ((tc_increment > 200) || (tc_time_remaining[Flip(root_wtm)] >= 3000)) {
+  if ((tc_increment > 2000) || (tc_time_remaining[Flip(root_wtm)] >= 30000)) {
     if (Abs(Abs(value) - Abs(DrawScore(game_wtm))) < 2 &&
         moves_out_of_book > 3) {
       if (++draw_counter >= draw_count) {
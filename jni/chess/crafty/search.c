@@ -1,7 +1,7 @@
 #include "chess.h"
 #include "data.h"
 
-/* last modified 09/24/14 */
+/* last modified 10/18/26 */
 /*
  *******************************************************************************
  *                                                                             *
@@ -26,20 +26,27 @@ int Search(TREE * RESTRICT tree, int alpha, int beta, int wtm, int depth,
 /*
  ************************************************************
  *                                                          *
- *  Step 1.  Check to see if we have searched enough nodes  *
- *  that it is time to peek at how much time has been used, *
- *  or if is time to check for operator keyboard input.     *
- *  This is usually enough nodes to force a time/input      *
- *  check about once per second, except when the target     *
- *  time per move is very small, in which case we try to    *
- *  check the time more frequently.                         *
+ *  Step 1.  Check to see if it is time to peek at how much *
+ *  time has been used, or to check for operator keyboard   *
+ *  input.  Normally the timer thread (see TimerStart())    *
+ *  raises "time_check_due" when a deadline arrives or once *
+ *  per 1% of the target time.  The node counter is only    *
+ *  a fallback for "sn" node limits and for builds without  *
+ *  POSIX threads.                                          *
  *                                                          *
  *  Note that we check input or time-out in thread 0.  This *
  *  makes the code simpler and eliminates some problematic  *
  *  race conditions.                                        *
  *                                                          *
+ *  Any thread searching below a split point also checks    *
+ *  here to see if a cutoff elsewhere has cancelled that    *
+ *  split point (see ThreadStop()), and if so it unwinds.   *
+ *                                                          *
  ************************************************************
  */
+  Stat(tree, full_nodes);
+  Journal(tree, JOURNAL_SEARCH, ply, depth, tree->curmv[ply - 1],
+      tree->phase[ply - 1], alpha, beta, 0);
 #if defined(NODES)
   if (--temp_search_nodes <= 0) {
     abort_search = 1;
@@ -47,7 +54,8 @@ int Search(TREE * RESTRICT tree, int alpha, int beta, int wtm, int depth,
   }
 #endif
   if (tree->thread_id == 0) {
-    if (--next_time_check <= 0) {
+    if (time_check_due || --next_time_check <= 0) {
+      time_check_due = 0;
       next_time_check = nodes_between_time_checks;
       if (TimeCheck(tree, 1)) {
         abort_search = 1;
@@ -60,6 +68,12 @@ int Search(TREE * RESTRICT tree, int alpha, int beta, int wtm, int depth,
       }
     }
   }
+#if (CPUS > 1)
+  if (tree->parent && !tree->stop && ThreadCancelled(tree)) {
+    tree->stop = 1;
+    return 0;
+  }
+#endif
   if (ply >= MAXPLY - 1)
     return beta;
 /*
@@ -114,6 +128,7 @@ int Search(TREE * RESTRICT tree, int alpha, int beta, int wtm, int depth,
  */
     switch (HashProbe(tree, ply, depth, wtm, alpha, beta, &value)) {
       case HASH_HIT:
+        Journal(tree, JOURNAL_HASH, ply, depth, 0, 0, alpha, beta, value);
         return value;
       case AVOID_NULL_MOVE:
         do_null = 0;
@@ -229,12 +244,14 @@ int Search(TREE * RESTRICT tree, int alpha, int beta, int wtm, int depth,
       tree->status[ply + 1] = tree->status[ply];
       Reversible(ply + 1) = 0;
       save_hash_key = HashKey;
+      RepFilter(HashKey)++;
       if (EnPassant(ply + 1)) {
         HashEP(EnPassant(ply + 1));
         EnPassant(ply + 1) = 0;
       }
       tdepth += depth / null_divisor;
       tree->null_done[tdepth]++;
+      Stat(tree, searched[NULL_MOVE]);
       if (depth - tdepth - 1 > 0)
         value =
             -Search(tree, -beta, -beta + 1, Flip(wtm), depth - tdepth - 1,
@@ -242,9 +259,13 @@ int Search(TREE * RESTRICT tree, int alpha, int beta, int wtm, int depth,
       else
         value = -Quiesce(tree, -beta, -beta + 1, Flip(wtm), ply + 1, 1);
       HashKey = save_hash_key;
+      RepFilter(HashKey)--;
       if (abort_search || tree->stop)
         return 0;
+      Journal(tree, JOURNAL_NULL, ply, depth, 0, NULL_MOVE, beta - 1, beta,
+          value);
       if (value >= beta) {
+        Stat(tree, cutoffs[NULL_MOVE]);
         HashStore(tree, ply, depth, wtm, LOWER, value, tree->hash_move[ply]);
         return value;
       }
@@ -289,10 +310,11 @@ int Search(TREE * RESTRICT tree, int alpha, int beta, int wtm, int depth,
  ************************************************************
  *                                                          *
  *  Step 7.  Now iterate through the move list and search   *
- *  the resulting positions.  Note that Search() culls any  *
- *  move that is not legal by using Check().  The special   *
- *  case is that we must find one legal move to search to   *
- *  confirm that it's not a mate or draw.                   *
+ *  the resulting positions.  All three move selection      *
+ *  procedures return only legal moves (NextMove() tests    *
+ *  each one with LegalMove() before it is returned) so     *
+ *  there is no Check() test after MakeMove().  If no move  *
+ *  is returned at all, it is either mate or stalemate.     *
  *                                                          *
  *  We have three possible procedures we call here, one is  *
  *  specific to ply=1 (NextRootMove()), the second is a     *
@@ -327,11 +349,11 @@ int Search(TREE * RESTRICT tree, int alpha, int beta, int wtm, int depth,
 #endif
     MakeMove(tree, ply, tree->curmv[ply], wtm);
     tree->nodes_searched++;
-    if (in_check || !Check(wtm))
-      do {
-        searched[moves_searched] = tree->curmv[ply];
-        if (++moves_searched == 1)
-          first_tried = tree->curmv[ply];
+    Stat(tree, searched[tree->phase[ply]]);
+    do {
+      searched[moves_searched] = tree->curmv[ply];
+      if (++moves_searched == 1)
+        first_tried = tree->curmv[ply];
 /*
  ************************************************************
  *                                                          *
@@ -350,16 +372,16 @@ int Search(TREE * RESTRICT tree, int alpha, int beta, int wtm, int depth,
  *                                                          *
  ************************************************************
  */
-        extend = 0;
-        reduce = 0;
-        if (Check(Flip(wtm))) {
-          check = 1;
-          if (SwapO(tree, tree->curmv[ply], wtm) <= 0) {
-            extend = check_depth;
-            tree->extensions_done++;
-          }
-        } else
-          check = 0;
+      extend = 0;
+      reduce = 0;
+      if (Check(Flip(wtm))) {
+        check = 1;
+        if (SwapO(tree, tree->curmv[ply], wtm) <= 0) {
+          extend = check_depth;
+          tree->extensions_done++;
+        }
+      } else
+        check = 0;
 /*
  ************************************************************
  *                                                          *
@@ -405,16 +427,16 @@ int Search(TREE * RESTRICT tree, int alpha, int beta, int wtm, int depth,
  *                                                          *
  ************************************************************
  */
-        if (!in_check && !extend && moves_searched > 1 &&
-            tree->phase[ply] >= HISTORY_MOVES) {
-          if (depth < pruning_depth &&
-              MaterialSTM(wtm) + pruning_margin[depth] <= alpha)
-            if (Piece(tree->curmv[ply]) != pawn ||
-                !Passed(To(tree->curmv[ply]), wtm)
-                || rankflip[wtm][Rank(To(tree->curmv[ply]))] < RANK6) {
-              tree->moves_fpruned++;
-              continue;
-            }
+      if (!in_check && !extend && moves_searched > 1 &&
+          tree->phase[ply] >= HISTORY_MOVES) {
+        if (depth < pruning_depth &&
+            MaterialSTM(wtm) + pruning_margin[depth] <= alpha)
+          if (Piece(tree->curmv[ply]) != pawn ||
+              !Passed(To(tree->curmv[ply]), wtm)
+              || rankflip[wtm][Rank(To(tree->curmv[ply]))] < RANK6) {
+            tree->moves_fpruned++;
+            continue;
+          }
 /*
  ************************************************************
  *                                                          *
@@ -442,13 +464,13 @@ int Search(TREE * RESTRICT tree, int alpha, int beta, int wtm, int depth,
  *                                                          *
  ************************************************************
  */
-          if (Piece(tree->curmv[ply]) != pawn ||
-              !Passed(To(tree->curmv[ply]), wtm)
-              || rankflip[wtm][Rank(To(tree->curmv[ply]))] < RANK6) {
-            reduce = LMR[Min(depth, 31)][Min(moves_searched, 63)];
-            tree->LMR_done[reduce]++;
-          }
+        if (Piece(tree->curmv[ply]) != pawn ||
+            !Passed(To(tree->curmv[ply]), wtm)
+            || rankflip[wtm][Rank(To(tree->curmv[ply]))] < RANK6) {
+          reduce = LMR[Min(depth, 31)][Min(moves_searched, 63)];
+          tree->LMR_done[reduce]++;
         }
+      }
 /*
  ************************************************************
  *                                                          *
@@ -467,18 +489,18 @@ int Search(TREE * RESTRICT tree, int alpha, int beta, int wtm, int depth,
  *                                                          *
  ************************************************************
  */
-        if (depth + extend - reduce - 1 > 0) {
+      if (depth + extend - reduce - 1 > 0) {
+        value =
+            -Search(tree, -t_beta, -alpha, Flip(wtm),
+            depth + extend - reduce - 1, ply + 1, check, DO_NULL);
+        if (value > alpha && reduce)
           value =
-              -Search(tree, -t_beta, -alpha, Flip(wtm),
-              depth + extend - reduce - 1, ply + 1, check, DO_NULL);
-          if (value > alpha && reduce)
-            value =
-                -Search(tree, -t_beta, -alpha, Flip(wtm), depth - 1, ply + 1,
-                check, DO_NULL);
-        } else
-          value = -Quiesce(tree, -t_beta, -alpha, Flip(wtm), ply + 1, 1);
-        if (abort_search || tree->stop)
-          break;
+              -Search(tree, -t_beta, -alpha, Flip(wtm), depth - 1, ply + 1,
+              check, DO_NULL);
+      } else
+        value = -Quiesce(tree, -t_beta, -alpha, Flip(wtm), ply + 1, 1);
+      if (abort_search || tree->stop)
+        break;
 /*
  ************************************************************
  *                                                          *
@@ -493,12 +515,14 @@ int Search(TREE * RESTRICT tree, int alpha, int beta, int wtm, int depth,
  *  Special case:  ply == 1.                                *
  *                                                          *
  *  In this case, we need to clean up and then move the     *
- *  best move to the top of the root move list, and return  *
- *  back to Iterate() to let it produce the usual informa-  *
- *  tive output and re-start the search with a new beta     *
- *  value.  We also reset the failhi_delta back to 16,      *
- *  since an earlier fail-high or fail low in this          *
- *  iteration could have left it at a large value.          *
+ *  best move to the top of the root move list (or to the   *
+ *  top of the part still being searched in multipv mode,   *
+ *  see Iterate()), and return back to Iterate() to let it  *
+ *  produce the usual informative output and re-start the   *
+ *  search with a new beta value.  We also reset the        *
+ *  failhi_delta back to 16, since an earlier fail-high or  *
+ *  fail low in this iteration could have left it at a      *
+ *  large value.                                            *
  *                                                          *
  *  Last step is to build a usable PV in case this move     *
  *  fails low on the re-search, because we do want to play  *
@@ -506,38 +530,38 @@ int Search(TREE * RESTRICT tree, int alpha, int beta, int wtm, int depth,
  *                                                          *
  ************************************************************
  */
-        if (value > alpha && value < beta && moves_searched > 1) {
-          if (ply == 1) {
-            alpha = value;
-            UnmakeMove(tree, ply, tree->curmv[ply], wtm);
-            root_beta = alpha;
-            failhi_delta = 16;
-            for (i = 0; i < n_root_moves; i++)
-              if (tree->curmv[1] == root_moves[i].move)
-                break;
-            if (i < n_root_moves) {
-              temp_rm = root_moves[i];
-              for (; i > 0; i--)
-                root_moves[i] = root_moves[i - 1];
-              root_moves[0] = temp_rm;
-            }
-            root_moves[0].bm_age = 4;
-            tree->pv[1].path[1] = tree->curmv[1];
-            tree->pv[1].pathl = 2;
-            tree->pv[1].pathh = 0;
-            tree->pv[1].pathd = iteration_depth;
-            tree->pv[0] = tree->pv[1];
-            return alpha;
+      if (value > alpha && value < beta && moves_searched > 1) {
+        if (ply == 1) {
+          alpha = value;
+          UnmakeMove(tree, ply, tree->curmv[ply], wtm);
+          root_beta = alpha;
+          failhi_delta = 16;
+          for (i = 0; i < n_root_moves; i++)
+            if (tree->curmv[1] == root_moves[i].move)
+              break;
+          if (i < n_root_moves) {
+            temp_rm = root_moves[i];
+            for (; i > multipv_index; i--)
+              root_moves[i] = root_moves[i - 1];
+            root_moves[multipv_index] = temp_rm;
           }
-          if (depth + extend - 1 > 0)
-            value =
-                -Search(tree, -beta, -alpha, Flip(wtm), depth + extend - 1,
-                ply + 1, check, DO_NULL);
-          else
-            value = -Quiesce(tree, -beta, -alpha, Flip(wtm), ply + 1, 1);
-          if (abort_search || tree->stop)
-            break;
+          root_moves[multipv_index].bm_age = 4;
+          tree->pv[1].path[1] = tree->curmv[1];
+          tree->pv[1].pathl = 2;
+          tree->pv[1].pathh = 0;
+          tree->pv[1].pathd = iteration_depth;
+          tree->pv[0] = tree->pv[1];
+          return alpha;
         }
+        if (depth + extend - 1 > 0)
+          value =
+              -Search(tree, -beta, -alpha, Flip(wtm), depth + extend - 1,
+              ply + 1, check, DO_NULL);
+        else
+          value = -Quiesce(tree, -beta, -alpha, Flip(wtm), ply + 1, 1);
+        if (abort_search || tree->stop)
+          break;
+      }
 /*
  ************************************************************
  *                                                          *
@@ -554,27 +578,30 @@ int Search(TREE * RESTRICT tree, int alpha, int beta, int wtm, int depth,
  *                                                          *
  ************************************************************
  */
-        if (value > alpha) {
-          alpha = value;
-          if (ply == 1) {
-            tree->pv[1].pathv = value;
-            Output(tree, beta);
-            tree->pv[0] = tree->pv[1];
-          }
-          if (value >= beta) {
-            History(tree, ply, depth, wtm, tree->curmv[ply], searched,
-                moves_searched - 1);
-            UnmakeMove(tree, ply, tree->curmv[ply], wtm);
-            HashStore(tree, ply, depth, wtm, LOWER, value, tree->curmv[ply]);
-            tree->fail_highs++;
-            if (moves_searched == 1)
-              tree->fail_high_first_move++;
-            return value;
-          }
+      Journal(tree, JOURNAL_MOVE, ply, depth, tree->curmv[ply],
+          tree->phase[ply], alpha, beta, value);
+      if (value > alpha) {
+        alpha = value;
+        if (ply == 1) {
+          tree->pv[1].pathv = value;
+          Output(tree, beta);
+          tree->pv[0] = tree->pv[1];
+        }
+        if (value >= beta) {
+          Stat(tree, cutoffs[tree->phase[ply]]);
+          History(tree, ply, depth, wtm, tree->curmv[ply], searched,
+              moves_searched - 1);
+          UnmakeMove(tree, ply, tree->curmv[ply], wtm);
+          HashStore(tree, ply, depth, wtm, LOWER, value, tree->curmv[ply]);
+          tree->fail_highs++;
+          if (moves_searched == 1)
+            tree->fail_high_first_move++;
+          return value;
         }
-        t_beta = alpha + 1;
       }
-      while (0);
+      t_beta = alpha + 1;
+    }
+    while (0);
     UnmakeMove(tree, ply, tree->curmv[ply], wtm);
     if (abort_search || tree->stop)
       return 0;
@@ -658,13 +685,13 @@ int Search(TREE * RESTRICT tree, int alpha, int beta, int wtm, int depth,
             (smp_split_at_root && NextRootMoveParallel() &&
                 alpha != original_alpha)))
       do {
-        Lock(lock_split);
+        SpinLockTimed(lock_split, tree->thread_id, LOCK_SPLIT);
         if (smp_split <= 0) {
-          Unlock(lock_split);
+          SpinUnlock(lock_split);
           break;
         }
         smp_split = -1;
-        Unlock(lock_split);
+        SpinUnlock(lock_split);
         tree->alpha = alpha;
         tree->beta = beta;
         tree->value = alpha;
@@ -674,6 +701,8 @@ int Search(TREE * RESTRICT tree, int alpha, int beta, int wtm, int depth,
         tree->in_check = in_check;
         tree->moves_searched = moves_searched;
         if (Thread(tree)) {
+          if (!tree->stop && ThreadCancelled(tree))
+            tree->stop = 1;
           if (abort_search || tree->stop)
             return 0;
           value = tree->value;
@@ -735,7 +764,7 @@ int Search(TREE * RESTRICT tree, int alpha, int beta, int wtm, int depth,
   }
 }
 
-/* last modified 09/16/14 */
+/* last modified 10/18/26 */
 /*
  *******************************************************************************
  *                                                                             *
@@ -760,11 +789,11 @@ int SearchParallel(TREE * RESTRICT tree, int alpha, int beta, int value,
  ************************************************************
  *                                                          *
  *  Step 7.  Now we continue to iterate through the move    *
- *  list and search the resulting positions.  Note that     *
- *  SearchParallel() culls any move that is not legal by    *
- *  using Check().  The special case mentioned in Search()  *
- *  is not an issue here as we don't do a parallel split    *
- *  until we have searched one legal move.                  *
+ *  list and search the resulting positions.  As in         *
+ *  Search(), every move returned is legal.  The mate or    *
+ *  stalemate case mentioned there is not an issue here as  *
+ *  we don't do a parallel split until we have searched one *
+ *  legal move.                                             *
  *                                                          *
  *  We have three possible procedures we call here, one is  *
  *  specific to ply=1 (NextRootMove()), the second is a     *
@@ -772,10 +801,20 @@ int SearchParallel(TREE * RESTRICT tree, int alpha, int beta, int value,
  *  the last is the normal NextMove() procedure that does   *
  *  the usual move ordering stuff.                          *
  *                                                          *
+ *  Before taking each move we check whether a split point  *
+ *  above us has been stopped (see ThreadStop()).  A thread *
+ *  that returns here from a nested split of its own has    *
+ *  not been through Search() since, so this is the first   *
+ *  chance it has to notice.                                *
+ *                                                          *
  ************************************************************
  */
   while (1) {
-    Lock(parent->lock);
+    if (!tree->stop && ThreadCancelled(tree))
+      tree->stop = 1;
+    if (tree->stop)
+      return alpha;
+    SpinLockTimed(parent->lock, tree->thread_id, LOCK_TREE);
     if (ply > 1)
       tree->phase[ply] =
           (in_check) ? NextEvasion(parent, ply, wtm) : NextMove(parent, ply,
@@ -783,7 +822,7 @@ int SearchParallel(TREE * RESTRICT tree, int alpha, int beta, int value,
     else
       tree->phase[ply] = NextRootMove(parent, tree, wtm);
     tree->curmv[ply] = parent->curmv[ply];
-    Unlock(parent->lock);
+    SpinUnlock(parent->lock);
     if (!tree->phase[ply])
       break;
 #if defined(TRACE)
@@ -793,9 +832,9 @@ int SearchParallel(TREE * RESTRICT tree, int alpha, int beta, int value,
 #endif
     MakeMove(tree, ply, tree->curmv[ply], wtm);
     tree->nodes_searched++;
-    if (in_check || !Check(wtm))
-      do {
-        parent->moves_searched++;
+    Stat(tree, searched[tree->phase[ply]]);
+    do {
+      parent->moves_searched++;
 /*
  ************************************************************
  *                                                          *
@@ -811,16 +850,16 @@ int SearchParallel(TREE * RESTRICT tree, int alpha, int beta, int value,
  *                                                          *
  ************************************************************
  */
-        extend = 0;
-        reduce = 0;
-        if (Check(Flip(wtm))) {
-          check = 1;
-          if (SwapO(tree, tree->curmv[ply], wtm) <= 0) {
-            extend = check_depth;
-            tree->extensions_done++;
-          }
-        } else
-          check = 0;
+      extend = 0;
+      reduce = 0;
+      if (Check(Flip(wtm))) {
+        check = 1;
+        if (SwapO(tree, tree->curmv[ply], wtm) <= 0) {
+          extend = check_depth;
+          tree->extensions_done++;
+        }
+      } else
+        check = 0;
 /*
  ************************************************************
  *                                                          *
@@ -866,16 +905,16 @@ int SearchParallel(TREE * RESTRICT tree, int alpha, int beta, int value,
  *                                                          *
  ************************************************************
  */
-        if (!in_check && !extend && parent->moves_searched > 1 &&
-            tree->phase[ply] >= HISTORY_MOVES) {
-          if (depth < pruning_depth &&
-              MaterialSTM(wtm) + pruning_margin[depth] <= alpha)
-            if (Piece(tree->curmv[ply]) != pawn ||
-                !Passed(To(tree->curmv[ply]), wtm)
-                || rankflip[wtm][Rank(To(tree->curmv[ply]))] < RANK6) {
-              tree->moves_fpruned++;
-              continue;
-            }
+      if (!in_check && !extend && parent->moves_searched > 1 &&
+          tree->phase[ply] >= HISTORY_MOVES) {
+        if (depth < pruning_depth &&
+            MaterialSTM(wtm) + pruning_margin[depth] <= alpha)
+          if (Piece(tree->curmv[ply]) != pawn ||
+              !Passed(To(tree->curmv[ply]), wtm)
+              || rankflip[wtm][Rank(To(tree->curmv[ply]))] < RANK6) {
+            tree->moves_fpruned++;
+            continue;
+          }
 /*
  ************************************************************
  *                                                          *
@@ -903,13 +942,13 @@ int SearchParallel(TREE * RESTRICT tree, int alpha, int beta, int value,
  *                                                          *
  ************************************************************
  */
-          if (Piece(tree->curmv[ply]) != pawn ||
-              !Passed(To(tree->curmv[ply]), wtm)
-              || rankflip[wtm][Rank(To(tree->curmv[ply]))] < RANK6) {
-            reduce = LMR[Min(depth, 31)][Min(parent->moves_searched, 63)];
-            tree->LMR_done[reduce]++;
-          }
+        if (Piece(tree->curmv[ply]) != pawn ||
+            !Passed(To(tree->curmv[ply]), wtm)
+            || rankflip[wtm][Rank(To(tree->curmv[ply]))] < RANK6) {
+          reduce = LMR[Min(depth, 31)][Min(parent->moves_searched, 63)];
+          tree->LMR_done[reduce]++;
         }
+      }
 /*
  ************************************************************
  *                                                          *
@@ -928,18 +967,18 @@ int SearchParallel(TREE * RESTRICT tree, int alpha, int beta, int value,
  *                                                          *
  ************************************************************
  */
-        if (depth + extend - reduce - 1 > 0) {
+      if (depth + extend - reduce - 1 > 0) {
+        value =
+            -Search(tree, -alpha - 1, -alpha, Flip(wtm),
+            depth + extend - reduce - 1, ply + 1, check, DO_NULL);
+        if (value > alpha && reduce)
           value =
-              -Search(tree, -alpha - 1, -alpha, Flip(wtm),
-              depth + extend - reduce - 1, ply + 1, check, DO_NULL);
-          if (value > alpha && reduce)
-            value =
-                -Search(tree, -alpha - 1, -alpha, Flip(wtm), depth - 1,
-                ply + 1, check, DO_NULL);
-        } else
-          value = -Quiesce(tree, -alpha - 1, -alpha, Flip(wtm), ply + 1, 1);
-        if (abort_search || tree->stop)
-          break;
+              -Search(tree, -alpha - 1, -alpha, Flip(wtm), depth - 1,
+              ply + 1, check, DO_NULL);
+      } else
+        value = -Quiesce(tree, -alpha - 1, -alpha, Flip(wtm), ply + 1, 1);
+      if (abort_search || tree->stop)
+        break;
 /*
  ************************************************************
  *                                                          *
@@ -968,52 +1007,43 @@ int SearchParallel(TREE * RESTRICT tree, int alpha, int beta, int value,
  *                                                          *
  ************************************************************
  */
-        if (value > alpha && value < beta) {
-          if (ply == 1) {
-            int proc;
-
-            alpha = value;
-            parallel_aborts++;
-            UnmakeMove(tree, ply, tree->curmv[ply], wtm);
-            Lock(lock_smp);
-            Lock(parent->lock);
-            if (!tree->stop) {
-              for (proc = 0; proc < smp_max_threads; proc++)
-                if (parent->siblings[proc] && proc != tree->thread_id)
-                  ThreadStop(parent->siblings[proc]);
-              root_beta = alpha;
-              failhi_delta = 16;
-              Lock(lock_root);
-              for (i = 0; i < n_root_moves; i++)
-                if (tree->curmv[1] == root_moves[i].move)
-                  break;
-              if (i < n_root_moves) {
-                temp_rm = root_moves[i];
-                for (; i > 0; i--)
-                  root_moves[i] = root_moves[i - 1];
-                root_moves[0] = temp_rm;
-              }
-              root_moves[0].bm_age = 4;
-              Unlock(lock_root);
-              tree->pv[1].path[1] = tree->curmv[1];
-              tree->pv[1].pathl = 2;
-              tree->pv[1].pathh = 0;
-              tree->pv[1].pathd = iteration_depth;
-              tree->pv[0] = tree->pv[1];
+      if (value > alpha && value < beta) {
+        if (ply == 1) {
+          alpha = value;
+          parallel_aborts++;
+          UnmakeMove(tree, ply, tree->curmv[ply], wtm);
+          if (ThreadStop(tree)) {
+            root_beta = alpha;
+            failhi_delta = 16;
+            SpinLockTimed(lock_root, tree->thread_id, LOCK_ROOT);
+            for (i = 0; i < n_root_moves; i++)
+              if (tree->curmv[1] == root_moves[i].move)
+                break;
+            if (i < n_root_moves) {
+              temp_rm = root_moves[i];
+              for (; i > multipv_index; i--)
+                root_moves[i] = root_moves[i - 1];
+              root_moves[multipv_index] = temp_rm;
             }
-            Unlock(parent->lock);
-            Unlock(lock_smp);
-            return alpha;
+            root_moves[multipv_index].bm_age = 4;
+            SpinUnlock(lock_root);
+            tree->pv[1].path[1] = tree->curmv[1];
+            tree->pv[1].pathl = 2;
+            tree->pv[1].pathh = 0;
+            tree->pv[1].pathd = iteration_depth;
+            tree->pv[0] = tree->pv[1];
           }
-          if (depth + extend - 1 > 0)
-            value =
-                -Search(tree, -beta, -alpha, Flip(wtm), depth + extend - 1,
-                ply + 1, check, DO_NULL);
-          else
-            value = -Quiesce(tree, -beta, -alpha, Flip(wtm), ply + 1, 1);
-          if (abort_search || tree->stop)
-            break;
+          return alpha;
         }
+        if (depth + extend - 1 > 0)
+          value =
+              -Search(tree, -beta, -alpha, Flip(wtm), depth + extend - 1,
+              ply + 1, check, DO_NULL);
+        else
+          value = -Quiesce(tree, -beta, -alpha, Flip(wtm), ply + 1, 1);
+        if (abort_search || tree->stop)
+          break;
+      }
 /*
  ************************************************************
  *                                                          *
@@ -1036,32 +1066,27 @@ int SearchParallel(TREE * RESTRICT tree, int alpha, int beta, int value,
  *  We then stop all threads (except the current thread     *
  *  that is dealing with the fail high) since we are going  *
  *  to back out quickly and then start a new search from    *
- *  the root position.  The split-block sibling ids lets us *
- *  know which threads should be stopped, and since we are  *
- *  at the root (ply == 1) that essentially means "all      *
- *  threads except for this one."                           *
+ *  the root position.  ThreadStop() bumps the split       *
+ *  block's cancellation epoch, which every thread below    *
+ *  this split point notices the next time it enters        *
+ *  Search(), and since we are at the root (ply == 1) that  *
+ *  essentially means "all threads except for this one."    *
  *                                                          *
  ************************************************************
  */
-        if (value > alpha) {
-          alpha = value;
-          if (value >= beta) {
-            int proc;
-
-            parallel_aborts++;
-            UnmakeMove(tree, ply, tree->curmv[ply], wtm);
-            Lock(lock_smp);
-            Lock(parent->lock);
-            if (!tree->stop)
-              for (proc = 0; proc < smp_max_threads; proc++)
-                if (parent->siblings[proc] && proc != tree->thread_id)
-                  ThreadStop(parent->siblings[proc]);
-            Unlock(parent->lock);
-            Unlock(lock_smp);
-            return alpha;
-          }
+      Journal(tree, JOURNAL_MOVE, ply, depth, tree->curmv[ply],
+          tree->phase[ply], alpha, beta, value);
+      if (value > alpha) {
+        alpha = value;
+        if (value >= beta) {
+          Stat(tree, cutoffs[tree->phase[ply]]);
+          parallel_aborts++;
+          UnmakeMove(tree, ply, tree->curmv[ply], wtm);
+          ThreadStop(tree);
+          return alpha;
         }
-      } while (0);
+      }
+    } while (0);
     UnmakeMove(tree, ply, tree->curmv[ply], wtm);
     if (abort_search || tree->stop)
       break;
@@ -1091,13 +1116,13 @@ int SearchParallel(TREE * RESTRICT tree, int alpha, int beta, int value,
   if (tree->stop && ply == 1) {
     int which;
 
-    Lock(lock_root);
+    SpinLockTimed(lock_root, tree->thread_id, LOCK_ROOT);
     for (which = 0; which < n_root_moves; which++)
       if (root_moves[which].move == tree->curmv[ply]) {
         root_moves[which].status &= 0xf7;
         break;
       }
-    Unlock(lock_root);
+    SpinUnlock(lock_root);
   }
   return alpha;
 }
@@ -1,11 +1,13 @@
 #include "chess.h"
 #include "data.h"
-/* last modified 05/08/14 */
+/* last modified 10/18/26 */
 /*
  *******************************************************************************
  *                                                                             *
  *   SetBoard() is used to set up the board in any position desired.  It uses  *
  *   a forsythe-like string of characters to describe the board position.      *
+ *   It returns non-zero if the position was illegal, in which case the normal *
+ *   initial position has been set up instead.                                 *
  *                                                                             *
  *   The standard piece codes p,n,b,r,q,k are used to denote the type of piece *
  *   on a square, upper/lower case are used to indicate the side (program/     *
@@ -44,7 +46,7 @@
  *                                                                             *
  *******************************************************************************
  */
-void SetBoard(TREE * tree, int nargs, char *args[], int special) {
+int SetBoard(TREE * tree, int nargs, char *args[], int special) {
   int twtm, i, match, num, pos, square, tboard[64];
   int bcastle, ep, wcastle, error = 0;
   char input[80];
@@ -267,4 +269,5 @@ void SetBoard(TREE * tree, int nargs, char *args[], int special) {
     InitializeChessBoard(tree);
     Print(4095, "Illegal position, using normal initial chess position\n");
   }
+  return error;
 }
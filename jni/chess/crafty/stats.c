@@ -0,0 +1,141 @@
+#include "chess.h"
+#include "data.h"
+/* last modified 10/18/26 */
+/*
+ *******************************************************************************
+ *                                                                             *
+ *   SearchStats() displays the search counters gathered during the last       *
+ *   search by the Stat() hooks in Search(), Quiesce(), NextMove() and         *
+ *   Evaluate().  These are only compiled in with -DSTATS, since they add an   *
+ *   increment to the hottest paths in the program.  format=0 prints a table   *
+ *   of the totals over all threads, format=1 prints one JSON object per       *
+ *   thread followed by the total, for scripts.                                *
+ *                                                                             *
+ *   The table shows, for each NextMove() phase, how many moves it supplied    *
+ *   and how many of them failed high, which is the direct measure of move     *
+ *   ordering quality.  Moves searched out of check come from NextEvasion()    *
+ *   and are counted as hash or remaining moves.  It then shows how many       *
+ *   moves were generated versus searched, how often a cutoff came before the  *
+ *   captures or the non-captures had been generated (the work the staged      *
+ *   generator saves), the qsearch/full-width node ratio and the rate of lazy  *
+ *   evaluation exits.  Generation in a node that has been split is charged    *
+ *   to the thread that owns the split point, unlocked, so with several        *
+ *   threads a few of those increments can be lost.                            *
+ *                                                                             *
+ *******************************************************************************
+ */
+void SearchStats(int format) {
+#if defined(STATS)
+  static const char *phases[REMAINING_MOVES + 1] = {
+    "", "null", "hash", "", "captures", "killer1", "killer2", "killer3",
+    "killer4", "", "history", "remaining"
+  };
+  SEARCH_STATS *st, total;
+  char label[16];
+  int tid, i, nthreads = Max(smp_max_threads, 1);
+  uint64_t searched, cutoffs, generated, early_captures, early_noncaptures;
+
+  memset(&total, 0, sizeof(SEARCH_STATS));
+  for (tid = 0; tid <= nthreads; tid++) {
+    if (tid < nthreads) {
+      st = &search_stats[tid];
+      total.full_nodes += st->full_nodes;
+      total.q_nodes += st->q_nodes;
+      for (i = 0; i <= REMAINING_MOVES; i++) {
+        total.searched[i] += st->searched[i];
+        total.cutoffs[i] += st->cutoffs[i];
+      }
+      total.capture_gens += st->capture_gens;
+      total.captures_generated += st->captures_generated;
+      total.noncapture_gens += st->noncapture_gens;
+      total.noncaptures_generated += st->noncaptures_generated;
+      total.evaluations += st->evaluations;
+      total.lazy_exits += st->lazy_exits;
+    } else
+      st = &total;
+/*
+ ************************************************************
+ *                                                          *
+ *  Derived values.  A null-move or hash-move cutoff ends   *
+ *  the node before any captures are generated, and a       *
+ *  cutoff by any move up through the killers ends it       *
+ *  before the non-captures are generated.                  *
+ *                                                          *
+ ************************************************************
+ */
+    searched = 0;
+    cutoffs = 0;
+    for (i = HASH_MOVE; i <= REMAINING_MOVES; i++) {
+      searched += st->searched[i];
+      cutoffs += st->cutoffs[i];
+    }
+    generated = st->captures_generated + st->noncaptures_generated;
+    early_captures = st->cutoffs[NULL_MOVE] + st->cutoffs[HASH_MOVE];
+    early_noncaptures = 0;
+    for (i = NULL_MOVE; i <= KILLER_MOVE_4; i++)
+      early_noncaptures += st->cutoffs[i];
+    if (format) {
+      if (tid < nthreads)
+        sprintf(label, "%d", tid);
+      else
+        strcpy(label, "\"total\"");
+      Print(128, "{\"thread\":%s, \"full_nodes\":%" PRIu64 ", \"q_nodes\":%"
+          PRIu64, label, st->full_nodes, st->q_nodes);
+      Print(128, ", \"searched\":{");
+      for (i = NULL_MOVE; i <= REMAINING_MOVES; i++)
+        if (phases[i][0])
+          Print(128, "%s\"%s\":%" PRIu64, (i == NULL_MOVE) ? "" : ", ",
+              phases[i], st->searched[i]);
+      Print(128, "}, \"cutoffs\":{");
+      for (i = NULL_MOVE; i <= REMAINING_MOVES; i++)
+        if (phases[i][0])
+          Print(128, "%s\"%s\":%" PRIu64, (i == NULL_MOVE) ? "" : ", ",
+              phases[i], st->cutoffs[i]);
+      Print(128, "}, \"capture_gens\":%" PRIu64 ", \"captures_generated\":%"
+          PRIu64 ", \"noncapture_gens\":%" PRIu64
+          ", \"noncaptures_generated\":%" PRIu64 ", \"evaluations\":%" PRIu64
+          ", \"lazy_exits\":%" PRIu64 "}\n", st->capture_gens,
+          st->captures_generated, st->noncapture_gens,
+          st->noncaptures_generated, st->evaluations, st->lazy_exits);
+      continue;
+    }
+    if (tid < nthreads)
+      continue;
+/*
+ ************************************************************
+ *                                                          *
+ *  Table format, totals only.                              *
+ *                                                          *
+ ************************************************************
+ */
+    Print(16, "        phase         searched     cutoffs   cut%%"
+        "  of cutoffs\n");
+    for (i = NULL_MOVE; i <= REMAINING_MOVES; i++)
+      if (phases[i][0])
+        Print(16, "        %-10s  %10" PRIu64 "  %10" PRIu64
+            "  %5.1f   %5.1f\n",
+            phases[i], st->searched[i], st->cutoffs[i],
+            100.0 * st->cutoffs[i] / Max(st->searched[i], 1),
+            100.0 * st->cutoffs[i] / Max(cutoffs + st->cutoffs[NULL_MOVE],
+                1));
+    Print(16, "        moves generated     %s", DisplayKMB(generated, 0));
+    Print(16, "  searched %s (%.1f%%)\n", DisplayKMB(searched, 0),
+        100.0 * searched / Max(generated, 1));
+    Print(16, "        capture gens        %s", DisplayKMB(st->capture_gens,
+            0));
+    Print(16, "  avoided by cutoff %s\n", DisplayKMB(early_captures, 0));
+    Print(16, "        non-capture gens    %s",
+        DisplayKMB(st->noncapture_gens, 0));
+    Print(16, "  avoided by cutoff %s\n", DisplayKMB(early_noncaptures, 0));
+    Print(16, "        full-width nodes    %s", DisplayKMB(st->full_nodes, 0));
+    Print(16, "  qsearch nodes %s  (q/full = %.2f)\n",
+        DisplayKMB(st->q_nodes, 0), (double) st->q_nodes / Max(st->full_nodes,
+            1));
+    Print(16, "        evaluations         %s", DisplayKMB(st->evaluations, 0));
+    Print(16, "  lazy exits %s (%.1f%%)\n", DisplayKMB(st->lazy_exits, 0),
+        100.0 * st->lazy_exits / Max(st->evaluations, 1));
+  }
+#else
+  Print(4095, "search statistics are not compiled in, rebuild with -DSTATS\n");
+#endif
+}
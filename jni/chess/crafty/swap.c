@@ -1,6 +1,6 @@
 #include "chess.h"
 #include "data.h"
-/* last modified 05/16/14 */
+/* last modified 10/18/26 */
 /*
  *******************************************************************************
  *                                                                             *
@@ -18,9 +18,14 @@
  *   and then add those in to the attackers, removing any attacks that have    *
  *   already been used.                                                        *
  *                                                                             *
+ *   Most of the moves we are asked about land on a square the opponent does   *
+ *   not attack at all, so we first check that using the attack maps for this  *
+ *   ply (see AttackMap()) which are shared with the other Swap() calls and    *
+ *   LegalMove() calls at this node.                                           *
+ *                                                                             *
  *******************************************************************************
  */
-int Swap(TREE * RESTRICT tree, int move, int wtm) {
+int Swap(TREE * RESTRICT tree, int ply, int move, int wtm) {
   uint64_t attacks, temp = 0, toccupied = OccupiedSquares;
   uint64_t bsliders =
       Bishops(white) | Bishops(black) | Queens(white) | Queens(black);
@@ -29,7 +34,22 @@ int Swap(TREE * RESTRICT tree, int move, int wtm) {
   int attacked_piece, piece, nc = 1, swap_list[32];
   int source = From(move);
   int target = To(move);
+  uint64_t *enemy_attacks = AttackMap(tree, ply, Flip(wtm));
 
+/*
+ ************************************************************
+ *                                                          *
+ *  If the opponent does not attack <target>, and has no    *
+ *  slider bearing on <source> that could attack <target>   *
+ *  through it once the piece moves, nothing can recapture  *
+ *  and we win whatever is captured.                        *
+ *                                                          *
+ ************************************************************
+ */
+  if (!(enemy_attacks[0] & SetMask(target)) &&
+      !((enemy_attacks[bishop] | enemy_attacks[rook] | enemy_attacks[queen])
+          & SetMask(source)))
+    return pcval[Captured(move)];
 /*
  ************************************************************
  *                                                          *
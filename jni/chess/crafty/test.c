@@ -0,0 +1,162 @@
+#include "chess.h"
+#include "data.h"
+/* last modified 10/19/26 */
+/*
+ *******************************************************************************
+ *                                                                             *
+ *   Test() is used to run a suite of test positions ("test <file> [exitcnt]   *
+ *   [workers=N]").  The file is EPD, and each record should carry a "bm"      *
+ *   (best move) or an "am" (avoid move) opcode.  The positions are searched   *
+ *   using the current "st", "sd" and/or "sn" limits, by the batch analysis    *
+ *   pipeline in BatchAnalyze(), so that workers=N searches N positions at a   *
+ *   time, one per forked (single-threaded) engine.  With workers=1, and       *
+ *   always on the Android build which cannot fork, the positions are searched *
+ *   one at a time by the normal parallel search with the "mt" thread count,   *
+ *   so the cores are still used.  exitcnt stops a search once the solution    *
+ *   has been the best move for that many successive iterations.               *
+ *                                                                             *
+ *   For every position solved we record the time, the nodes and the depth at  *
+ *   which the solution first appeared as best move and then stayed best for   *
+ *   the rest of the search (see Output() and Iterate()).  The per-position    *
+ *   results go to <file>.jsonl in the current directory, and a summary table  *
+ *   is printed at the end, including the total time and nodes needed to       *
+ *   solve the positions that were solved, so that tactical strength can be    *
+ *   compared between versions independent of raw speed.                       *
+ *                                                                             *
+ *******************************************************************************
+ */
+void Test(char *filename, int workers) {
+  FILE *results;
+  char test_name[FILENAME_MAX], result_name[FILENAME_MAX], line[4096];
+  char id[256], move[16], *base, *field;
+  int total = 0, solved = 0, errors = 0, depth;
+  unsigned int time, total_time = 0, solve_time = 0;
+  uint64_t nodes, total_nodes = 0, solve_nodes = 0;
+
+/*
+ ************************************************************
+ *                                                          *
+ *  A test needs some limit, otherwise the first position   *
+ *  that is not solved would be searched forever.           *
+ *                                                          *
+ ************************************************************
+ */
+  if (!search_time_limit && !search_depth && !search_nodes) {
+    Print(4095, "ERROR, set a search limit (st, sd or sn) before testing\n");
+    return;
+  }
+  strcpy(test_name, filename);
+  base = strrchr(test_name, '/');
+  sprintf(result_name, "%s.jsonl", (base) ? base + 1 : test_name);
+  BatchAnalyze(test_name, result_name, workers, search_depth, search_nodes,
+      search_time_limit, 0);
+  if (!(results = fopen(result_name, "r"))) {
+    Print(4095, "ERROR, unable to read %s\n", result_name);
+    return;
+  }
+/*
+ ************************************************************
+ *                                                          *
+ *  Read the results back and display one line per          *
+ *  position, followed by the totals.                       *
+ *                                                          *
+ ************************************************************
+ */
+  Print(4095, "\n  position            result  depth    time        nodes"
+      "  move\n");
+  while (fgets(line, sizeof(line), results)) {
+    total++;
+    id[0] = 0;
+    move[0] = 0;
+    if ((field = TestField(line, "id")))
+      sscanf(field, "\"%255[^\"]", id);
+    if (!id[0])
+      sprintf(id, "%d", total);
+    if (TestField(line, "error")) {
+      errors++;
+      Print(4095, "  %-18.18s  error\n", id);
+      continue;
+    }
+    if ((field = TestField(line, "bestmove")))
+      sscanf(field, "\"%15[^\"]", move);
+    nodes = 0;
+    time = 0;
+    if ((field = TestField(line, "nodes")))
+      sscanf(field, "%" SCNu64, &nodes);
+    if ((field = TestField(line, "time")))
+      sscanf(field, "%u", &time);
+    total_nodes += nodes;
+    total_time += time;
+    if (!(field = TestField(line, "solved")))
+      Print(4095, "  %-18.18s  no bm/am %4s  %6s  %11s  %s\n", id, "-", "-",
+          "-", move);
+    else if (strncmp(field, "true", 4))
+      Print(4095, "  %-18.18s  failed   %4s  %6s  %11s  %s\n", id, "-", "-",
+          "-", move);
+    else {
+      solved++;
+      depth = 0;
+      time = 0;
+      nodes = 0;
+      if ((field = TestField(line, "solution_depth")))
+        sscanf(field, "%d", &depth);
+      if ((field = TestField(line, "solution_time")))
+        sscanf(field, "%u", &time);
+      if ((field = TestField(line, "solution_nodes")))
+        sscanf(field, "%" SCNu64, &nodes);
+      solve_time += time;
+      solve_nodes += nodes;
+      Print(4095, "  %-18.18s  solved   %4d  %s  %11" PRIu64 "  %s\n", id,
+          depth, DisplayTime(time), nodes, move);
+    }
+  }
+  fclose(results);
+  Print(4095, "\n  solved %d of %d positions (%.1f%%)", solved, total - errors,
+      100.0 * solved / Max(total - errors, 1));
+  if (errors)
+    Print(4095, ", %d illegal", errors);
+  Print(4095, "\n  time to solution:   %s", DisplayTime(solve_time));
+  Print(4095, "   total search time: %s\n", DisplayTime(total_time));
+  Print(4095, "  nodes to solution:  %s", DisplayKMB(solve_nodes, 0));
+  Print(4095, "   total nodes: %s", DisplayKMB(total_nodes, 0));
+  Print(4095, "   nps: %s\n", DisplayKMB(total_nodes * 1000 / Max(total_time,
+              1), 0));
+  Print(4095, "  results written to %s\n", result_name);
+}
+
+/* last modified 10/18/26 */
+/*
+ *******************************************************************************
+ *                                                                             *
+ *   TestField() finds "key": in a JSON result line written by BatchWorker()   *
+ *   and returns a pointer to the value that follows it, or NULL if the line   *
+ *   does not have that field.                                                 *
+ *                                                                             *
+ *******************************************************************************
+ */
+char *TestField(char *line, char *key) {
+  char pattern[64], *field;
+
+  sprintf(pattern, "\"%s\":", key);
+  if (!(field = strstr(line, pattern)))
+    return 0;
+  return field + strlen(pattern);
+}
+
+/* last modified 10/18/26 */
+/*
+ *******************************************************************************
+ *                                                                             *
+ *   TestSolution() returns 1 if "move" solves the current test position,      *
+ *   that is, it is one of the "bm" moves, or it is none of the "am" moves.    *
+ *                                                                             *
+ *******************************************************************************
+ */
+int TestSolution(int move) {
+  int i;
+
+  for (i = 0; i < number_of_solutions; i++)
+    if (solutions[i] == move)
+      return !solution_type;
+  return solution_type;
+}
@@ -88,7 +88,8 @@
  *   for obvious reasons).  Pick the value with the smallest overall search    *
  *   time.  The more cores you use, the more times you should run each test,   *
  *   since parallel search is highly non-deterministic and you need several    *
- *   runs to get a reasonable average.                                         *
+ *   runs to get a reasonable average.  The "smptune" command automates this   *
+ *   procedure using the bench positions (see AutoTune() in autotune.c).       *
  *                                                                             *
  *   A few basic "rules of the road" for anyone interested in changing or      *
  *   adding to any of this code.                                               *
@@ -105,9 +106,11 @@
  *       Modifying those falls under the next lock below.                      *
  *                                                                             *
  *   3.  If you want to modify any SMP-related data, such as allocating a      *
- *       split block, or telling sibling processes to stop, etc, then you must *
- *       acquire the global "smp_lock" lock first.  This prevents any sort of  *
- *       race condition that could corrupt the split block tree organization.  *
+ *       split block or changing the sibling chains, then you must acquire the *
+ *       global "smp_lock" lock first.  The one exception is telling sibling   *
+ *       threads to stop, which is done lock-free by ThreadStop().  This       *
+ *       prevents any sort of race condition that could corrupt the split      *
+ *       block tree organization.                                              *
  *       This applies to ANY smp-related variable from the simple smp_idle     *
  *       variable through the various sibling chains and such.                 *
  *                                                                             *
@@ -148,13 +151,13 @@ int Thread(TREE * RESTRICT tree) {
  *                                                          *
  ************************************************************
  */
-  Lock(lock_smp);
+  SpinLockTimed(lock_smp, tree->thread_id, LOCK_SMP);
   for (tid = 0; tid < smp_max_threads; tid++)
     if (thread[tid].idle)
       break;
   if (tid == smp_max_threads) {
     smp_split = 0;
-    Unlock(lock_smp);
+    SpinUnlock(lock_smp);
     return 0;
   }
 /*
@@ -200,6 +203,7 @@ int Thread(TREE * RESTRICT tree) {
  */
   thread[tree->thread_id].tree = 0;
   tree->nprocs = 0;
+  tree->cancel_time = 0;
   for (tid = 0; tid < smp_max_threads; tid++)
     tree->siblings[tid] = 0;
   for (tid = 0; tid < smp_max_threads; tid++) {
@@ -214,6 +218,7 @@ int Thread(TREE * RESTRICT tree) {
   }
   thread[tree->thread_id].tree = GetBlock(tree, tree->thread_id);
   parallel_splits++;
+  thread[tree->thread_id].stats.splits++;
 /*
  ************************************************************
  *                                                          *
@@ -254,12 +259,12 @@ int Thread(TREE * RESTRICT tree) {
  *                                                          *
  ************************************************************
  */
-  Unlock(lock_smp);
+  SpinUnlock(lock_smp);
   ThreadWait(tree->thread_id, tree);
   return 1;
 }
 
-/* modified 09/18/14 */
+/* modified 10/18/26 */
 /*
  *******************************************************************************
  *                                                                             *
@@ -288,6 +293,7 @@ void CopyFromParent(TREE * RESTRICT child) {
   child->rep_index = parent->rep_index;
   for (i = 0; i <= parent->rep_index + parent->ply; i++)
     child->rep_list[i] = parent->rep_list[i];
+  memcpy(child->rep_filter, parent->rep_filter, sizeof(child->rep_filter));
   for (i = ply - 1; i < MAXPLY; i++)
     child->killers[i] = parent->killers[i];
   for (i = ply - 1; i <= ply; i++) {
@@ -308,6 +314,8 @@ void CopyFromParent(TREE * RESTRICT child) {
   child->egtb_probes_successful = 0;
   child->extensions_done = 0;
   child->qchecks_done = 0;
+  child->attack_map_hits = 0;
+  child->attack_map_fills = 0;
   child->moves_fpruned = 0;
   for (i = 0; i < 16; i++)
     child->LMR_done[i] = 0;
@@ -322,7 +330,7 @@ void CopyFromParent(TREE * RESTRICT child) {
   strcpy(child->remaining_moves_text, parent->remaining_moves_text);
 }
 
-/* modified 09/18/14 */
+/* modified 10/18/26 */
 /*
  *******************************************************************************
  *                                                                             *
@@ -333,7 +341,7 @@ void CopyFromParent(TREE * RESTRICT child) {
  *******************************************************************************
  */
 void CopyToParent(TREE * RESTRICT parent, TREE * RESTRICT child, int value) {
-  int i, ply = parent->ply;
+  int i, ply = parent->ply, stopped = child->stop || ThreadCancelled(child);
 
 /*
  ************************************************************
@@ -350,12 +358,18 @@ void CopyToParent(TREE * RESTRICT parent, TREE * RESTRICT child, int value) {
  *                                                          *
  ************************************************************
  */
-  if (child->nodes_searched && !child->stop && value > parent->value &&
+  if (child->nodes_searched && !stopped && value > parent->value &&
       !abort_search) {
     parent->pv[ply] = child->pv[ply];
     parent->value = value;
     parent->cutmove = child->curmv[ply];
   }
+  if (parent->thread_id != child->thread_id)
+    thread[child->thread_id].stats.helper_nodes += child->nodes_searched;
+  if (stopped) {
+    thread[child->thread_id].stats.aborts++;
+    thread[child->thread_id].stats.aborted_nodes += child->nodes_searched;
+  }
   parent->nodes_searched += child->nodes_searched;
   parent->fail_highs += child->fail_highs;
   parent->fail_high_first_move += child->fail_high_first_move;
@@ -364,6 +378,8 @@ void CopyToParent(TREE * RESTRICT parent, TREE * RESTRICT child, int value) {
   parent->egtb_probes_successful += child->egtb_probes_successful;
   parent->extensions_done += child->extensions_done;
   parent->qchecks_done += child->qchecks_done;
+  parent->attack_map_hits += child->attack_map_hits;
+  parent->attack_map_fills += child->attack_map_fills;
   parent->moves_fpruned += child->moves_fpruned;
   for (i = 1; i < 16; i++)
     parent->LMR_done[i] += child->LMR_done[i];
@@ -427,6 +443,7 @@ TREE *GetBlock(TREE * RESTRICT parent, int tid) {
   child->nprocs = 0;
   child->stop = 0;
   child->parent = parent;
+  child->parent_epoch = AtomicLoadRelaxed(&parent->epoch);
   thread[tid].idle = 0;
   child->thread_id = tid;
   parent->nprocs++;
@@ -459,17 +476,21 @@ TREE *GetBlock(TREE * RESTRICT parent, int tid) {
  *******************************************************************************
  */
 void WaitForAllThreadsInitialized(void) {
-  while (initialized_threads < smp_max_threads);        /* Do nothing */
+  while (initialized_threads < smp_max_threads)
+    Pause();
 }
 
-/* modified 06/07/09 */
+/* modified 10/19/26 */
 /*
  *******************************************************************************
  *                                                                             *
  *   ThreadInit() is called after a process is created.  Its main task is to   *
  *   initialize the process local memory so that it will fault in and be       *
  *   allocated on the local node rather than the node where the original       *
- *   (first) process was running.  All threads will hang here via a custom     *
+ *   (first) process was running.  With -DAFFINITY the thread is first bound   *
+ *   to the CPU InitializeTopology() picked for it (smp_affinity[tid]), and a  *
+ *   failure is left in smp_bind_error[tid] for Iterate() to report, since a   *
+ *   helper thread should not print.  All threads will hang here via a custom  *
  *   WaitForALlThreadsInitialized() procedure so that all the local thread     *
  *   blocks are usable before the search actually begins.                      *
  *                                                                             *
@@ -478,14 +499,12 @@ void WaitForAllThreadsInitialized(void) {
 void *STDCALL ThreadInit(void *t) {
   int i, tid = (int64_t) t;
 #if defined(AFFINITY)
-  int64_t k;
   cpu_set_t cpuset;
-  pthread_t current_thread = pthread_self();
 
-  k = (int64_t) tid;
   CPU_ZERO(&cpuset);
-  CPU_SET(k, &cpuset);
-  pthread_setaffinity_np(current_thread, sizeof(cpu_set_t), &cpuset);
+  CPU_SET(smp_affinity[tid], &cpuset);
+  smp_bind_error[tid] =
+      (sched_setaffinity(0, sizeof(cpu_set_t), &cpuset)) ? errno : 0;
 #endif
 #if !defined(UNIX)
   ThreadMalloc((uint64_t) tid);
@@ -495,16 +514,16 @@ void *STDCALL ThreadInit(void *t) {
         sizeof(TREE));
     block[(uint64_t) tid * MAX_BLOCKS_PER_CPU + i + 1]->used = 0;
     block[(uint64_t) tid * MAX_BLOCKS_PER_CPU + i + 1]->parent = NULL;
-    LockInit(block[(uint64_t) tid * MAX_BLOCKS_PER_CPU + i + 1]->lock);
+    SpinLockInit(block[(uint64_t) tid * MAX_BLOCKS_PER_CPU + i + 1]->lock);
   }
-  Lock(lock_smp);
+  SpinLock(lock_smp);
   initialized_threads++;
-  Unlock(lock_smp);
+  SpinUnlock(lock_smp);
   WaitForAllThreadsInitialized();
   ThreadWait(tid, (TREE *) 0);
-  Lock(lock_smp);
+  SpinLock(lock_smp);
   smp_threads--;
-  Unlock(lock_smp);
+  SpinUnlock(lock_smp);
   return 0;
 }
 
@@ -530,12 +549,12 @@ void ThreadMalloc(int64_t tid) {
                   127, tid)));
     block[i]->used = 0;
     block[i]->parent = NULL;
-    LockInit(block[i]->lock);
+    SpinLockInit(block[i]->lock);
   }
 }
 #endif
 
-/* modified 01/17/09 */
+/* modified 10/18/26 */
 /*
  *******************************************************************************
  *                                                                             *
@@ -543,24 +562,57 @@ void ThreadMalloc(int64_t tid) {
  *   cutoff (fail high) at a node that is being searched in parallel.  We need *
  *   to stop all threads here, and since this threading algorithm is recursive *
  *   it may be necessary to stop other threads that are helping search this    *
- *   branch further down into the tree.  This function simply sets appropriate *
- *   tree->stop variables to 1, which will stop those particular threads       *
- *   instantly and return them to the idle loop in ThreadWait().               *
+ *   branch further down into the tree.                                        *
+ *                                                                             *
+ *   Rather than walking the sibling tree and locking each split block to set  *
+ *   its stop flag, each split block carries a cancellation epoch, and every   *
+ *   child block remembers the value its parent's epoch had when the child was *
+ *   handed out.  Stopping everyone below a split point is then one compare-   *
+ *   and-swap on the parent's epoch.  Each thread notices the change the next  *
+ *   time it enters Search() (see ThreadCancelled()), sets its own stop flag,  *
+ *   and unwinds back to the idle loop in ThreadWait().  A helper working in a *
+ *   nested split below a stopped block sees it the same way, since the check  *
+ *   walks all the way up the parent chain.                                    *
+ *                                                                             *
+ *   The compare-and-swap also replaces the old "if (!tree->stop)" test that   *
+ *   was done under lock_smp:  if two threads fail high at the same split      *
+ *   point, only the first one succeeds and gets a 1 back.  The winner then    *
+ *   re-reads its own epoch so that it is not considered stopped itself, and   *
+ *   its score is backed up by CopyToParent() as usual.                        *
  *                                                                             *
  *******************************************************************************
  */
-void ThreadStop(TREE * RESTRICT tree) {
-  int proc;
+int ThreadStop(TREE * RESTRICT tree) {
+  TREE *parent = tree->parent;
+  int epoch = tree->parent_epoch;
 
-  Lock(tree->lock);
-  tree->stop = 1;
-  for (proc = 0; proc < smp_max_threads; proc++)
-    if (tree->siblings[proc])
-      ThreadStop(tree->siblings[proc]);
-  Unlock(tree->lock);
+  if (tree->stop || ThreadCancelled(tree) ||
+      !AtomicCompareExchange(&parent->epoch, epoch, epoch + 1))
+    return 0;
+  tree->parent_epoch = epoch + 1;
+  parent->cancel_time = LockClock();
+  return 1;
 }
 
-/* modified 09/18/14 */
+/* modified 10/18/26 */
+/*
+ *******************************************************************************
+ *                                                                             *
+ *   ThreadCancelled() returns 1 if any split point above this block has been  *
+ *   stopped by ThreadStop() since this block (or one of its ancestors) was    *
+ *   handed out.  This only reads epochs that change once per cutoff, so the   *
+ *   cache lines stay shared and the walk costs a few loads per node.          *
+ *                                                                             *
+ *******************************************************************************
+ */
+int ThreadCancelled(TREE * RESTRICT tree) {
+  for (; tree->parent; tree = tree->parent)
+    if (AtomicLoadRelaxed(&tree->parent->epoch) != tree->parent_epoch)
+      return 1;
+  return 0;
+}
+
+/* modified 10/19/26 */
 /*
  *******************************************************************************
  *                                                                             *
@@ -575,6 +627,7 @@ void ThreadStop(TREE * RESTRICT tree) {
  */
 int ThreadWait(int tid, TREE * RESTRICT waiting) {
   int value, tstart, tend;
+  uint64_t wait_start;
 
 /*
  ************************************************************
@@ -604,13 +657,15 @@ int ThreadWait(int tid, TREE * RESTRICT waiting) {
  */
   while (1) {
     tstart = ReadClock();
-    while (smp_split < 0);
-    Lock(lock_smp);
+    wait_start = LockClock();
+    while (smp_split < 0)
+      Pause();
+    SpinLockTimed(lock_smp, tid, LOCK_SMP);
     smp_idle++;
     if (!thread[tid].tree)
       thread[tid].idle = 1;
     smp_split = 1;
-    Unlock(lock_smp);
+    SpinUnlock(lock_smp);
 /*
  ************************************************************
  *                                                          *
@@ -618,7 +673,10 @@ int ThreadWait(int tid, TREE * RESTRICT waiting) {
  *  waiting on others to finish a block that *we* have to   *
  *  return through.  When the busy count on such a block    *
  *  hits zero, we return immediately which unwinds the      *
- *  search as it should be.                                 *
+ *  search as it should be.  An idle wait is only charged   *
+ *  from smp_stats_start, since a helper parked here        *
+ *  between searches would otherwise charge the whole gap   *
+ *  to the next search's idle_ns.                           *
  *                                                          *
  ************************************************************
  */
@@ -626,7 +684,12 @@ int ThreadWait(int tid, TREE * RESTRICT waiting) {
       Pause();
     thread[tid].idle = 0;
     tend = ReadClock();
-    Lock(lock_smp);
+    if (waiting)
+      thread[tid].stats.join_ns += LockClock() - wait_start;
+    else
+      thread[tid].stats.idle_ns +=
+          LockClock() - Max(wait_start, smp_stats_start);
+    SpinLockTimed(lock_smp, tid, LOCK_SMP);
     idle_time += tend - tstart;
     if (!thread[tid].tree)
       thread[tid].tree = waiting;
@@ -639,7 +702,7 @@ int ThreadWait(int tid, TREE * RESTRICT waiting) {
  ************************************************************
  */
     smp_idle--;
-    Unlock(lock_smp);
+    SpinUnlock(lock_smp);
 /*
  ************************************************************
  *                                                          *
@@ -660,17 +723,191 @@ int ThreadWait(int tid, TREE * RESTRICT waiting) {
  *                                                          *
  ************************************************************
  */
+    if (thread[tid].tree->parent->thread_id != tid)
+      thread[tid].stats.joins++;
     CopyFromParent(thread[tid].tree);
     value =
         SearchParallel(thread[tid].tree, thread[tid].tree->alpha,
         thread[tid].tree->beta, thread[tid].tree->value,
         thread[tid].tree->wtm, thread[tid].tree->depth, thread[tid].tree->ply,
         thread[tid].tree->in_check);
-    Lock(thread[tid].tree->parent->lock);
+    SpinLockTimed(thread[tid].tree->parent->lock, tid, LOCK_TREE);
     CopyToParent((TREE *) thread[tid].tree->parent, thread[tid].tree, value);
     thread[tid].tree->parent->nprocs--;
     thread[tid].tree->parent->siblings[tid] = 0;
-    Unlock(thread[tid].tree->parent->lock);
+    if (!thread[tid].tree->parent->nprocs &&
+        thread[tid].tree->parent->cancel_time) {
+      thread[tid].stats.cancels++;
+      thread[tid].stats.cancel_ns +=
+          LockClock() - thread[tid].tree->parent->cancel_time;
+      thread[tid].tree->parent->cancel_time = 0;
+    }
+    SpinUnlock(thread[tid].tree->parent->lock);
     thread[tid].tree = 0;
   }
 }
+
+/* modified 10/19/26 */
+/*
+ *******************************************************************************
+ *                                                                             *
+ *   ThreadLockStats() displays (or clears) the contention counters kept in    *
+ *   each spinlock.  The split block locks are summed over all split blocks,   *
+ *   since they are all the same lock class.  "contended" is the number of     *
+ *   acquisitions that found the lock held, and "spins" is the average number  *
+ *   of Pause() iterations such an acquisition had to wait.  A short critical  *
+ *   section shows a low contended rate and only a few spins; anything else    *
+ *   suggests that site should park on a mutex rather than spin.  "clear" only *
+ *   zeroes the counters, the lock words are left alone since other threads    *
+ *   may be holding or spinning on them.  The counters only exist in the UNIX  *
+ *   spinlock_t, the Windows build maps spinlock_t to a bare lock_t.           *
+ *                                                                             *
+ *******************************************************************************
+ */
+void ThreadLockStats(int clear) {
+#if (CPUS > 1) && defined(UNIX)
+  spinlock_t *locks[3] = { &lock_smp, &lock_split, &lock_root };
+  char *names[3] = { "lock_smp", "lock_split", "lock_root" };
+  spinlock_t tree_locks;
+  int i;
+
+  SpinLockInit(tree_locks);
+  for (i = 0; i <= MAX_BLOCKS; i++)
+    if (block[i]) {
+      if (clear)
+        SpinLockClearStats(block[i]->lock);
+      tree_locks.acquires += block[i]->lock.acquires;
+      tree_locks.contended += block[i]->lock.contended;
+      tree_locks.spins += block[i]->lock.spins;
+    }
+  if (clear) {
+    for (i = 0; i < 3; i++)
+      SpinLockClearStats(*locks[i]);
+    Print(128, "lock contention counters cleared.\n");
+    return;
+  }
+  Print(128, "lock           acquires  contended       spins/contended\n");
+  for (i = 0; i < 4; i++) {
+    spinlock_t *l = (i < 3) ? locks[i] : &tree_locks;
+
+    Print(128, "%-12s %10" PRIu64 " %10" PRIu64 " (%5.2f%%) %10.1f\n",
+        (i < 3) ? names[i] : "tree->lock", l->acquires, l->contended,
+        100.0 * l->contended / Max(l->acquires, 1),
+        (double) l->spins / Max(l->contended, 1));
+  }
+#else
+  Print(128, "lock statistics require a UNIX SMP build (CPUS > 1).\n");
+#endif
+}
+
+/* modified 10/19/26 */
+/*
+ *******************************************************************************
+ *                                                                             *
+ *   ThreadPlacement() displays the logical CPU each search thread is bound to *
+ *   along with the capacity, cluster and core InitializeTopology() read for   *
+ *   that CPU, and why the binding failed if it did.                           *
+ *                                                                             *
+ *******************************************************************************
+ */
+void ThreadPlacement(void) {
+  int tid;
+  CPU_INFO *cpu;
+
+#if !defined(AFFINITY)
+  Print(128, "thread placement is left to the OS (built without "
+      "-DAFFINITY).\n");
+#endif
+  for (tid = 0; tid < Max(smp_max_threads, 1); tid++) {
+    cpu = &smp_cpus[tid % Max(smp_ncpus, 1)];
+    Print(128, "thread %2d -> cpu %3d  capacity=%-5d cluster=%-2d core=%d",
+        tid, smp_affinity[tid], cpu->capacity, cpu->cluster, cpu->core);
+#if defined(AFFINITY)
+    if (smp_bind_error[tid])
+      Print(128, "  (not bound: %s)", strerror(smp_bind_error[tid]));
+#endif
+    Print(128, "\n");
+  }
+}
+
+/* modified 10/18/26 */
+/*
+ *******************************************************************************
+ *                                                                             *
+ *   ThreadStats() displays the per-thread SMP counters for the last search.   *
+ *   format=0 produces the human-readable table shown with the end-of-search   *
+ *   statistics, format=1 produces one JSON object per thread (plus a totals   *
+ *   object) for scripts via the "smpstats" command.                           *
+ *                                                                             *
+ *     splits   split points this thread initiated.                            *
+ *     joins    split points this thread helped at (its own excluded).         *
+ *     n/join   nodes searched per join, the useful work per split.            *
+ *     idle     time in ThreadWait() with nothing to do (starvation).          *
+ *     join     time a split owner waited in ThreadWait() for helpers.         *
+ *     smp/split/root/tree  time spinning on each lock class.                  *
+ *     aborts   helper blocks stopped by ThreadStop() and the nodes they had   *
+ *              searched, which were thrown away.                              *
+ *     cancels  split points stopped by a cutoff, and the average time from    *
+ *              the cutoff until the last helper was back in ThreadWait().     *
+ *                                                                             *
+ *******************************************************************************
+ */
+void ThreadStats(int format) {
+  SMP_STATS *st, total;
+  char label[16];
+  int tid, i, nthreads = Max(smp_max_threads, 1);
+
+  memset(&total, 0, sizeof(SMP_STATS));
+  if (!format)
+    Print(16, "        thread  splits   joins  n/join   idle   join"
+        "    smp  split   root   tree  aborts/nodes  cancels/us\n");
+  for (tid = 0; tid <= nthreads; tid++) {
+    if (tid < nthreads) {
+      st = &thread[tid].stats;
+      total.splits += st->splits;
+      total.joins += st->joins;
+      total.helper_nodes += st->helper_nodes;
+      total.aborts += st->aborts;
+      total.aborted_nodes += st->aborted_nodes;
+      total.idle_ns += st->idle_ns;
+      total.join_ns += st->join_ns;
+      for (i = 0; i < 4; i++)
+        total.lock_ns[i] += st->lock_ns[i];
+      total.cancels += st->cancels;
+      total.cancel_ns += st->cancel_ns;
+    } else
+      st = &total;
+    if (format) {
+      if (tid < nthreads)
+        sprintf(label, "%d", tid);
+      else
+        strcpy(label, "\"total\"");
+      Print(128, "{\"thread\":%s, \"splits\":%" PRIu64 ", \"joins\":%"
+          PRIu64 ", \"helper_nodes\":%" PRIu64 ", \"idle_ns\":%" PRIu64
+          ", \"join_ns\":%" PRIu64 ", \"lock_smp_ns\":%" PRIu64
+          ", \"lock_split_ns\":%" PRIu64 ", \"lock_root_ns\":%" PRIu64
+          ", \"lock_tree_ns\":%" PRIu64 ", \"aborts\":%" PRIu64
+          ", \"aborted_nodes\":%" PRIu64 ", \"cancels\":%" PRIu64
+          ", \"cancel_ns\":%" PRIu64 "}\n", label, st->splits, st->joins,
+          st->helper_nodes, st->idle_ns, st->join_ns, st->lock_ns[LOCK_SMP],
+          st->lock_ns[LOCK_SPLIT], st->lock_ns[LOCK_ROOT],
+          st->lock_ns[LOCK_TREE], st->aborts, st->aborted_nodes, st->cancels,
+          st->cancel_ns);
+      continue;
+    }
+    if (tid < nthreads)
+      Print(16, "        %6d", tid);
+    else
+      Print(16, "         total");
+    Print(16, "  %6s", DisplayKMB(st->splits, 0));
+    Print(16, "  %6s", DisplayKMB(st->joins, 0));
+    Print(16, "  %6s", DisplayKMB(st->helper_nodes / Max(st->joins, 1), 0));
+    Print(16, " %6.2f %6.2f", st->idle_ns / 1e9, st->join_ns / 1e9);
+    for (i = 0; i < 4; i++)
+      Print(16, " %6.3f", st->lock_ns[i] / 1e9);
+    Print(16, "  %s", DisplayKMB(st->aborts, 0));
+    Print(16, "/%-6s", DisplayKMB(st->aborted_nodes, 0));
+    Print(16, "  %s", DisplayKMB(st->cancels, 0));
+    Print(16, "/%" PRIu64 "\n", st->cancel_ns / Max(st->cancels, 1) / 1000);
+  }
+}
@@ -1,4 +1,5 @@
 #include <math.h>
+#include <time.h>
 #include "chess.h"
 #include "data.h"
 /* last modified 02/23/14 */
@@ -37,7 +38,7 @@ void TimeAdjust(int time_used, int side) {
     tc_time_remaining[side] += tc_increment;
 }
 
-/* last modified 02/23/14 */
+/* last modified 10/18/26 */
 /*
  *******************************************************************************
  *                                                                             *
@@ -58,6 +59,10 @@ void TimeAdjust(int time_used, int side) {
  *   modified by the "difficulty value), we will stop and not try another      *
  *   iteration."                                                               *
  *                                                                             *
+ *   When a busy check does end the search, the deadline it tripped over is    *
+ *   left in "time_abort_deadline" so Iterate() can report how far past that   *
+ *   deadline the search actually stopped.                                     *
+ *                                                                             *
  *   The "difficulty" value is used to implement the concept of an "easy move" *
  *   or a "hard move".  With an easy move, we want to spend less time since    *
  *   the easy move is obvious.  The opposite idea is a hard move, where we     *
@@ -161,8 +166,11 @@ int TimeCheck(TREE * RESTRICT tree, int busy) {
  */
   if (pondering || analyze_mode)
     return 0;
-  if (time_used > absolute_time_limit)
+  if (time_used > absolute_time_limit) {
+    if (busy)
+      time_abort_deadline = absolute_time_limit;
     return 1;
+  }
 /*
  ************************************************************
  *                                                          *
@@ -175,8 +183,9 @@ int TimeCheck(TREE * RESTRICT tree, int busy) {
   if (search_time_limit) {
     if (time_used < time_limit)
       return 0;
-    else
-      return 1;
+    if (busy)
+      time_abort_deadline = time_limit;
+    return 1;
   }
 /*
  ************************************************************
@@ -213,8 +222,10 @@ int TimeCheck(TREE * RESTRICT tree, int busy) {
   for (i = 0; i < n_root_moves; i++)
     if (root_moves[i].status & 8)
       ndone++;
-  if (ndone == 1 && !(root_moves[0].status & 1))
+  if (ndone == multipv_index + 1 && !(root_moves[multipv_index].status & 1)) {
+    time_abort_deadline = difficulty * time_limit / 100;
     return 1;
+  }
 /*
  ************************************************************
  *                                                          *
@@ -227,12 +238,14 @@ int TimeCheck(TREE * RESTRICT tree, int busy) {
  *                                                          *
  ************************************************************
  */
-  if (time_used + 300 > tc_time_remaining[root_wtm])
+  if (time_used + 3000 > tc_time_remaining[root_wtm]) {
+    time_abort_deadline = tc_time_remaining[root_wtm] - 3000;
     return 1;
+  }
   return 0;
 }
 
-/* last modified 02/23/14 */
+/* last modified 10/18/26 */
 /*
  *******************************************************************************
  *                                                                             *
@@ -242,6 +255,9 @@ int TimeCheck(TREE * RESTRICT tree, int busy) {
  *   and uses these values to calculate how much time should be spent on the   *
  *   next search.                                                              *
  *                                                                             *
+ *   All of the times here, like every other time in Crafty, are in            *
+ *   milliseconds as returned by ReadClock().                                  *
+ *                                                                             *
  *******************************************************************************
  */
 void TimeSet(int search_type) {
@@ -280,24 +296,24 @@ void TimeSet(int search_type) {
           (tc_time_remaining[root_wtm] -
           tc_operator_time * tc_moves_remaining[root_wtm]) /
           (ponder ? 20 : 26) + tc_increment;
-      if (tc_time_remaining[root_wtm] < 500 + tc_increment) {
+      if (tc_time_remaining[root_wtm] < 5000 + tc_increment) {
         time_limit = tc_increment;
-        if (tc_time_remaining[root_wtm] < 250 + tc_increment)
+        if (tc_time_remaining[root_wtm] < 2500 + tc_increment)
           time_limit /= 2;
       }
       absolute_time_limit = tc_time_remaining[root_wtm] / 2 + tc_increment;
       if (absolute_time_limit < time_limit ||
-          tc_time_remaining[root_wtm] - time_limit < 100)
+          tc_time_remaining[root_wtm] - time_limit < 1000)
         absolute_time_limit = time_limit;
-      if (tc_time_remaining[root_wtm] - time_limit < 50) {
-        time_limit = tc_time_remaining[root_wtm] - 50;
-        if (time_limit < 5)
-          time_limit = 5;
+      if (tc_time_remaining[root_wtm] - time_limit < 500) {
+        time_limit = tc_time_remaining[root_wtm] - 500;
+        if (time_limit < 50)
+          time_limit = 50;
       }
-      if (tc_time_remaining[root_wtm] - absolute_time_limit < 25) {
-        absolute_time_limit = tc_time_remaining[root_wtm] - 25;
-        if (absolute_time_limit < 5)
-          absolute_time_limit = 5;
+      if (tc_time_remaining[root_wtm] - absolute_time_limit < 250) {
+        absolute_time_limit = tc_time_remaining[root_wtm] - 250;
+        if (absolute_time_limit < 50)
+          absolute_time_limit = 50;
       }
 
     } else {
@@ -347,10 +363,10 @@ void TimeSet(int search_type) {
   }
   if (surplus < 0)
     surplus = 0;
-  if (tc_increment > 200 && moves_out_of_book < 2)
+  if (tc_increment > 2000 && moves_out_of_book < 2)
     time_limit *= 1.2;
   if (time_limit <= 0)
-    time_limit = 5;
+    time_limit = 50;
   absolute_time_limit =
       time_limit + surplus / 2 + ((tc_time_remaining[root_wtm] -
           tc_operator_time * tc_moves_remaining[root_wtm]) / 4);
@@ -411,3 +427,76 @@ void TimeSet(int search_type) {
     usage_level = 0;
   }
 }
+
+/* last modified 10/18/26 */
+/*
+ *******************************************************************************
+ *                                                                             *
+ *   TimerStart() and TimerStop() bracket the iterated search with a small     *
+ *   timer thread (TimerThread() below) that replaces counting nodes as the    *
+ *   way Search() decides when to look at the clock.  The thread sleeps until  *
+ *   the next instant TimeCheck() could change its mind (the soft target, the  *
+ *   absolute limit, or the next 1% slice of the target so that input is still *
+ *   polled) and then sets "time_check_due", which is all Search() looks at.   *
+ *   This makes deadline accuracy independent of the NPS estimate, which was   *
+ *   badly wrong for very short searches and during the first iteration.       *
+ *                                                                             *
+ *   Each timer thread is detached and tagged with a generation number, so     *
+ *   TimerStop() never waits on a sleeping thread.  A stale thread simply      *
+ *   notices that its generation is gone when it wakes and exits quietly.      *
+ *   Without POSIX threads, TimerStart() leaves "timer_running" at zero and    *
+ *   Iterate() falls back to the node-count polling it always used.            *
+ *                                                                             *
+ *******************************************************************************
+ */
+void TimerStart(void) {
+#if (CPUS > 1) && defined(UNIX)
+  pthread_t pt;
+#endif
+
+  time_check_due = 0;
+  time_abort_deadline = 0;
+#if (CPUS > 1) && defined(UNIX)
+  timer_generation++;
+  timer_running = !pthread_create(&pt, 0, TimerThread,
+      (void *) (long) timer_generation);
+  if (timer_running)
+    pthread_detach(pt);
+#endif
+}
+
+/* last modified 10/18/26 */
+void TimerStop(void) {
+  timer_generation++;
+  timer_running = 0;
+}
+
+/* last modified 10/18/26 */
+void *STDCALL TimerThread(void *arg) {
+#if (CPUS > 1) && defined(UNIX)
+  long generation = (long) arg;
+  struct timespec nap;
+  int now, wake, limit;
+
+  while (timer_generation == generation) {
+    now = (int) (ReadClock() - start_time);
+    if (pondering || analyze_mode)
+      wake = now + 100;
+    else {
+      wake = now + Max(Min(time_limit / 100, 100), 1);
+      limit =
+          (search_time_limit) ? time_limit : difficulty * time_limit / 100;
+      if (limit >= now)
+        wake = Min(wake, limit + 1);
+      if (absolute_time_limit >= now)
+        wake = Min(wake, absolute_time_limit + 1);
+    }
+    nap.tv_sec = (wake - now) / 1000;
+    nap.tv_nsec = (long) ((wake - now) % 1000) * 1000000;
+    nanosleep(&nap, 0);
+    if (timer_generation == generation)
+      time_check_due = 1;
+  }
+#endif
+  return 0;
+}
@@ -1,6 +1,6 @@
 #include "chess.h"
 #include "data.h"
-/* last modified 02/22/14 */
+/* last modified 10/18/26 */
 /*
  *******************************************************************************
  *                                                                             *
@@ -11,7 +11,8 @@
  *                                                                             *
  *******************************************************************************
  */
-void UnmakeMove(TREE * RESTRICT tree, int ply, int move, int side) {
+COLORED void UnmakeMoveColor(TREE * RESTRICT tree, int ply, int move,
+    const int side) {
   uint64_t bit_move;
   int piece, from, to, captured, promote, enemy = Flip(side);
 
@@ -26,6 +27,7 @@ void UnmakeMove(TREE * RESTRICT tree, int ply, int move, int side) {
  */
   HashKey = tree->save_hash_key[ply];
   PawnHashKey = tree->save_pawn_hash_key[ply];
+  RepFilter(HashKey)--;
 /*
  ************************************************************
  *                                                          *
@@ -44,6 +46,8 @@ void UnmakeMove(TREE * RESTRICT tree, int ply, int move, int side) {
   ClearSet(bit_move, Occupied(side));
   PcOnSq(to) = 0;
   PcOnSq(from) = pieces[side][piece];
+  PcSqSub(side, piece, to);
+  PcSqAdd(side, piece, from);
 /*
  ************************************************************
  *                                                          *
@@ -60,6 +64,7 @@ void UnmakeMove(TREE * RESTRICT tree, int ply, int move, int side) {
           Set(to + epsq[side], Pawns(enemy));
           Set(to + epsq[side], Occupied(enemy));
           PcOnSq(to + epsq[side]) = pieces[enemy][pawn];
+          PcSqAdd(enemy, pawn, to + epsq[side]);
           Material -= PieceValues(side, pawn);
           TotalPieces(enemy, pawn)++;
           captured = 0;
@@ -72,6 +77,8 @@ void UnmakeMove(TREE * RESTRICT tree, int ply, int move, int side) {
         Clear(to, Pieces(side, promote));
         Material -= PieceValues(side, promote);
         Material += PieceValues(side, pawn);
+        PcSqSub(side, promote, to);
+        PcSqAdd(side, pawn, to);
         TotalPieces(side, occupied) -= p_vals[promote];
         TotalPieces(side, promote)--;
         switch (promote) {
@@ -124,6 +131,7 @@ void UnmakeMove(TREE * RESTRICT tree, int ply, int move, int side) {
     Set(to, Pieces(enemy, captured));
     Set(to, Occupied(enemy));
     Material += PieceValues(enemy, captured);
+    PcSqAdd(enemy, captured, to);
     PcOnSq(to) = pieces[enemy][captured];
     TotalPieces(enemy, captured)++;
     if (captured != pawn)
@@ -145,8 +153,28 @@ void UnmakeMove(TREE * RESTRICT tree, int ply, int move, int side) {
         break;
     }
   }
+#if defined(NNUE)
+  if (nnue_enabled)
+    NnueUnmakeMove(tree, ply, move, side);
+#endif
 #if defined(DEBUG)
   ValidatePosition(tree, ply, move, "UnmakeMove(1)");
 #endif
   return;
 }
+
+/* last modified 10/18/26 */
+/*
+ *******************************************************************************
+ *                                                                             *
+ *   UnmakeMove() is the run-time entry point.  It calls the white or black    *
+ *   instance of UnmakeMoveColor(), mirroring MakeMove().                      *
+ *                                                                             *
+ *******************************************************************************
+ */
+void UnmakeMove(TREE * RESTRICT tree, int ply, int move, int side) {
+  if (side)
+    UnmakeMoveColor(tree, ply, move, white);
+  else
+    UnmakeMoveColor(tree, ply, move, black);
+}
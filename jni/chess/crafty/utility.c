@@ -10,6 +10,7 @@
 #  include <sys/wait.h>
 #  include <sys/times.h>
 #  include <sys/time.h>
+#  include <time.h>
 #else
 #  include <windows.h>
 #  include <winbase.h>
@@ -763,10 +764,12 @@ char *DisplayEvaluationKibitz(int value, int wtm) {
   return out;
 }
 
+/* last modified 10/18/26 */
 /*
  *******************************************************************************
  *                                                                             *
- *   DisplayPV() is used to display a PV during the search.                    *
+ *   DisplayPV() is used to display a PV during the search.  With multipv > 1  *
+ *   each line is tagged with its rank, taken from "multipv_index".            *
  *                                                                             *
  *******************************************************************************
  */
@@ -817,6 +820,8 @@ void DisplayPV(TREE * RESTRICT tree, int level, int wtm, int time, PATH * pv,
   strcpy(kibitz_text, buffer);
   if (nskip > 1 && smp_max_threads > 1)
     sprintf(buffer + strlen(buffer), " (s=%d)", nskip);
+  if (multi_pv > 1)
+    sprintf(buffer + strlen(buffer), " (pv=%d)", multipv_index + 1);
   if (time > noise_level || force) {
     noise_block = 0;
     Lock(lock_io);
@@ -857,7 +862,7 @@ void DisplayPV(TREE * RESTRICT tree, int level, int wtm, int time, PATH * pv,
 /*
  *******************************************************************************
  *                                                                             *
- *   DisplayHHMMSS is used to convert integer time values in 1/100th second    *
+ *   DisplayHHMMSS is used to convert integer time values in 1/1000th second   *
  *   units into a traditional output format for time, hh:mm:ss rather than     *
  *   just nnn.n seconds.                                                       *
  *                                                                             *
@@ -866,7 +871,7 @@ void DisplayPV(TREE * RESTRICT tree, int level, int wtm, int time, PATH * pv,
 char *DisplayHHMMSS(unsigned int time) {
   static char out[10];
 
-  time = time / 100;
+  time = time / 1000;
   sprintf(out, "%3u:%02u:%02u", time / 3600, time / 60, time % 60);
   return out;
 }
@@ -874,7 +879,7 @@ char *DisplayHHMMSS(unsigned int time) {
 /*
  *******************************************************************************
  *                                                                             *
- *   DisplayHHMM is used to convert integer time values in 1/100th second      *
+ *   DisplayHHMM is used to convert integer time values in 1/1000th second     *
  *   units into a traditional output format for time, mm:ss rather than just   *
  *   nnn.n seconds.                                                            *
  *                                                                             *
@@ -883,7 +888,7 @@ char *DisplayHHMMSS(unsigned int time) {
 char *DisplayHHMM(unsigned int time) {
   static char out[10];
 
-  time = time / 6000;
+  time = time / 60000;
   sprintf(out, "%3u:%02u", time / 60, time % 60);
   return out;
 }
@@ -938,10 +943,10 @@ char *DisplayKMB(uint64_t val, int type) {
 char *DisplayTime(unsigned int time) {
   static char out[10];
 
-  if (time < 6000)
-    sprintf(out, "%6.2f", (float) time / 100.0);
+  if (time < 60000)
+    sprintf(out, "%6.2f", (float) time / 1000.0);
   else {
-    time = time / 100;
+    time = time / 1000;
     sprintf(out, "%3u:%02u", time / 60, time % 60);
   }
   return out;
@@ -968,21 +973,21 @@ char *Display2Times(unsigned int time) {
   int ttime;
   int c, spaces;
 
-  if (time < 6000)
-    sprintf(out, "%6.2f", (float) time / 100.0);
+  if (time < 60000)
+    sprintf(out, "%6.2f", (float) time / 1000.0);
   else {
-    time = time / 100;
+    time = time / 1000;
     sprintf(out, "%3u:%02u", time / 60, time % 60);
   }
   if (search_time_limit)
     ttime = search_time_limit;
   else
     ttime = difficulty * time_limit / 100;
-  if (ttime < 360000) {
-    if (ttime < 6000)
-      sprintf(tout, "%6.2f", (float) ttime / 100.0);
+  if (ttime < 3600000) {
+    if (ttime < 60000)
+      sprintf(tout, "%6.2f", (float) ttime / 1000.0);
     else {
-      ttime = ttime / 100;
+      ttime = ttime / 1000;
       sprintf(tout, "%3u:%02u", ttime / 60, ttime % 60);
     }
     c = strspn(tout, " ");
@@ -1007,10 +1012,10 @@ char *Display2Times(unsigned int time) {
 char *DisplayTimeKibitz(unsigned int time) {
   static char out[10];
 
-  if (time < 6000)
-    sprintf(out, "%.2f", (float) time / 100.0);
+  if (time < 60000)
+    sprintf(out, "%.2f", (float) time / 1000.0);
   else {
-    time = time / 100;
+    time = time / 1000;
     sprintf(out, "%u:%02u", time / 60, time % 60);
   }
   return out;
@@ -1417,6 +1422,7 @@ int GameOver(int wtm) {
     return 2;
 }
 
+/* last modified 10/18/26 */
 /*
  *******************************************************************************
  *                                                                             *
@@ -1424,22 +1430,23 @@ int GameOver(int wtm) {
  *   varies from system to system, this procedure has several flavors to       *
  *   provide portability.                                                      *
  *                                                                             *
+ *   All of Crafty's internal times are in milliseconds.  On unix we read the  *
+ *   monotonic clock rather than the time of day, so that an NTP adjustment    *
+ *   in the middle of a search can't make time run backward or jump forward   *
+ *   and either flag us or stop a search instantly.  The value wraps after     *
+ *   about 49 days, but it is only ever used as a difference between two      *
+ *   readings, which unsigned arithmetic handles correctly.                    *
+ *                                                                             *
  *******************************************************************************
  */
 unsigned int ReadClock(void) {
 #if defined(UNIX)
-  struct timeval timeval;
-  struct timezone timezone;
-#else
-  HANDLE hThread;
-  FILETIME ftCreate, ftExit, ftKernel, ftUser;
-  uint64_t tUser64;
-#endif
-#if defined(UNIX)
-  gettimeofday(&timeval, &timezone);
-  return timeval.tv_sec * 100 + (timeval.tv_usec / 10000);
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (unsigned int) ((uint64_t) ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
 #else
-  return (unsigned int) GetTickCount() / 10;
+  return (unsigned int) GetTickCount();
 #endif
 }
 
@@ -1460,13 +1467,15 @@ int FindBlockID(TREE * RESTRICT which) {
   return -1;
 }
 
+/* last modified 10/19/26 */
 /*
  *******************************************************************************
  *                                                                             *
  *   InvalidPosition() is used to determine if the position just entered via a *
  *   FEN-string or the "edit" command is legal.  This includes the expected    *
  *   tests for too many pawns or pieces for one side, pawns on impossible      *
- *   squares, and the like.                                                    *
+ *   squares, a side without exactly one king, the side not on move being in   *
+ *   check, and the like.                                                      *
  *                                                                             *
  *******************************************************************************
  */
@@ -1504,8 +1513,8 @@ int InvalidPosition(TREE * RESTRICT tree) {
     Print(4095, "illegal position, too many white queens\n");
     error = 1;
   }
-  if (KingSQ(white) > 63) {
-    Print(4095, "illegal position, no white king\n");
+  if (PopCnt(Kings(white)) != 1) {
+    Print(4095, "illegal position, white must have exactly one king\n");
     error = 1;
   }
   if (wp + wn + wb + wr + wq > 15) {
@@ -1536,8 +1545,8 @@ int InvalidPosition(TREE * RESTRICT tree) {
     Print(4095, "illegal position, too many black queens\n");
     error = 1;
   }
-  if (KingSQ(black) > 63) {
-    Print(4095, "illegal position, no black king\n");
+  if (PopCnt(Kings(black)) != 1) {
+    Print(4095, "illegal position, black must have exactly one king\n");
     error = 1;
   }
   if (bp + bn + bb + br + bq > 15) {
@@ -1956,6 +1965,42 @@ int ReadParse(char *buffer, char *args[], char *delims) {
   return nargs;
 }
 
+/* last modified 10/19/26 */
+/*
+ *******************************************************************************
+ *                                                                             *
+ *   ReadRC() executes the commands in the rc file (rc_path/RCFILE, which is   *
+ *   ".craftyrc" on Unix and "crafty.rc" elsewhere) once at start-up, stopping *
+ *   at end of file or at a line containing "exit".  smptune writes its        *
+ *   results here.  The Android app passes rcpath=<data directory>, which is   *
+ *   where wrapper.c extracts crafty.rc on first start.                        *
+ *                                                                             *
+ *******************************************************************************
+ */
+void ReadRC(TREE * RESTRICT tree) {
+  char filename[FILENAME_MAX], *delim;
+  FILE *file;
+
+  sprintf(filename, "%s/%s", rc_path, RCFILE);
+  if (!(file = fopen(filename, "r")))
+    return;
+  while (fgets(buffer, 4096, file)) {
+    delim = strchr(buffer, '\n');
+    if (delim)
+      *delim = 0;
+    delim = strchr(buffer, '\r');
+    if (delim)
+      *delim = ' ';
+    if (!strncmp(buffer, "exit", 4))
+      break;
+    if (!buffer[0] || buffer[0] == '#')
+      continue;
+    if (!Option(tree))
+      Print(4095, "ERROR \"%s\" is unknown rc-file option\n", buffer);
+  }
+  fclose(file);
+}
+
 /*
  *******************************************************************************
  *                                                                             *
@@ -2351,19 +2396,23 @@ void RestoreGame(void) {
   }
 }
 
+/* last modified 10/18/26 */
 /*
  *******************************************************************************
  *                                                                             *
  *   Kibitz() is used to whisper/kibitz information to a chess server.  It has *
  *   to handle the xboard whisper/kibitz interface.                            *
  *                                                                             *
+ *   time is in our internal milliseconds, but the xboard "post" output is     *
+ *   defined in centiseconds, so it is scaled down for that line only.         *
+ *                                                                             *
  *******************************************************************************
  */
 void Kibitz(int level, int wtm, int depth, int time, int value,
     uint64_t nodes, int ip, int tb_hits, char *pv) {
   int nps;
 
-  nps = (int) ((time) ? 100 * nodes / (uint64_t) time : nodes);
+  nps = (int) ((time) ? 1000 * nodes / (uint64_t) time : nodes);
   if (!puzzling) {
     char prefix[128];
 
@@ -2424,16 +2473,17 @@ void Kibitz(int level, int wtm, int depth, int time, int value,
     value = (wtm) ? value : -value;
     if (post && level > 1) {
       if (strstr(pv, "book"))
-        _printf("	%2d  %5d %7d %" PRIu64 " %s\n", depth, value, time,
+        _printf("	%2d  %5d %7d %" PRIu64 " %s\n", depth, value, time / 10,
             nodes, pv + 10);
       else
-        _printf("	%2d  %5d %7d %" PRIu64 " %s\n", depth, value, time,
+        _printf("	%2d  %5d %7d %" PRIu64 " %s\n", depth, value, time / 10,
             nodes, pv);
     }
     fflush(stdout);
   }
 }
 
+/* last modified 10/18/26 */
 /*
  *******************************************************************************
  *                                                                             *
@@ -2456,7 +2506,9 @@ void Output(TREE * RESTRICT tree, int bound) {
  *                                                          *
  *  First, move the best move to the top of the ply-1 move  *
  *  list if it's not already there, so that it will be the  *
- *  first move tried in the next iteration.                 *
+ *  first move tried in the next iteration.  In multipv     *
+ *  mode "top" means the first root move that is not        *
+ *  already claimed by a better line this iteration.        *
  *                                                          *
  ************************************************************
  */
@@ -2466,14 +2518,33 @@ void Output(TREE * RESTRICT tree, int bound) {
     for (i = 0; i < n_root_moves; i++)
       if (tree->curmv[1] == root_moves[i].move)
         break;
-    if (i && i < n_root_moves) {
+    if (i > multipv_index && i < n_root_moves) {
       temp_rm = root_moves[i];
-      for (; i > 0; i--)
+      for (; i > multipv_index; i--)
         root_moves[i] = root_moves[i - 1];
-      root_moves[0] = temp_rm;
+      root_moves[multipv_index] = temp_rm;
     }
-    root_moves[0].bm_age = 4;
+    root_moves[multipv_index].bm_age = 4;
     end_time = ReadClock();
+/*
+ ************************************************************
+ *                                                          *
+ *  When running a test suite, remember when the solution   *
+ *  became the best move, and forget it again if it is      *
+ *  replaced by a move that is not a solution.  Test()      *
+ *  reports this as time/nodes/depth to solution.           *
+ *                                                          *
+ ************************************************************
+ */
+    if (number_of_solutions && !multipv_index) {
+      if (!TestSolution(tree->curmv[1]))
+        solution_depth = 0;
+      else if (!solution_depth) {
+        solution_depth = iteration_depth;
+        solution_time = end_time - start_time;
+        solution_nodes = tree->nodes_searched;
+      }
+    }
 /*
  ************************************************************
  *                                                          *
@@ -1,7 +1,7 @@
 #if defined(DEBUG)
 #  include "chess.h"
 #  include "data.h"
-/* last modified 02/26/14 */
+/* last modified 10/18/26 */
 /*
  *******************************************************************************
  *                                                                             *
@@ -25,7 +25,7 @@ void ValidatePosition(TREE * RESTRICT tree, int ply, int move, char *caller) {
   uint64_t temp, temp1, temp_occ;
   uint64_t temp_occx;
   int i, square, error;
-  int side, piece, temp_score;
+  int side, piece, temp_score, temp_eg;
 
 /*
  ************************************************************
@@ -87,6 +87,29 @@ void ValidatePosition(TREE * RESTRICT tree, int ply, int move, char *caller) {
         temp_score, Material);
     error = 1;
   }
+/*
+ ************************************************************
+ *                                                          *
+ *  Add up the piece/square values for each side to see if  *
+ *  they match the incrementally updated totals.            *
+ *                                                          *
+ ************************************************************
+ */
+  for (side = black; side <= white; side++) {
+    temp_score = 0;
+    temp_eg = 0;
+    for (square = 0; square < 64; square++)
+      if (PcOnSq(square) && (PcOnSq(square) > 0) == side) {
+        temp_score += pcsq[Abs(PcOnSq(square))][mg][side][square];
+        temp_eg += pcsq[Abs(PcOnSq(square))][eg][side][square];
+      }
+    if (temp_score != PcSqMG(side) || temp_eg != PcSqEG(side)) {
+      Print(128, "ERROR  %s piece/square is wrong, good=%d/%d, bad=%d/%d\n",
+          (side) ? "white" : "black", temp_score, temp_eg, PcSqMG(side),
+          PcSqEG(side));
+      error = 1;
+    }
+  }
 /*
  ************************************************************
  *                                                          *
@@ -20,6 +20,7 @@
 #if defined(AFFINITY)
 #  define _GNU_SOURCE
 #  include <sched.h>
+#  include <errno.h>
 #endif
 #if defined(UNIX)
 #  define _GNU_SOURCE
@@ -62,6 +63,21 @@
 #      define CDECL __cdecl
 #    endif
 #  endif
+/*
+   COLORED marks the body of a hot function that is written once for either
+   side but compiled twice, once with <side> fixed to white and once to
+   black (see MakeMove()).  The public function only tests <side> and calls
+   one of them, so Flip(), Advanced(), InFront() and the (side) ? x : y
+   choices inside fold to constants.  The body has to be inlined into both
+   calls for that to happen, so it is forced.
+ */
+#  if defined(__GNUC__) || defined(__clang__)
+#    define COLORED static __inline__ __attribute__ ((always_inline))
+#  elif defined(_MSC_VER)
+#    define COLORED static __forceinline
+#  else
+#    define COLORED static
+#  endif
 #  if !defined(BOOKDIR)
 #    define     BOOKDIR        "."
 #  endif
@@ -74,11 +90,29 @@
 #  if !defined(RCDIR)
 #    define       RCDIR        "."
 #  endif
+#  if defined(UNIX) && !defined(ANDROID_NDK)
+#    define      RCFILE ".craftyrc"
+#  else
+#    define      RCFILE "crafty.rc"
+#  endif
 #  include "lock.h"
 #  define MAXPLY                                 129
 #  define MAX_TC_NODES                      10000000
+#  define MAX_MULTIPV                             16
+#  define MAX_BATCH_WORKERS                       64
+#  define MAX_BENCH_POSITIONS                    256
+#  define MAX_BENCH_REPEATS                       64
+#  define PMU_CYCLES                               0
+#  define PMU_INSTRUCTIONS                         1
+#  define PMU_L1D_MISSES                           2
+#  define PMU_LLC_MISSES                           3
+#  define PMU_BRANCH_MISSES                        4
+#  define PMU_DTLB_MISSES                          5
+#  define PMU_COUNTERS                             6
 #  define MAX_BLOCKS_PER_CPU                      64
 #  define MAX_BLOCKS       MAX_BLOCKS_PER_CPU * CPUS
+#  define MAX_TOPOLOGY_CPUS                      256
+#  define REP_FILTER_BITS                         10
 #  define BOOK_CLUSTER_SIZE                     8000
 #  define MERGE_BLOCK                           1000
 #  define SORT_BLOCK                         4000000
@@ -95,6 +129,38 @@
 #  if !defined(CLOCKS_PER_SEC)
 #    define CLOCKS_PER_SEC 1000000
 #  endif
+/*
+ *******************************************************************************
+ *                                                                             *
+ *   -DNNUE compiles in the optional neural network evaluation (see nnue.c).   *
+ *   The network is 768 inputs (piece type and color by square, from each     *
+ *   side's point of view) -> NNUE_HIDDEN clipped-ReLU units per side -> 1     *
+ *   output.  The accumulators for the hidden layer live in POSITION and are   *
+ *   kept up to date by MakeMove()/UnmakeMove() while the network is in use.   *
+ *   The kernels that do the work use AVX2 or SSE2 on x86 and NEON on ARM,     *
+ *   whichever the compiler target has, and plain C otherwise.                 *
+ *                                                                             *
+ *******************************************************************************
+ */
+#  if defined(NNUE)
+#    define NNUE_INPUTS                          768
+#    define NNUE_HIDDEN                          128
+#    define NNUE_QA                              255
+#    define NNUE_QB                               64
+#    define NNUE_SCALE                           400
+#    if defined(__AVX2__)
+#      include <immintrin.h>
+#      define NNUE_KERNEL "avx2"
+#    elif defined(__SSE2__) || defined(_M_X64)
+#      include <emmintrin.h>
+#      define NNUE_KERNEL "sse2"
+#    elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#      include <arm_neon.h>
+#      define NNUE_KERNEL "neon"
+#    else
+#      define NNUE_KERNEL "scalar"
+#    endif
+#  endif
 typedef enum {
   A1, B1, C1, D1, E1, F1, G1, H1,
   A2, B2, C2, D2, E2, F2, G2, H2,
@@ -118,6 +184,11 @@ typedef enum { empty_v = 0, pawn_v = 1, knight_v = 3,
 } PIECE_V;
 typedef enum { think = 1, puzzle = 2, book = 3, annotate = 4 } SEARCH_TYPE;
 typedef enum { normal_mode, tournament_mode } PLAYING_MODE;
+#  if defined(COMPACT_MAGIC)
+typedef uint8_t MAGIC_ENTRY;
+#  else
+typedef uint64_t MAGIC_ENTRY;
+#  endif
 typedef struct {
   int8_t castle[2];
   uint8_t enpassant_target;
@@ -135,12 +206,16 @@ typedef struct {
   uint64_t hash_key;
   uint64_t pawn_hash_key;
   int material_evaluation;
+  int pcsq_mg[2], pcsq_eg[2];
   int kingsq[2];
   int8_t board[64];
   char pieces[2][7];
   char majors[2];
   char minors[2];
   char total_all_pieces;
+#  if defined(NNUE)
+  int16_t nnue_acc[2][NNUE_HIDDEN];
+#  endif
 } POSITION;
 typedef struct {
   uint64_t word1;
@@ -173,10 +248,24 @@ typedef struct {
   int hash_path_age;
   int hash_path_moves[MAXPLY];
 } HPATH_ENTRY;
+/*
+   per-ply attack map cache.  attacks[side][piece] is the set of squares
+   attacked by all of <side>'s pieces of that type, and attacks[side][0] is
+   the union of all six.  They are filled lazily, one side at a time, by
+   AttackMap() and are valid only while the position's hash key matches
+   key.  computed has bit <side> set once that side has been filled.
+ */
 typedef struct {
+  uint64_t key;
+  uint64_t attacks[2][7];
+  int computed;
+} ATTACK_MAP;
+typedef struct {
+  uint64_t pinned;
+  uint64_t check_mask;
   int phase;
   int remaining;
-  int *last;
+  uint64_t *last;
   int done[5];
   int excluded;
 } NEXT_MOVE;
@@ -217,6 +306,7 @@ typedef struct tree {
 /* commonly used variables */
   SEARCH_POSITION status[MAXPLY + 3];
   NEXT_MOVE next_status[MAXPLY];
+  ATTACK_MAP attack_map[MAXPLY + 3];
   KILLER killers[MAXPLY];
   POSITION position;
   uint64_t save_hash_key[MAXPLY + 3];
@@ -224,12 +314,13 @@ typedef struct tree {
   int moves_searched;
   int rep_index;
   uint64_t rep_list[256];
+  uint16_t rep_filter[1 << REP_FILTER_BITS];
   int phase[MAXPLY];
   int curmv[MAXPLY];
   int hash_move[MAXPLY];
   int *last[MAXPLY];
-  int sort_value[256];
   int move_list[5120];
+  uint64_t move_record[5120];
   PATH pv[MAXPLY];
 /* variables used by Evaluate() */
   PAWN_HASH_ENTRY pawn_score;
@@ -246,11 +337,13 @@ typedef struct tree {
   uint64_t egtb_probes_successful;
   uint64_t extensions_done;
   uint64_t qchecks_done;
+  uint64_t attack_map_hits;
+  uint64_t attack_map_fills;
   uint64_t moves_fpruned;
   uint64_t LMR_done[16];
   uint64_t null_done[32];
 /* thread stuff */
-  lock_t lock;
+  spinlock_t lock;
   int thread_id;
   volatile int stop;
   volatile int nprocs;
@@ -264,14 +357,71 @@ typedef struct tree {
   int cutmove;
   struct tree *volatile siblings[CPUS], *parent;
   volatile int used;
+  atomic_lock_word epoch;
+  int parent_epoch;
+  uint64_t cancel_time;
 /* rarely accessed */
   char root_move_text[16];
   char remaining_moves_text[16];
 } TREE;
+typedef struct {
+  int cpu;
+  int capacity;
+  int cluster;
+  int core;
+} CPU_INFO;
+/*
+   one benchmark run.  fen[] and depth[] are the position set, and the other
+   arrays hold the results of each repetition of each position.  time[] is
+   the whole search, ttd[] (time to depth) is when the last iteration was
+   completed, and idle[] is the total time the helper threads spent waiting
+   for work, all in milliseconds.  pmu[] is the sum of the hardware counters
+   over the repetitions, and pmu_valid has bit i set if pmu[][i] is usable.
+ */
+typedef struct {
+  int positions;
+  int repeats;
+  char fen[MAX_BENCH_POSITIONS][128];
+  int depth[MAX_BENCH_POSITIONS];
+  uint64_t nodes[MAX_BENCH_POSITIONS][MAX_BENCH_REPEATS];
+  uint64_t evals[MAX_BENCH_POSITIONS][MAX_BENCH_REPEATS];
+  unsigned int time[MAX_BENCH_POSITIONS][MAX_BENCH_REPEATS];
+  unsigned int ttd[MAX_BENCH_POSITIONS][MAX_BENCH_REPEATS];
+  unsigned int idle[MAX_BENCH_POSITIONS][MAX_BENCH_REPEATS];
+  uint64_t pmu[MAX_BENCH_POSITIONS][PMU_COUNTERS];
+  int pmu_valid;
+} BENCH;
+/*
+   per-thread SMP counters.  each is only written by its own thread, and all
+   times are nanoseconds.  idle_ns is time in ThreadWait() with nothing to do,
+   join_ns is time a split owner spends there waiting for its helpers,
+   lock_ns[] is time spent spinning on each lock class below, and cancel_ns
+   is the time from a cutoff at a split point until its last helper left.
+   smp_stats_start is when Iterate() last cleared them, and an idle wait is
+   only charged from then on, so the gap between searches is not counted.
+ */
+#  define LOCK_SMP                  0
+#  define LOCK_SPLIT                1
+#  define LOCK_ROOT                 2
+#  define LOCK_TREE                 3
+typedef struct {
+  uint64_t splits;
+  uint64_t joins;
+  uint64_t helper_nodes;
+  uint64_t aborts;
+  uint64_t aborted_nodes;
+  uint64_t idle_ns;
+  uint64_t join_ns;
+  uint64_t lock_ns[4];
+  uint64_t cancels;
+  uint64_t cancel_ns;
+} SMP_STATS;
 typedef struct thread {
   TREE *volatile tree;
   volatile int idle;
   char filler[52];
+  SMP_STATS stats;
+  char filler2[24];
 } THREAD;
 /*
    DO NOT modify these.  these are constants, used in multiple modules.
@@ -299,7 +449,80 @@ typedef struct thread {
 #  define GENERATE_ALL_MOVES        9
 #  define HISTORY_MOVES            10
 #  define REMAINING_MOVES          11
-#if defined(UNIX) || !defined(INLINEASM)
+/*
+   per-thread search counters, only compiled in with -DSTATS (see the
+   "stats" command).  searched[] and cutoffs[] are indexed by the NextMove()
+   phase the move came from (NULL_MOVE for the null-move search), so the
+   ordering of each phase can be measured.  Stat() and StatAdd() compile
+   to nothing without -DSTATS, so the hot paths pay nothing for them.
+ */
+#if defined(STATS)
+typedef struct {
+  uint64_t full_nodes;
+  uint64_t q_nodes;
+  uint64_t searched[REMAINING_MOVES + 1];
+  uint64_t cutoffs[REMAINING_MOVES + 1];
+  uint64_t capture_gens;
+  uint64_t captures_generated;
+  uint64_t noncapture_gens;
+  uint64_t noncaptures_generated;
+  uint64_t evaluations;
+  uint64_t lazy_exits;
+} SEARCH_STATS;
+#  define Stat(t, c)                search_stats[(t)->thread_id].c++
+#  define StatAdd(t, c, n)          search_stats[(t)->thread_id].c += (n)
+#else
+#  define Stat(t, c)
+#  define StatAdd(t, c, n)
+#endif
+/*
+   binary search journal (see the "journal" command and journal.c).  each
+   thread appends fixed size events to a ring buffer in its own memory-
+   mapped file:  JOURNAL_SEARCH when Search() is entered, JOURNAL_MOVE when a
+   move has been searched, JOURNAL_NULL when a null-move search returns and
+   JOURNAL_HASH when a hash hit ends a node.  move packs the move (bits
+   0-20), the NextMove() phase (21-24) and the event type (25-27).  nodes
+   is the low 32 bits of the nodes this thread has searched, so the size
+   of any subtree (qsearch included) is the difference between two events.
+   scores are clamped to 16 bits, which only affects the +/- infinite
+   window bounds.  the test in Journal() is the only cost when the
+   journal is off.
+ */
+#  define JOURNAL_SEARCH           1
+#  define JOURNAL_MOVE             2
+#  define JOURNAL_NULL             3
+#  define JOURNAL_HASH             4
+#  define JOURNAL_VERSION          1
+typedef struct {
+  uint32_t move;
+  uint32_t nodes;
+  int16_t alpha;
+  int16_t beta;
+  int16_t value;
+  uint8_t ply;
+  uint8_t depth;
+} JOURNAL_EVENT;
+typedef struct {
+  char magic[8];
+  uint32_t version;
+  uint32_t event_size;
+  uint32_t thread;
+  uint32_t unused;
+  uint64_t capacity;
+  volatile uint64_t head;
+  uint64_t nodes;
+  uint64_t last_nodes;
+  uint64_t last_tree;
+} JOURNAL_HEADER;
+#  define Journal(t, type, ply, depth, move, phase, alpha, beta, value)     \
+  do {                                                                     \
+    if (journal_buffer[(t)->thread_id])                                     \
+      JournalEvent(t, type, ply, depth, move, phase, alpha, beta, value);   \
+  } while (0)
+#if defined(INLINEASM)
+#  include "inline64.h"
+#else
+#  define BITOPS_BACKEND "table"
 int CDECL PopCnt(uint64_t);
 int CDECL MSB(uint64_t);
 int CDECL LSB(uint64_t);
@@ -316,10 +539,28 @@ void AnnotateHeaderTeX(FILE *);
 void AnnotateFooterTeX(FILE *);
 void AnnotatePositionTeX(TREE *, int, FILE *);
 uint64_t atoiKMB(char *);
+void AutoTune(int, int);
+int AutoTuneGet(int);
+void AutoTuneOnline(int);
+int AutoTuneRun(int *, int);
+void AutoTuneSave(void);
+void AutoTuneSet(int, int);
+void AutoTuneWrite(FILE *);
+uint64_t *AttackMap(TREE *RESTRICT, int, int);
 int Attacks(TREE *RESTRICT, int, int);
 uint64_t AttacksFrom(TREE *RESTRICT, int, int);
 uint64_t AttacksTo(TREE *RESTRICT, int);
-void Bench(int);
+void BatchAnalyze(char *, char *, int, int, uint64_t, int, int);
+void BatchWorker(char *, FILE *, long *, int, int *, int);
+void Bench(int, char *, int, int, int, size_t, char *);
+void BenchBitOps(void);
+void BenchHash(size_t);
+int BenchLoad(BENCH *, char *, int, int);
+void BenchReport(BENCH *, char *, char *);
+void BenchRun(BENCH *);
+void BenchScaling(char *, int, int, int, size_t, char *);
+void BenchStats(double *, int, double *, double *);
+void BenchThreads(int);
 int Book(TREE *RESTRICT, int, int);
 void BookClusterIn(FILE *, int, BOOK_POSITION *);
 void BookClusterOut(FILE *, int, BOOK_POSITION *);
@@ -394,6 +635,7 @@ int GameOver(int);
 int *GenerateCaptures(TREE *RESTRICT, int, int, int *);
 int *GenerateCheckEvasions(TREE *RESTRICT, int, int, int *);
 int *GenerateChecks(TREE *RESTRICT, int, int *);
+void GenerateLegalMasks(TREE *RESTRICT, int, int);
 int *GenerateNoncaptures(TREE *RESTRICT, int, int, int *);
 TREE *GetBlock(TREE *, int);
 int HashProbe(TREE *RESTRICT, int, int, int, int, int, int*);
@@ -412,8 +654,10 @@ uint64_t InitializeMagicRook(int, uint64_t);
 uint64_t InitializeMagicOccupied(int *, int, uint64_t);
 void InitializeMasks(void);
 void InitializePawnMasks(void);
+void InitializePieceSquare(TREE *RESTRICT);
 void InitializeReductions(void);
 void InitializeSMP(void);
+void InitializeTopology(void);
 int IInitializeTb(char *);
 int InputMove(TREE *RESTRICT, char *, int, int, int, int);
 int InputMoveICS(TREE *RESTRICT, char *, int, int, int, int);
@@ -429,21 +673,44 @@ int LearnAdjust(int);
 void LearnBook(void);
 int LearnFunction(int, int, int, int);
 void LearnValue(int, int);
+int LegalMove(TREE *RESTRICT, int, int, int);
 void MakeMove(TREE *RESTRICT, int, int, int);
 void MakeMoveRoot(TREE *RESTRICT, int, int);
 void NewGame(int);
 int NextEvasion(TREE *RESTRICT, int, int);
 int NextMove(TREE *RESTRICT, int, int, int);
+uint64_t NextRecord(uint64_t *, uint64_t *);
 int NextRootMove(TREE *RESTRICT, TREE *RESTRICT, int);
 int NextRootMoveParallel(void);
+void NnueAccumulate(int16_t *, const int16_t **, int, const int16_t **, int);
+int32_t NnueDot(const int16_t *, const int16_t *);
+int32_t NnueDotReference(const int16_t *, const int16_t *);
+int NnueEvaluate(TREE *RESTRICT, int);
+int NnueLoad(char *);
+void NnueMakeMove(TREE *RESTRICT, int, int, int);
+int32_t NnueRead32(unsigned char *);
+void NnueRefresh(TREE *RESTRICT);
+int NnueTest(TREE *RESTRICT, int, int, int);
+void NnueUnmakeMove(TREE *RESTRICT, int, int, int);
+void NnueUpdate(TREE *RESTRICT, int, int, int, int);
 int Option(TREE *RESTRICT);
 int OptionMatch(char *, char *);
-void OptionPerft(TREE *RESTRICT, int, int, int);
 void Output(TREE *RESTRICT, int);
 char *OutputMove(TREE *RESTRICT, int, int, int);
 int ParseTime(char *);
 void Pass(void);
+uint64_t Perft(TREE *RESTRICT, int, int);
+void PerftHashInit(void);
+uint64_t PerftNodes(TREE *RESTRICT, int, int, int);
+void PerftSuite(int);
+void *STDCALL PerftThread(void *);
 int PinnedOnKing(TREE *RESTRICT, int, int);
+void PmuClose(void);
+void PmuDisplay(char *, uint64_t *, int, uint64_t);
+int PmuOpen(void);
+void PmuStart(void);
+int PmuStop(uint64_t *);
+void PmuWrite(FILE *, uint64_t *, int);
 int Ponder(int);
 void Print(int, char *, ...);
 int Quiesce(TREE *RESTRICT, int, int, int, int, int);
@@ -453,38 +720,55 @@ uint64_t Random64(void);
 int Read(int, char *);
 int ReadChessMove(TREE *RESTRICT, FILE *, int, int);
 void ReadClear(void);
+void ReadRC(TREE *RESTRICT);
 unsigned int ReadClock(void);
 int ReadPGN(FILE *, int);
 int ReadNextMove(TREE *RESTRICT, char *, int, int);
 int ReadParse(char *, char *args[], char *);
 int ReadInput(void);
+void JournalClose(void);
+void JournalDecode(char *, int, int, int);
+void JournalEvent(TREE *RESTRICT, int, int, int, int, int, int, int, int);
+char *JournalMove(JOURNAL_EVENT *);
+int JournalOpen(char *, uint64_t);
 int Repeat(TREE *RESTRICT, int);
 int Repeat3x(TREE *RESTRICT);
+void RepeatFilter(TREE *RESTRICT);
 void ResignOrDraw(TREE *RESTRICT, int);
 void RestoreGame(void);
 void RootMoveList(int);
 int Search(TREE *RESTRICT, int, int, int, int, int, int, int);
 int SearchParallel(TREE *RESTRICT, int, int, int, int, int, int, int);
+void SearchStats(int);
 void Trace(TREE *RESTRICT, int, int, int, int, int, const char *, int);
-void SetBoard(TREE *, int, char **, int);
+int SetBoard(TREE *, int, char **, int);
 void SetChessBitBoards(TREE *);
 void SharedFree(void *address);
 int StrCnt(char *, char);
-int Swap(TREE *RESTRICT, int, int);
+int Swap(TREE *RESTRICT, int, int, int);
 int SwapO(TREE *RESTRICT, int, int);
-void Test(char *);
+void Test(char *, int);
 void TestEPD(char *);
+char *TestField(char *, char *);
+int TestSolution(int);
 int Thread(TREE *RESTRICT);
 void WaitForAllThreadsInitialized(void);
+int ThreadCancelled(TREE *RESTRICT);
 void *STDCALL ThreadInit(void *);
 #  if !defined(UNIX)
 void ThreadMalloc(int64_t);
 #  endif
-void ThreadStop(TREE *RESTRICT);
+void ThreadLockStats(int);
+void ThreadPlacement(void);
+void ThreadStats(int);
+int ThreadStop(TREE *RESTRICT);
 int ThreadWait(int, TREE *RESTRICT);
 void TimeAdjust(int, int);
 int TimeCheck(TREE *RESTRICT, int);
 void TimeSet(int);
+void TimerStart(void);
+void TimerStop(void);
+void *STDCALL TimerThread(void *);
 void UnmakeMove(TREE *RESTRICT, int, int, int);
 int ValidMove(TREE *RESTRICT, int, int, int);
 int VerifyMove(TREE *RESTRICT, int, int, int);
@@ -547,16 +831,67 @@ void native_sound(const char* sound_name);
     *mptr++ = t | (to << 6) | (Abs(PcOnSq(to)) << 15);                     \
   }
 #  define Check(side) Attacks(tree, Flip(side), KingSQ(side))
+#  define SpinLockTimed(l, tid, c) \
+    (thread[tid].stats.lock_ns[c] += SpinLockWait(l))
 #  define Attack(from,to) (!(intervening[from][to] & OccupiedSquares))
-#  define BishopAttacks(square, occ) *(magic_bishop_indices[square]+((((occ)&magic_bishop_mask[square])*magic_bishop[square])>>magic_bishop_shift[square]))
-#  define BishopMobility(square, occ) *(magic_bishop_mobility_indices[square]+((((occ)&magic_bishop_mask[square])*magic_bishop[square])>>magic_bishop_shift[square]))
-#  define BishopMobility(square, occ) *(magic_bishop_mobility_indices[square]+((((occ)&magic_bishop_mask[square])*magic_bishop[square])>>magic_bishop_shift[square]))
 #  define KingAttacks(square) king_attacks[square]
 #  define KnightAttacks(square) knight_attacks[square]
 #  define PawnAttacks(side, square)   pawn_attacks[side][square]
 #  define Reversible(p)               (tree->status[p].reversible)
-#  define RookAttacks(square, occ) *(magic_rook_indices[square]+((((occ)&magic_rook_mask[square])*magic_rook[square])>>magic_rook_shift[square]))
-#  define RookMobility(square, occ) *(magic_rook_mobility_indices[square]+((((occ)&magic_rook_mask[square])*magic_rook[square])>>magic_rook_shift[square]))
+#  define RepFilter(key) \
+    (tree->rep_filter[(key) >> (64 - REP_FILTER_BITS)])
+/*
+ *******************************************************************************
+ *                                                                             *
+ *   Slider attacks.  Two independent compile-time choices select how the      *
+ *   magic tables are indexed and how they are laid out:                       *
+ *                                                                             *
+ *   -DPEXT replaces the multiply/shift with the BMI2 pext instruction, which  *
+ *   gathers the occupied bits under the mask into a dense index directly.     *
+ *   The tables are the same size either way since each square still has      *
+ *   2^popcnt(mask) entries, only the order of the entries changes.  This      *
+ *   needs -mbmi2, and should only be used on Intel Haswell or later and AMD   *
+ *   Zen 3 or later, since earlier AMD cpus implement pext in microcode and    *
+ *   are much slower than the magic multiply.                                  *
+ *                                                                             *
+ *   -DCOMPACT_MAGIC stores a one-byte index in each magic table entry rather  *
+ *   than a 64-bit attack set, plus a separate 16 bit mobility score.  A rook  *
+ *   has at most 144 different attack sets from any one square (a bishop at    *
+ *   most 108), so each distinct set is stored once, along with its mobility   *
+ *   score, and the byte selects it.  One index table now serves both the     *
+ *   attack and mobility lookups, and the tables shrink from just over 1mb to  *
+ *   about 170kb, which fits in the L2 cache of most phones.  The cost is one  *
+ *   extra dependent load per lookup, which is cheaper than the cache misses   *
+ *   it saves when the tables don't fit.                                       *
+ *                                                                             *
+ *******************************************************************************
+ */
+#  if defined(PEXT)
+#    if !defined(__BMI2__)
+#      error "-DPEXT requires a compiler target with BMI2, add -mbmi2"
+#    endif
+#    include <immintrin.h>
+#    define BishopIndex(square, occ) _pext_u64(occ, magic_bishop_mask[square])
+#    define RookIndex(square, occ) _pext_u64(occ, magic_rook_mask[square])
+#    define SLIDER_INDEX "pext"
+#  else
+#    define BishopIndex(square, occ) ((((occ)&magic_bishop_mask[square])*magic_bishop[square])>>magic_bishop_shift[square])
+#    define RookIndex(square, occ) ((((occ)&magic_rook_mask[square])*magic_rook[square])>>magic_rook_shift[square])
+#    define SLIDER_INDEX "magic"
+#  endif
+#  if defined(COMPACT_MAGIC)
+#    define BishopAttacks(square, occ) magic_bishop_attacks[magic_bishop_base[square]+magic_bishop_indices[square][BishopIndex(square, occ)]]
+#    define BishopMobility(square, occ) magic_bishop_mobility[magic_bishop_base[square]+magic_bishop_indices[square][BishopIndex(square, occ)]]
+#    define RookAttacks(square, occ) magic_rook_attacks[magic_rook_base[square]+magic_rook_indices[square][RookIndex(square, occ)]]
+#    define RookMobility(square, occ) magic_rook_mobility[magic_rook_base[square]+magic_rook_indices[square][RookIndex(square, occ)]]
+#    define SLIDER_LAYOUT "compact"
+#  else
+#    define BishopAttacks(square, occ) *(magic_bishop_indices[square]+BishopIndex(square, occ))
+#    define BishopMobility(square, occ) *(magic_bishop_mobility_indices[square]+BishopIndex(square, occ))
+#    define RookAttacks(square, occ) *(magic_rook_indices[square]+RookIndex(square, occ))
+#    define RookMobility(square, occ) *(magic_rook_mobility_indices[square]+RookIndex(square, occ))
+#    define SLIDER_LAYOUT "full"
+#  endif
 #  define QueenAttacks(square, occ)   (BishopAttacks(square, occ)|RookAttacks(square, occ))
 #  define Rank(x)       ((x)>>3)
 #  define File(x)       ((x)&7)
@@ -581,6 +916,19 @@ void native_sound(const char* sound_name);
 #  define Captured(a)           (((a)>>15) & 7)
 #  define Promote(a)            (((a)>>18) & 7)
 #  define CaptureOrPromote(a)   (((a)>>15) & 63)
+/*
+   the following macros build and take apart the packed move records that
+   NextMove(), NextEvasion() and Quiesce() order moves with.  The ordering
+   key is kept in the upper 32 bits with its sign bit flipped so that two
+   records compare as unsigned integers in key order, and the move itself is
+   in the low 21 bits.  A zero record is a move that has been removed from
+   the list.  MoveRecords() returns the record that parallels move_list
+   entry tree->last[ply].
+ */
+#  define Record(m, key)        (((uint64_t) ((uint32_t) (key) ^ 0x80000000u) << 32) | (uint64_t) (m))
+#  define RecordMove(r)         ((int) (r) & 0x1fffff)
+#  define RecordKey(r)          ((uint32_t) ((r) >> 32))
+#  define MoveRecords(ply)      (tree->move_record + (tree->last[ply] - tree->move_list))
 #  define SetMask(a)            (set_mask[a])
 #  define ClearMask(a)          (clear_mask[a])
 #  define Pawns(c)              (tree->position.color[c].pieces[pawn])
@@ -606,6 +954,14 @@ void native_sound(const char* sound_name);
 #  define EnPassant(ply)        (tree->status[ply].enpassant_target)
 #  define EnPassantTarget(ply)  (EnPassant(ply) ? SetMask(EnPassant(ply)) : 0)
 #  define PcOnSq(sq)            (tree->position.board[sq])
+#  define PcSqMG(c)             (tree->position.pcsq_mg[c])
+#  define PcSqEG(c)             (tree->position.pcsq_eg[c])
+#  define PcSqAdd(c,p,sq)       (PcSqMG(c) += pcsq[p][mg][c][sq], \
+                                 PcSqEG(c) += pcsq[p][eg][c][sq])
+#  define PcSqSub(c,p,sq)       (PcSqMG(c) -= pcsq[p][mg][c][sq], \
+                                 PcSqEG(c) -= pcsq[p][eg][c][sq])
+#  define NnueIndex(side,c,p,sq) \
+    ((((c) != (side)) * 6 + (p) - 1) * 64 + ((side) ? (sq) : (sq) ^ 56))
 #  define OccupiedSquares       (Occupied(white) | Occupied(black))
 #  define Color(square)         (square_color[square] ? dark_squares : ~dark_squares)
 #  define SideToMove(c)         ((c) ? "White" : "Black")
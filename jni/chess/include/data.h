@@ -12,6 +12,13 @@ extern int opponent_rating;
 extern int time_used;
 extern int time_used_opponent;
 extern uint64_t total_moves;
+extern HASH_ENTRY *perft_hash_table;
+extern size_t perft_hash_table_size;
+extern size_t perft_hash_bytes;
+extern uint64_t perft_hash_mask;
+extern int perft_moves[256];
+extern uint64_t perft_counts[256];
+extern int perft_nmoves, perft_next, perft_depth, perft_wtm;
 extern int allow_cores;
 extern int allow_memory;
 extern int initialized;
@@ -72,6 +79,9 @@ extern char history_filename[256];
 extern int number_of_solutions;
 extern int solutions[10];
 extern int solution_type;
+extern int solution_depth;
+extern unsigned int solution_time;
+extern uint64_t solution_nodes;
 extern int abs_draw_score;
 extern int accept_draws;
 extern int offer_draws;
@@ -138,6 +148,15 @@ extern int num_ponder_moves;
 extern char initial_position[80];
 extern int predicted;
 extern int trace_level;
+extern char *bench_fen[6];
+extern int bench_depth[6];
+extern int pmu_enabled;
+extern int pmu_fd[PMU_COUNTERS];
+extern char *pmu_names[PMU_COUNTERS];
+#if defined(STATS)
+extern SEARCH_STATS search_stats[CPUS];
+#endif
+extern JOURNAL_HEADER *journal_buffer[CPUS];
 extern int book_move;
 extern int book_accept_mask;
 extern int book_reject_mask;
@@ -158,6 +177,10 @@ extern int root_beta;
 extern int last_root_value;
 extern ROOT_MOVE root_moves[256];
 extern int n_root_moves;
+extern int multi_pv;
+extern int multipv_index;
+extern int multipv_lines;
+extern PATH multipv_pv[MAX_MULTIPV];
 extern int difficulty;
 extern int time_limit;
 extern int absolute_time_limit;
@@ -170,20 +193,27 @@ extern unsigned int start_time, end_time;
 extern TREE *block[MAX_BLOCKS + 1];
 extern THREAD thread[CPUS];
 #  if (CPUS > 1)
-extern lock_t lock_split, lock_smp, lock_io, lock_root, lock_buffer;
+extern spinlock_t lock_split, lock_smp, lock_root;
+extern lock_t lock_io, lock_buffer, lock_perft;
 
 #    if defined(UNIX)
 extern pthread_attr_t attributes;
 #    endif
 #  endif
+extern CPU_INFO smp_cpus[MAX_TOPOLOGY_CPUS];
+extern int smp_ncpus;
+extern int smp_affinity[CPUS];
+extern int smp_bind_error[CPUS];
 extern int smp_max_threads;
 extern int smp_split_group;
 extern int smp_split_at_root;
 extern int smp_min_split_depth;
 extern unsigned int smp_split_nodes;
+extern int smp_autotune;
 extern unsigned int parallel_splits;
 extern unsigned int parallel_aborts;
 extern unsigned int idle_time;
+extern uint64_t smp_stats_start;
 extern unsigned int max_split_blocks;
 extern unsigned int idle_percent;
 extern volatile int smp_idle;
@@ -194,6 +224,10 @@ extern int crafty_is_white;
 extern unsigned int nodes_between_time_checks;
 extern unsigned int nodes_per_second;
 extern int next_time_check;
+extern volatile int time_check_due;
+extern volatile int timer_running;
+extern volatile long timer_generation;
+extern int time_abort_deadline;
 extern int transposition_age;
 extern int thinking;
 extern int pondering;
@@ -271,6 +305,15 @@ extern int pval[2][2][64];
 extern int nval[2][2][64];
 extern int bval[2][2][64];
 extern int qval[2][2][64];
+extern int (*const pcsq[7])[2][64];
+#  if defined(NNUE)
+extern int nnue_enabled;
+extern char nnue_file[256];
+extern int16_t *nnue_input_weights;
+extern int16_t *nnue_input_bias;
+extern int16_t *nnue_output_weights;
+extern int32_t nnue_output_bias;
+#  endif
 extern int kval_n[2][64];
 extern int kval_k[2][64];
 extern int kval_q[2][64];
@@ -289,19 +332,26 @@ extern int history[2][512];
 extern uint64_t mobility_mask_n[4];
 extern uint64_t mobility_mask_b[4];
 extern uint64_t mobility_mask_r[4];
-extern int16_t *magic_bishop_mobility_indices[64];
-extern int16_t magic_bishop_mobility_table[5248];
-extern uint64_t *magic_rook_indices[64];
-extern uint64_t magic_rook_table[102400];
-extern int16_t *magic_rook_mobility_indices[64];
-extern int16_t magic_rook_mobility_table[102400];
+extern MAGIC_ENTRY *magic_rook_indices[64];
+extern MAGIC_ENTRY magic_rook_table[102400];
 extern uint64_t magic_bishop[64];
 extern uint64_t magic_bishop_mask[64];
 extern unsigned int magic_bishop_shift[64];
-extern uint64_t *magic_bishop_indices[64];
-extern uint64_t magic_bishop_table[5248];
+extern MAGIC_ENTRY *magic_bishop_indices[64];
+extern MAGIC_ENTRY magic_bishop_table[5248];
+#if !defined(COMPACT_MAGIC)
+extern int16_t *magic_rook_mobility_indices[64];
+extern int16_t magic_rook_mobility_table[102400];
 extern int16_t *magic_bishop_mobility_indices[64];
 extern int16_t magic_bishop_mobility_table[5248];
+#else
+extern uint64_t magic_rook_attacks[4900];
+extern int16_t magic_rook_mobility[4900];
+extern int magic_rook_base[64];
+extern uint64_t magic_bishop_attacks[1428];
+extern int16_t magic_bishop_mobility[1428];
+extern int magic_bishop_base[64];
+#endif
 extern int8_t directions[64][64];
 extern uint64_t pawn_attacks[2][64];
 extern uint64_t knight_attacks[64];
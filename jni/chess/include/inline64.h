@@ -0,0 +1,65 @@
+/* *INDENT-OFF* */
+/* last modified 10/18/26 */
+/*
+ *******************************************************************************
+ *                                                                             *
+ *   Hardware versions of the three basic bitboard operators, selected at      *
+ *   compile time with -DINLINEASM.  These replace the 64K-entry msb[]/lsb[]   *
+ *   tables and the bit-clearing PopCnt() loop in boolean.c, which is kept as  *
+ *   the portable fallback.                                                    *
+ *                                                                             *
+ *   The compiler builtins map directly onto the instructions each target      *
+ *   has:  RBIT+CLZ, CLZ and CNT on ARM64, BSF/BSR (TZCNT/LZCNT with -mbmi     *
+ *   -mlzcnt) and POPCNT (with -mpopcnt) on x86, and the best the compiler can *
+ *   do elsewhere.  MSVC uses the equivalent intrinsics.                       *
+ *                                                                             *
+ *   MSB(0) and LSB(0) return 64, exactly as the table versions do, so         *
+ *   nothing changes for a caller that passes an empty set.  The builtins are  *
+ *   undefined for a zero argument, so that case is tested explicitly.         *
+ *                                                                             *
+ *******************************************************************************
+ */
+#if defined(__GNUC__) || defined(__clang__)
+#  define BITOPS_BACKEND "builtin"
+static __inline__ int MSB(uint64_t arg1) {
+  if (!arg1)
+    return 64;
+  return 63 - __builtin_clzll(arg1);
+}
+
+static __inline__ int LSB(uint64_t arg1) {
+  if (!arg1)
+    return 64;
+  return __builtin_ctzll(arg1);
+}
+
+static __inline__ int PopCnt(uint64_t arg1) {
+  return __builtin_popcountll(arg1);
+}
+#elif defined(_MSC_VER) && defined(_WIN64)
+#  include <intrin.h>
+#  pragma intrinsic(_BitScanForward64, _BitScanReverse64, __popcnt64)
+#  define BITOPS_BACKEND "intrinsic"
+static __forceinline int MSB(uint64_t arg1) {
+  unsigned long index;
+
+  if (!_BitScanReverse64(&index, arg1))
+    return 64;
+  return (int) index;
+}
+
+static __forceinline int LSB(uint64_t arg1) {
+  unsigned long index;
+
+  if (!_BitScanForward64(&index, arg1))
+    return 64;
+  return (int) index;
+}
+
+static __forceinline int PopCnt(uint64_t arg1) {
+  return (int) __popcnt64(arg1);
+}
+#else
+#  error "-DINLINEASM is not supported by this compiler, remove it to use the table versions"
+#endif
+/* *INDENT-ON* */
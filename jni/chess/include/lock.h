@@ -18,6 +18,7 @@ extern pthread_t NumaStartThread(void *func, void *args);
 #include <intrin.h>
 #    pragma intrinsic (_InterlockedExchange)
 typedef volatile LONG lock_t[1];
+typedef volatile LONG atomic_lock_word;
 
 #    define LockInit(v)      ((v)[0] = 0)
 #    define LockFree(v)      ((v)[0] = 0)
@@ -34,6 +35,16 @@ __forceinline void Lock(volatile LONG * hPtr) {
 }
 void Pause() {
 }
+#    define spinlock_t       lock_t
+#    define SpinLockInit(v)  LockInit(v)
+#    define SpinLockFree(v)  LockFree(v)
+#    define SpinLock(v)      Lock(v)
+#    define SpinLockWait(v)  (Lock(v), 0)
+#    define LockClock()      ((uint64_t) GetTickCount64() * 1000000)
+#    define SpinUnlock(v)    Unlock(v)
+#    define AtomicLoadRelaxed(p)  (*(p))
+#    define AtomicCompareExchange(p, e, d) \
+        (_InterlockedCompareExchange((LPLONG) (p), d, e) == (e))
 #  else
 /*
  *******************************************************************************
@@ -44,68 +55,153 @@ void Pause() {
  *******************************************************************************
  */
 
-/*
-static void __inline__ LockX86(volatile int *lock) {
-  int dummy;
-  asm __volatile__(
-      "1:          movl    $1, %0"   "\n\t"
-      "            xchgl   (%1), %0" "\n\t"
-      "            testl   %0, %0"   "\n\t"
-      "            jz      3f"       "\n\t"
-      "2:          pause"            "\n\t"
-      "            movl    (%1), %0" "\n\t"
-      "            testl   %0, %0"   "\n\t"
-      "            jnz     2b"       "\n\t"
-      "            jmp     1b"       "\n\t"
-      "3:"                           "\n\t"
-      :"=&q"(dummy)
-      :"q"(lock)
-      :"cc", "memory");
-}
-static void __inline__ Pause() {
-  asm __volatile__(
-      "            pause"            "\n\t");
-}
-static void __inline__ UnlockX86(volatile int *lock) {
-  asm __volatile__(
-      "movl    $0, (%0)"
-      :
-      :"q"(lock)
-      :"memory");
-}
-*/
 #include <pthread.h>
+#include <stdint.h>
+#include <time.h>
 
+/*
+ *******************************************************************************
+ *                                                                             *
+ *  Pause() is the CPU "relax" hint used inside every spin-wait loop.  On an   *
+ *  SMT (hyperthreaded) x86 core it gives the sibling thread the execution     *
+ *  resources while we spin, and on ARM the YIELD hint does the same for       *
+ *  multi-threaded cores and lets big.LITTLE parts lower the spin power.  On   *
+ *  anything else we fall back to a compiler barrier so the loop still re-     *
+ *  reads memory.                                                              *
+ *                                                                             *
+ *******************************************************************************
+ */
 static void __inline__ Pause() {
+#    if defined(__i386__) || defined(__x86_64__)
+  __asm__ __volatile__("pause" ::: "memory");
+#    elif defined(__aarch64__) || (defined(__arm__) && \
+        (defined(__ARM_ARCH_7A__) || defined(__ARM_ARCH_7__) || \
+        defined(__ARM_ARCH_6K__) || (defined(__ARM_ARCH) && __ARM_ARCH >= 7)))
+  __asm__ __volatile__("yield" ::: "memory");
+#    else
+  __asm__ __volatile__("" ::: "memory");
+#    endif
 }
 
-#ifdef USE_SPINLOCK
-#define lock_t	pthread_spinlock_t
-
-#define LockInit(p) (pthread_spin_init(&p, 0))
-#define LockFree(p) (pthread_spin_destroy(&p))
-#define Lock(p) (pthread_spin_lock(&p))
-#define Unlock(p) (pthread_spin_unlock(&p))
-
-#else
+/*
+ *******************************************************************************
+ *                                                                             *
+ *  Atomic primitives used by the spinlock and the split block cancellation    *
+ *  epochs.  C translation units built as C11 use <stdatomic.h> directly.      *
+ *  lock.h is also compiled as C++ (egtb.cpp) and by older NDK compilers, so   *
+ *  those get the compiler's __atomic builtins, which implement exactly the    *
+ *  same C11 memory model.                                                     *
+ *                                                                             *
+ *******************************************************************************
+ */
+#    if !defined(__cplusplus) && defined(__STDC_VERSION__) && \
+        __STDC_VERSION__ >= 201112L && !defined(__STDC_NO_ATOMICS__)
+#      include <stdatomic.h>
+typedef atomic_int atomic_lock_word;
+#      define AtomicLoadRelaxed(p)   atomic_load_explicit(p, memory_order_relaxed)
+#      define AtomicExchangeAcquire(p, v) \
+        atomic_exchange_explicit(p, v, memory_order_acquire)
+#      define AtomicStoreRelease(p, v) \
+        atomic_store_explicit(p, v, memory_order_release)
+static int __inline__ AtomicCompareExchange(atomic_lock_word * p,
+    int expected, int desired) {
+  return atomic_compare_exchange_strong_explicit(p, &expected, desired,
+      memory_order_acq_rel, memory_order_acquire);
+}
+#    else
+typedef volatile int atomic_lock_word;
+#      define AtomicLoadRelaxed(p)   __atomic_load_n(p, __ATOMIC_RELAXED)
+#      define AtomicExchangeAcquire(p, v) \
+        __atomic_exchange_n(p, v, __ATOMIC_ACQUIRE)
+#      define AtomicStoreRelease(p, v) \
+        __atomic_store_n(p, v, __ATOMIC_RELEASE)
+static int __inline__ AtomicCompareExchange(atomic_lock_word * p,
+    int expected, int desired) {
+  return __atomic_compare_exchange_n(p, &expected, desired, 0,
+      __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+#    endif
 
-#define lock_t	pthread_mutex_t
+/*
+ *******************************************************************************
+ *                                                                             *
+ *  spinlock_t is a test-and-test-and-set lock for the very short SMP critical *
+ *  sections (split blocks, lock_smp, lock_split and lock_root), which only    *
+ *  cover a handful of instructions and where parking a thread in the kernel   *
+ *  costs far more than the wait itself.  We only attempt the atomic exchange  *
+ *  when a plain load shows the lock free, so waiting threads spin in their    *
+ *  own cache and do not bounce the line between cores.                        *
+ *                                                                             *
+ *  lock_t remains a pthread mutex.  It is used for I/O, the input buffer and  *
+ *  the EGTB cache, where the lock can be held across a system call and a      *
+ *  waiting thread should sleep rather than burn a core.                       *
+ *                                                                             *
+ *  Each spinlock keeps its own contention counters.  They are only updated    *
+ *  by the thread that just acquired the lock, so they need no atomics.  The   *
+ *  "lockstats" command displays them so each spin-vs-park choice can be       *
+ *  checked:  a spin site with a high contended rate and many spins per        *
+ *  contended acquisition should be made a mutex instead.                      *
+ *                                                                             *
+ *******************************************************************************
+ */
+typedef struct {
+  atomic_lock_word locked;
+  uint64_t acquires;
+  uint64_t contended;
+  uint64_t spins;
+} spinlock_t;
 
-#define LockInit(p) (pthread_mutex_init(&p, 0))
-#define LockFree(p) (pthread_mutex_destroy(&p))
-#define Lock(p) (pthread_mutex_lock(&p))
-#define Unlock(p) (pthread_mutex_unlock(&p))
+static uint64_t __inline__ LockClock() {
+  struct timespec ts;
 
-#endif
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
 
+/*
+ *******************************************************************************
+ *                                                                             *
+ *  SpinLockAcquire() returns the number of nanoseconds spent waiting, so the  *
+ *  caller can charge it to a lock class.  The clock is only read once the     *
+ *  first exchange has failed, so an uncontended acquisition costs nothing     *
+ *  extra.                                                                     *
+ *                                                                             *
+ *******************************************************************************
+ */
+static uint64_t __inline__ SpinLockAcquire(spinlock_t * lock) {
+  uint64_t spins = 0, start;
 
+  if (!AtomicExchangeAcquire(&lock->locked, 1)) {
+    lock->acquires++;
+    return 0;
+  }
+  start = LockClock();
+  do
+    while (AtomicLoadRelaxed(&lock->locked)) {
+      spins++;
+      Pause();
+    }
+  while (AtomicExchangeAcquire(&lock->locked, 1));
+  lock->acquires++;
+  lock->contended++;
+  lock->spins += spins;
+  return LockClock() - start;
+}
 
+#    define SpinLockInit(p) do { (p).locked = 0; (p).acquires = 0; \
+        (p).contended = 0; (p).spins = 0; } while (0)
+#    define SpinLockClearStats(p) do { (p).acquires = 0; \
+        (p).contended = 0; (p).spins = 0; } while (0)
+#    define SpinLockFree(p)
+#    define SpinLock(p)     ((void) SpinLockAcquire(&(p)))
+#    define SpinLockWait(p) (SpinLockAcquire(&(p)))
+#    define SpinUnlock(p)   (AtomicStoreRelease(&(p).locked, 0))
 
-//#    define LockInit(p)           (p=0)
-//#    define LockFree(p)           (p=0)
-//#    define Unlock(p)             (UnlockX86(&p))
-//#    define Lock(p)               (LockX86(&p))
-//#    define lock_t                volatile int
+#    define lock_t pthread_mutex_t
+#    define LockInit(p) (pthread_mutex_init(&p, 0))
+#    define LockFree(p) (pthread_mutex_destroy(&p))
+#    define Lock(p) (pthread_mutex_lock(&p))
+#    define Unlock(p) (pthread_mutex_unlock(&p))
 #  endif
 #else
 #  define LockInit(p)
@@ -113,5 +209,16 @@ static void __inline__ Pause() {
 #  define Lock(p)
 #  define Unlock(p)
 #  define lock_t volatile int
+#  define SpinLockInit(p)
+#  define SpinLockFree(p)
+#  define SpinLock(p)
+#  define SpinLockWait(p) 0
+#  define LockClock() ((uint64_t) 0)
+#  define SpinUnlock(p)
+#  define spinlock_t volatile int
+typedef volatile int atomic_lock_word;
+#  define AtomicLoadRelaxed(p) (*(p))
+#  define AtomicCompareExchange(p, e, d) \
+    ((*(p) == (e)) ? ((*(p) = (d)), 1) : 0)
 #endif                          /*  SMP code */
 /* *INDENT-ON* */
@@ -108,6 +108,12 @@ void unpack_files() {
 	//int fd;
 
 	make_path(_dataDirectory, "/crafty.rc", rcdestination, sizeof(rcdestination));
+
+	// keep an existing rc file, "smptune save" writes its settings there
+	if(file_exists(rcdestination)) {
+		LOGI("%s already present", rcdestination);
+		return;
+	}
 	LOGI("extracting %s to %s", rcfilename, rcdestination);
 
 	if(extract_file(rcfilename, rcdestination) == 0) {
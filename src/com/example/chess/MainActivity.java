@@ -110,7 +110,8 @@ public class MainActivity extends ActionBarActivity implements com.example.jni.L
 
     	InitializeNative(fi);
     	
-    	final String [] argv = {"logpath=" + fi.getDataDirectory()};
+    	final String [] argv = {"logpath=" + fi.getDataDirectory(),
+    			"rcpath=" + fi.getDataDirectory()};
     	
         new Thread(new Runnable() {
 			public void run() {